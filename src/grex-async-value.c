@@ -0,0 +1,177 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "grex-async-value.h"
+
+#include "gpropz.h"
+
+struct _GrexAsyncValue {
+  GObject parent_instance;
+
+  GValue placeholder;
+  gboolean completed;
+
+  GValue value;
+  GError *error;
+};
+
+enum {
+  PROP_COMPLETED = 1,
+  N_PROPS,
+};
+
+static GParamSpec *properties[N_PROPS] = {NULL};
+
+G_DEFINE_TYPE(GrexAsyncValue, grex_async_value, G_TYPE_OBJECT)
+
+static void
+grex_async_value_finalize(GObject *object) {
+  GrexAsyncValue *async_value = GREX_ASYNC_VALUE(object);
+
+  if (G_IS_VALUE(&async_value->placeholder)) {
+    g_value_unset(&async_value->placeholder);
+  }
+
+  if (G_IS_VALUE(&async_value->value)) {
+    g_value_unset(&async_value->value);
+  }
+
+  g_clear_error(&async_value->error);
+}
+
+static void
+grex_async_value_class_init(GrexAsyncValueClass *klass) {
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+  object_class->finalize = grex_async_value_finalize;
+
+  gpropz_class_init_property_functions(object_class);
+
+  properties[PROP_COMPLETED] = g_param_spec_boolean(
+      "completed", "Completed", "Whether the value has been returned yet.",
+      FALSE, G_PARAM_READABLE);
+  gpropz_install_property(object_class, GrexAsyncValue, completed,
+                          PROP_COMPLETED, properties[PROP_COMPLETED], NULL);
+}
+
+static void
+grex_async_value_init(GrexAsyncValue *async_value) {}
+
+/**
+ * grex_async_value_new:
+ * @placeholder: (nullable): The value to use until this one is returned.
+ *
+ * Creates a new pending value, which can be returned from a scope property (or
+ * anything else a binding reads) whose real value is still being computed,
+ * e.g. by a #GTask. Bindings that evaluate to it use @placeholder instead
+ * until grex_async_value_return_value() is called. If @placeholder is %NULL,
+ * the default value of the type the binding expects is used.
+ *
+ * When dependencies are tracked (i.e. under a #GrexReactiveInflator), the
+ * binding also depends on #GrexAsyncValue:completed, so it's re-applied once
+ * the value is returned. The binding is evaluated again at that point, so the
+ * property it reads should keep returning the same #GrexAsyncValue, rather
+ * than starting a new operation.
+ *
+ * Returns: (transfer full): The new pending value.
+ */
+GrexAsyncValue *
+grex_async_value_new(const GValue *placeholder) {
+  GrexAsyncValue *async_value = g_object_new(GREX_TYPE_ASYNC_VALUE, NULL);
+  if (placeholder != NULL) {
+    g_value_init(&async_value->placeholder, G_VALUE_TYPE(placeholder));
+    g_value_copy(placeholder, &async_value->placeholder);
+  }
+
+  return async_value;
+}
+
+/**
+ * grex_async_value_get_placeholder:
+ *
+ * Returns the value to use until this one is returned.
+ *
+ * Returns: (transfer none) (nullable): The placeholder value.
+ */
+const GValue *
+grex_async_value_get_placeholder(GrexAsyncValue *async_value) {
+  return G_IS_VALUE(&async_value->placeholder) ? &async_value->placeholder
+                                               : NULL;
+}
+
+/**
+ * grex_async_value_get_completed:
+ *
+ * Checks if the value (or an error) has been returned yet.
+ *
+ * Returns: %TRUE if the value is complete.
+ */
+GPROPZ_DEFINE_RO(gboolean, GrexAsyncValue, grex_async_value, completed,
+                 properties[PROP_COMPLETED])
+
+/**
+ * grex_async_value_get_value:
+ *
+ * Returns the value that was returned, if any.
+ *
+ * Returns: (transfer none) (nullable): The value, or %NULL if it isn't
+ *          complete yet or an error was returned instead.
+ */
+const GValue *
+grex_async_value_get_value(GrexAsyncValue *async_value) {
+  return G_IS_VALUE(&async_value->value) ? &async_value->value : NULL;
+}
+
+/**
+ * grex_async_value_get_error:
+ *
+ * Returns the error that was returned, if any.
+ *
+ * Returns: (transfer none) (nullable): The error.
+ */
+const GError *
+grex_async_value_get_error(GrexAsyncValue *async_value) {
+  return async_value->error;
+}
+
+static void
+complete(GrexAsyncValue *async_value) {
+  async_value->completed = TRUE;
+  g_object_notify_by_pspec(G_OBJECT(async_value), properties[PROP_COMPLETED]);
+}
+
+/**
+ * grex_async_value_return_value:
+ * @value: The resulting value.
+ *
+ * Completes this value, re-applying any bindings that are waiting on it. This
+ * must be called from the main context the bindings were inflated in, e.g.
+ * from a #GAsyncReadyCallback.
+ */
+void
+grex_async_value_return_value(GrexAsyncValue *async_value,
+                              const GValue *value) {
+  g_return_if_fail(!async_value->completed);
+
+  g_value_init(&async_value->value, G_VALUE_TYPE(value));
+  g_value_copy(value, &async_value->value);
+  complete(async_value);
+}
+
+/**
+ * grex_async_value_return_error:
+ * @error: (transfer full): The error.
+ *
+ * Completes this value with an error, which is reported by any bindings that
+ * are waiting on it once they're re-applied. Like
+ * grex_async_value_return_value(), this must be called from the main context
+ * the bindings were inflated in.
+ */
+void
+grex_async_value_return_error(GrexAsyncValue *async_value, GError *error) {
+  g_return_if_fail(!async_value->completed);
+
+  async_value->error = error;
+  complete(async_value);
+}
@@ -0,0 +1,28 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "grex-config.h"
+
+G_BEGIN_DECLS
+
+#define GREX_TYPE_ASYNC_VALUE grex_async_value_get_type()
+G_DECLARE_FINAL_TYPE(GrexAsyncValue, grex_async_value, GREX, ASYNC_VALUE,
+                     GObject)
+
+GrexAsyncValue *grex_async_value_new(const GValue *placeholder);
+
+const GValue *grex_async_value_get_placeholder(GrexAsyncValue *async_value);
+gboolean grex_async_value_get_completed(GrexAsyncValue *async_value);
+
+const GValue *grex_async_value_get_value(GrexAsyncValue *async_value);
+const GError *grex_async_value_get_error(GrexAsyncValue *async_value);
+
+void grex_async_value_return_value(GrexAsyncValue *async_value,
+                                   const GValue *value);
+void grex_async_value_return_error(GrexAsyncValue *async_value,
+                                   GError *error);
+
+G_END_DECLS
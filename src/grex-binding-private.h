@@ -0,0 +1,17 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "grex-binding.h"
+#include "grex-config.h"
+
+#ifndef _GREX_INTERNAL
+#error "This is internal stuff, you shouldn't be here!"
+#endif
+
+guint grex_binding_get_n_segments(GrexBinding *binding);
+const char *grex_binding_get_segment(GrexBinding *binding, guint index,
+                                     GrexExpression **expression,
+                                     gboolean *is_bidirectional);
@@ -5,7 +5,10 @@
 #include "grex-binding.h"
 
 #include "gpropz.h"
+#include "grex-async-value.h"
+#include "grex-binding-private.h"
 #include "grex-enums.h"
+#include "grex-expression-context-private.h"
 #include "grex-parser-private.h"
 #include "grex-value-parser.h"
 
@@ -121,11 +124,115 @@ GPROPZ_DEFINE_RO(GrexBindingType, GrexBinding, grex_binding, binding_type,
 GPROPZ_DEFINE_RO(GrexSourceLocation *, GrexBinding, grex_binding, location,
                  properties[PROP_LOCATION])
 
+/**
+ * grex_binding_is_constant:
+ *
+ * Checks if this binding always evaluates to the same value, i.e. it's either a
+ * %GREX_BINDING_TYPE_CONSTANT binding or all its expressions are constant.
+ * Two-way bindings are never considered constant, since they push changes
+ * back.
+ *
+ * Returns: %TRUE if the binding is constant.
+ */
+gboolean
+grex_binding_is_constant(GrexBinding *binding) {
+  if (binding->segments == NULL ||
+      binding->type == GREX_BINDING_TYPE_EXPRESSION_2WAY) {
+    return FALSE;
+  }
+
+  for (guint i = 0; i < binding->segments->len; i++) {
+    Segment *segment = g_ptr_array_index(binding->segments, i);
+    if (segment->type == SEGMENT_EXPRESSION &&
+        !grex_expression_is_constant(segment->expression)) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+guint
+grex_binding_get_n_segments(GrexBinding *binding) {
+  return binding->segments != NULL ? binding->segments->len : 0;
+}
+
+// Returns the segment's constant text, or NULL if it's an expression, in which
+// case the expression and whether it's bidirectional are returned instead.
+const char *
+grex_binding_get_segment(GrexBinding *binding, guint index,
+                         GrexExpression **expression,
+                         gboolean *is_bidirectional) {
+  Segment *segment = g_ptr_array_index(binding->segments, index);
+  if (segment->type == SEGMENT_CONSTANT) {
+    *expression = NULL;
+    *is_bidirectional = FALSE;
+    return segment->constant;
+  }
+
+  *expression = segment->expression;
+  *is_bidirectional = segment->is_bidirectional;
+  return NULL;
+}
+
+// If the expression's value is a GrexAsyncValue, returns its result instead,
+// or its placeholder if it's still pending (which doesn't support pushing).
+// Otherwise, returns the value as-is.
+static GrexValueHolder *
+resolve_async_value(GrexBinding *binding, GrexValueHolder *holder,
+                    GType expected_type, GrexExpressionContext *eval_context,
+                    gboolean track_dependencies, GError **error) {
+  const GValue *value = grex_value_holder_get_value(holder);
+  if (!G_VALUE_HOLDS(value, GREX_TYPE_ASYNC_VALUE) ||
+      g_value_get_object(value) == NULL) {
+    return grex_value_holder_ref(holder);
+  }
+
+  GrexAsyncValue *async_value = g_value_get_object(value);
+  gboolean completed = grex_async_value_get_completed(async_value);
+
+  // Re-applies the binding once the value is returned.
+  if (track_dependencies && !completed) {
+    g_auto(GValue) completed_value = G_VALUE_INIT;
+    g_value_init(&completed_value, G_TYPE_BOOLEAN);
+    g_value_set_boolean(&completed_value, completed);
+    grex_expression_context_track_dependency(
+        eval_context, G_OBJECT(async_value), "completed", &completed_value);
+  }
+
+  if (completed) {
+    const GError *async_error = grex_async_value_get_error(async_value);
+    if (async_error != NULL) {
+      grex_set_located_error(error, binding->location, async_error->domain,
+                             async_error->code, "%s", async_error->message);
+      return NULL;
+    }
+
+    return grex_value_holder_new(grex_async_value_get_value(async_value));
+  }
+
+  const GValue *placeholder = grex_async_value_get_placeholder(async_value);
+  if (placeholder != NULL) {
+    return grex_value_holder_new(placeholder);
+  }
+
+  g_auto(GValue) default_value = G_VALUE_INIT;
+  g_value_init(&default_value,
+               expected_type != G_TYPE_NONE ? expected_type : G_TYPE_OBJECT);
+  if (G_VALUE_HOLDS_STRING(&default_value)) {
+    g_value_set_static_string(&default_value, "");
+  }
+
+  return grex_value_holder_new(&default_value);
+}
+
 /**
  * grex_binding_evaluate:
  * @error: Return location for a #GError.
  *
- * Evaluates this binding and returns the resulting value.
+ * Evaluates this binding and returns the resulting value. If an expression
+ * evaluates to a #GrexAsyncValue, its result is used instead (or its
+ * placeholder, if it's still pending).
  *
  * Returns: The resulting value, or NULL on error.
  */
@@ -156,8 +263,14 @@ grex_binding_evaluate(GrexBinding *binding, GType expected_type,
     g_return_val_if_fail(binding->segments->len == 1, NULL);
     Segment *first_segment = g_ptr_array_index(binding->segments, 0);
 
-    result = grex_expression_evaluate(first_segment->expression, eval_context,
-                                      flags, error);
+    g_autoptr(GrexValueHolder) expression_result = grex_expression_evaluate(
+        first_segment->expression, eval_context, flags, error);
+    if (expression_result == NULL) {
+      return NULL;
+    }
+
+    result = resolve_async_value(binding, expression_result, expected_type,
+                                 eval_context, track_dependencies, error);
     if (result == NULL) {
       return NULL;
     }
@@ -172,8 +285,16 @@ grex_binding_evaluate(GrexBinding *binding, GType expected_type,
         g_string_append(result_string, segment->constant);
         break;
       case SEGMENT_EXPRESSION: {
-        g_autoptr(GrexValueHolder) value_holder = grex_expression_evaluate(
-            segment->expression, eval_context, flags, error);
+        g_autoptr(GrexValueHolder) expression_result =
+            grex_expression_evaluate(segment->expression, eval_context, flags,
+                                     error);
+        if (expression_result == NULL) {
+          return NULL;
+        }
+
+        g_autoptr(GrexValueHolder) value_holder =
+            resolve_async_value(binding, expression_result, G_TYPE_STRING,
+                                eval_context, track_dependencies, error);
         if (value_holder == NULL) {
           return NULL;
         }
@@ -44,6 +44,7 @@ G_DECLARE_FINAL_TYPE(GrexBinding, grex_binding, GREX, BINDING, GObject)
 
 GrexBindingType grex_binding_get_binding_type(GrexBinding *binding);
 GrexSourceLocation *grex_binding_get_location(GrexBinding *binding);
+gboolean grex_binding_is_constant(GrexBinding *binding);
 
 GrexValueHolder *grex_binding_evaluate(GrexBinding *binding,
                                        GType expected_type,
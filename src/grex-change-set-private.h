@@ -0,0 +1,18 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "grex-change-set.h"
+#include "grex-config.h"
+
+#ifndef _GREX_INTERNAL
+#error "This is internal stuff, you shouldn't be here!"
+#endif
+
+void grex_change_set_add_property(GrexChangeSet *changes, GObject *object,
+                                  GParamSpec *pspec,
+                                  GrexChangePriority priority);
+void grex_change_set_add_name(GrexChangeSet *changes, const char *name,
+                              GrexChangePriority priority);
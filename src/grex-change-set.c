@@ -0,0 +1,189 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "grex-change-set.h"
+
+#include "grex-change-set-private.h"
+
+typedef struct {
+  // Only ever compared by address, never dereferenced.
+  gpointer object;
+  GParamSpec *pspec;
+} ChangedProperty;
+
+static guint
+changed_property_hash(const ChangedProperty *property) {
+  return g_direct_hash(property->object) ^ g_direct_hash(property->pspec);
+}
+
+static gboolean
+changed_property_equals(const ChangedProperty *a, const ChangedProperty *b) {
+  return a->object == b->object && a->pspec == b->pspec;
+}
+
+struct _GrexChangeSet {
+  GObject parent_instance;
+
+  // Set of ChangedProperty.
+  GHashTable *properties;
+  // Set of the objects that had any property change.
+  GHashTable *objects;
+  // Set of the changed extra names.
+  GHashTable *names;
+
+  GrexChangePriority priority;
+};
+
+G_DEFINE_TYPE(GrexChangeSet, grex_change_set, G_TYPE_OBJECT)
+
+static void
+grex_change_set_finalize(GObject *object) {
+  GrexChangeSet *changes = GREX_CHANGE_SET(object);
+
+  g_clear_pointer(&changes->properties, g_hash_table_unref);
+  g_clear_pointer(&changes->objects, g_hash_table_unref);
+  g_clear_pointer(&changes->names, g_hash_table_unref);
+}
+
+static void
+grex_change_set_class_init(GrexChangeSetClass *klass) {
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+  object_class->finalize = grex_change_set_finalize;
+}
+
+static void
+grex_change_set_init(GrexChangeSet *changes) {
+  changes->properties = g_hash_table_new_full(
+      (GHashFunc)changed_property_hash, (GEqualFunc)changed_property_equals,
+      g_free, NULL);
+  changes->objects = g_hash_table_new(NULL, NULL);
+  changes->names = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  changes->priority = GREX_CHANGE_PRIORITY_LOW;
+}
+
+/**
+ * grex_change_set_new:
+ *
+ * Creates a new, empty change set.
+ *
+ * Returns: (transfer full): The new change set.
+ */
+GrexChangeSet *
+grex_change_set_new() {
+  return g_object_new(GREX_TYPE_CHANGE_SET, NULL);
+}
+
+/**
+ * grex_change_set_is_empty:
+ *
+ * Checks if this change set contains no changes at all.
+ *
+ * Returns: %TRUE if the change set is empty.
+ */
+gboolean
+grex_change_set_is_empty(GrexChangeSet *changes) {
+  return g_hash_table_size(changes->properties) == 0 &&
+         g_hash_table_size(changes->names) == 0;
+}
+
+/**
+ * grex_change_set_get_priority:
+ *
+ * Returns the highest priority of any change in this set (see
+ * grex_expression_context_set_source_priority()). An empty set has
+ * %GREX_CHANGE_PRIORITY_LOW.
+ *
+ * Returns: The priority.
+ */
+GrexChangePriority
+grex_change_set_get_priority(GrexChangeSet *changes) {
+  return changes->priority;
+}
+
+/**
+ * grex_change_set_contains_object:
+ * @object: The object to check.
+ *
+ * Checks if any property of the given object changed. Objects are only
+ * compared by identity.
+ *
+ * Returns: %TRUE if any of the object's properties changed.
+ */
+gboolean
+grex_change_set_contains_object(GrexChangeSet *changes, GObject *object) {
+  return g_hash_table_contains(changes->objects, object);
+}
+
+/**
+ * grex_change_set_contains_property:
+ * @object: The object the property belongs to.
+ * @property: The property name.
+ *
+ * Checks if the given property of the given object changed.
+ *
+ * Returns: %TRUE if the property changed.
+ */
+gboolean
+grex_change_set_contains_property(GrexChangeSet *changes, GObject *object,
+                                  const char *property) {
+  if (!g_hash_table_contains(changes->objects, object)) {
+    return FALSE;
+  }
+
+  ChangedProperty key = {
+      .object = object,
+      .pspec =
+          g_object_class_find_property(G_OBJECT_GET_CLASS(object), property),
+  };
+  return key.pspec != NULL && g_hash_table_contains(changes->properties, &key);
+}
+
+/**
+ * grex_change_set_contains_name:
+ * @name: The extra name to check.
+ *
+ * Checks if the given extra name was inserted into the context.
+ *
+ * Returns: %TRUE if the name changed.
+ */
+gboolean
+grex_change_set_contains_name(GrexChangeSet *changes, const char *name) {
+  return g_hash_table_contains(changes->names, name);
+}
+
+/**
+ * grex_change_set_get_names:
+ *
+ * Returns all the extra names that were inserted into the context.
+ *
+ * Returns: (transfer container) (element-type utf8): The changed names.
+ */
+GList *
+grex_change_set_get_names(GrexChangeSet *changes) {
+  return g_hash_table_get_keys(changes->names);
+}
+
+void
+grex_change_set_add_property(GrexChangeSet *changes, GObject *object,
+                             GParamSpec *pspec, GrexChangePriority priority) {
+  changes->priority = MAX(changes->priority, priority);
+
+  ChangedProperty key = {.object = object, .pspec = pspec};
+  if (g_hash_table_contains(changes->properties, &key)) {
+    return;
+  }
+
+  ChangedProperty *property = g_new(ChangedProperty, 1);
+  *property = key;
+  g_hash_table_add(changes->properties, property);
+  g_hash_table_add(changes->objects, object);
+}
+
+void
+grex_change_set_add_name(GrexChangeSet *changes, const char *name,
+                         GrexChangePriority priority) {
+  changes->priority = MAX(changes->priority, priority);
+  g_hash_table_add(changes->names, g_strdup(name));
+}
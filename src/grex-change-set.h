@@ -0,0 +1,34 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "grex-config.h"
+
+G_BEGIN_DECLS
+
+typedef enum {
+  GREX_CHANGE_PRIORITY_LOW,
+  GREX_CHANGE_PRIORITY_HIGH,
+} GrexChangePriority;
+
+#define GREX_TYPE_CHANGE_SET grex_change_set_get_type()
+G_DECLARE_FINAL_TYPE(GrexChangeSet, grex_change_set, GREX, CHANGE_SET, GObject)
+
+GrexChangeSet *grex_change_set_new();
+
+gboolean grex_change_set_is_empty(GrexChangeSet *changes);
+GrexChangePriority grex_change_set_get_priority(GrexChangeSet *changes);
+
+gboolean grex_change_set_contains_object(GrexChangeSet *changes,
+                                         GObject *object);
+gboolean grex_change_set_contains_property(GrexChangeSet *changes,
+                                           GObject *object,
+                                           const char *property);
+gboolean grex_change_set_contains_name(GrexChangeSet *changes,
+                                       const char *name);
+
+GList *grex_change_set_get_names(GrexChangeSet *changes);
+
+G_END_DECLS
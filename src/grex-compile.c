@@ -0,0 +1,791 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// grex-compile: checks a template at build time and writes it out as a binary
+// fragment (see grex_fragment_write_binary()), ready to be placed in a
+// GResource, and/or as C code specialized for inflating it (see
+// grex_inflator_register_compiled_fragment()).
+
+#include "grex.h"
+
+#include "grex-fragment-private.h"
+
+#include <gmodule.h>
+#include <math.h>
+
+#define GREX_TYPE_COMPILE_SCOPE grex_compile_scope_get_type()
+G_DECLARE_FINAL_TYPE(GrexCompileScope, grex_compile_scope, GREX, COMPILE_SCOPE,
+                     GtkBuilderCScope)
+
+// Resolves types the same way GtkBuilder does, but can register placeholders
+// for types that are only available to the application itself. Only their
+// names end up in the output, so the real types are used once it's loaded.
+struct _GrexCompileScope {
+  GtkBuilderCScope parent_instance;
+
+  gboolean allow_unknown_types;
+  GHashTable *placeholder_types;
+};
+
+static GtkBuilderScopeInterface *parent_scope_iface = NULL;
+
+static void grex_compile_scope_iface_init(GtkBuilderScopeInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(GrexCompileScope, grex_compile_scope,
+                        GTK_TYPE_BUILDER_CSCOPE,
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_BUILDER_SCOPE,
+                                              grex_compile_scope_iface_init))
+
+static void
+grex_compile_scope_finalize(GObject *object) {
+  GrexCompileScope *scope = GREX_COMPILE_SCOPE(object);
+
+  g_clear_pointer(&scope->placeholder_types, g_hash_table_unref);
+}
+
+static GType
+grex_compile_scope_get_type_from_name(GtkBuilderScope *builder_scope,
+                                      GtkBuilder *builder,
+                                      const char *type_name) {
+  GrexCompileScope *scope = GREX_COMPILE_SCOPE(builder_scope);
+
+  GType type =
+      parent_scope_iface->get_type_from_name(builder_scope, builder, type_name);
+  if (type == G_TYPE_INVALID && scope->allow_unknown_types) {
+    type = g_type_register_static_simple(
+        G_TYPE_OBJECT, g_intern_string(type_name), sizeof(GObjectClass), NULL,
+        sizeof(GObject), NULL, 0);
+    g_hash_table_add(scope->placeholder_types, GSIZE_TO_POINTER(type));
+  }
+
+  return type;
+}
+
+static void
+grex_compile_scope_iface_init(GtkBuilderScopeInterface *iface) {
+  parent_scope_iface = g_type_interface_peek_parent(iface);
+  iface->get_type_from_name = grex_compile_scope_get_type_from_name;
+}
+
+static void
+grex_compile_scope_class_init(GrexCompileScopeClass *klass) {
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+  object_class->finalize = grex_compile_scope_finalize;
+}
+
+static void
+grex_compile_scope_init(GrexCompileScope *scope) {
+  scope->placeholder_types = g_hash_table_new(NULL, NULL);
+}
+
+static void
+report_error(GrexFragment *fragment, const char *format, ...)
+    G_GNUC_PRINTF(2, 3);
+
+static void
+report_error(GrexFragment *fragment, const char *format, ...) {
+  va_list va;
+  va_start(va, format);
+  g_autofree char *message = g_strdup_vprintf(format, va);
+  va_end(va);
+
+  g_autofree char *location =
+      grex_source_location_format(grex_fragment_get_location(fragment));
+  g_printerr("%s: %s\n", location, message);
+}
+
+// Checks the bindings that don't depend on anything only known at runtime,
+// i.e. everything except directives and bindings on placeholder types.
+// Returns the number of errors found.
+static guint
+check_binding(GrexCompileScope *scope, GrexFragment *fragment,
+              GObjectClass *target_class, const char *name,
+              GrexBinding *binding) {
+  GType target_type = G_OBJECT_CLASS_TYPE(target_class);
+  if (g_ascii_isupper(name[0]) || name[0] == '_' ||
+      g_hash_table_contains(scope->placeholder_types,
+                            GSIZE_TO_POINTER(target_type))) {
+    return 0;
+  }
+
+  GParamSpec *pspec = g_object_class_find_property(target_class, name);
+  if (pspec == NULL) {
+    if (!g_str_has_prefix(name, "on.")) {
+      report_error(fragment, "Invalid property '%s' on type '%s'", name,
+                   G_OBJECT_CLASS_NAME(target_class));
+      return 1;
+    }
+
+    const char *signal_name = name + strlen("on.");
+    if (g_signal_lookup(signal_name, target_type) == 0) {
+      report_error(fragment, "Invalid signal '%s' on type '%s'", signal_name,
+                   G_OBJECT_CLASS_NAME(target_class));
+      return 1;
+    }
+
+    return 0;
+  }
+
+  // Constant values can already be converted to the property's type.
+  if (grex_binding_is_constant(binding)) {
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GrexExpressionContext) context =
+        grex_expression_context_new(NULL);
+    g_autoptr(GrexValueHolder) value = grex_binding_evaluate(
+        binding, pspec->value_type, context, FALSE, &error);
+    if (value == NULL) {
+      report_error(fragment, "Invalid value for property '%s': %s", name,
+                   error->message);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static guint
+check_fragment(GrexCompileScope *scope, GrexFragment *fragment) {
+  guint n_errors = 0;
+
+  GObjectClass *target_class =
+      g_type_class_ref(grex_fragment_get_target_type(fragment));
+
+  g_autoptr(GList) targets = grex_fragment_get_binding_targets(fragment);
+  for (GList *target = targets; target != NULL; target = target->next) {
+    n_errors +=
+        check_binding(scope, fragment, target_class, target->data,
+                      grex_fragment_get_binding(fragment, target->data));
+  }
+
+  g_type_class_unref(target_class);
+
+  g_autoptr(GList) children = grex_fragment_get_children(fragment);
+  for (GList *child = children; child != NULL; child = child->next) {
+    n_errors += check_fragment(scope, child->data);
+  }
+
+  return n_errors;
+}
+
+// Writes out the code inflating a single template. Each fragment gets its own
+// function, which applies the fragment's properties directly and calls the
+// children's functions in turn. Anything that depends on the runtime state of
+// the inflator (directives, computed values, non-constant bindings) is still
+// delegated to it.
+typedef struct {
+  GrexCompileScope *scope;
+  const char *prefix;
+
+  // Maps the fragments to their index in a pre-order traversal, which is also
+  // how the generated code finds them in the loaded template.
+  GHashTable *fragment_indexes;
+
+  // The inflate functions, and the setup code resolving the bindings, their
+  // targets, and the properties they use.
+  GString *functions;
+  GString *setup;
+  guint n_bindings;
+  guint n_pspecs;
+} CodeGenerator;
+
+static void
+index_fragments(CodeGenerator *gen, GrexFragment *fragment) {
+  guint index = g_hash_table_size(gen->fragment_indexes);
+  g_hash_table_insert(gen->fragment_indexes, fragment, GUINT_TO_POINTER(index));
+
+  g_autoptr(GList) children = grex_fragment_get_children(fragment);
+  for (GList *child = children; child != NULL; child = child->next) {
+    index_fragments(gen, child->data);
+  }
+}
+
+static guint
+get_fragment_index(CodeGenerator *gen, GrexFragment *fragment) {
+  return GPOINTER_TO_UINT(g_hash_table_lookup(gen->fragment_indexes, fragment));
+}
+
+// Checks if the fragment can get its own inflate function, i.e. if it doesn't
+// define any computed values, which only the inflator itself can manage.
+static gboolean
+can_generate_node(const GrexFragmentInstruction *node) {
+  GREX_FRAGMENT_FOREACH_INSTRUCTION(node, instruction) {
+    if (instruction->op == GREX_FRAGMENT_OP_LET) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+static gboolean
+can_generate_child(const GrexFragmentInstruction *child) {
+  // Structural directives decide if and how their fragment is inflated.
+  return !child->has_structural && can_generate_node(child);
+}
+
+static char *
+format_string_literal(const char *str) {
+  g_autofree char *escaped = g_strescape(str, NULL);
+  return g_strdup_printf("\"%s\"", escaped);
+}
+
+static char *
+format_double_literal(double value) {
+  char buffer[G_ASCII_DTOSTR_BUF_SIZE];
+  return g_strdup(g_ascii_formatd(buffer, sizeof(buffer), "%.17g", value));
+}
+
+// Returns the statement setting the GValue named 'value' to the given value,
+// or NULL if its type can't be written out as a C literal.
+static char *
+format_value_setter(const GValue *value) {
+  switch (G_TYPE_FUNDAMENTAL(G_VALUE_TYPE(value))) {
+  case G_TYPE_BOOLEAN:
+    return g_strdup_printf("g_value_set_boolean(&value, %s);",
+                           g_value_get_boolean(value) ? "TRUE" : "FALSE");
+  case G_TYPE_CHAR:
+    return g_strdup_printf("g_value_set_schar(&value, %d);",
+                           g_value_get_schar(value));
+  case G_TYPE_UCHAR:
+    return g_strdup_printf("g_value_set_uchar(&value, %u);",
+                           g_value_get_uchar(value));
+  case G_TYPE_INT:
+    return g_value_get_int(value) == G_MININT
+               ? g_strdup("g_value_set_int(&value, G_MININT);")
+               : g_strdup_printf("g_value_set_int(&value, %d);",
+                                 g_value_get_int(value));
+  case G_TYPE_UINT:
+    return g_strdup_printf("g_value_set_uint(&value, %uu);",
+                           g_value_get_uint(value));
+  case G_TYPE_LONG:
+    return g_value_get_long(value) == G_MINLONG
+               ? g_strdup("g_value_set_long(&value, G_MINLONG);")
+               : g_strdup_printf("g_value_set_long(&value, %ldL);",
+                                 g_value_get_long(value));
+  case G_TYPE_ULONG:
+    return g_strdup_printf("g_value_set_ulong(&value, %luUL);",
+                           g_value_get_ulong(value));
+  case G_TYPE_INT64:
+    return g_value_get_int64(value) == G_MININT64
+               ? g_strdup("g_value_set_int64(&value, G_MININT64);")
+               : g_strdup_printf("g_value_set_int64(&value, "
+                                 "G_GINT64_CONSTANT(%" G_GINT64_FORMAT "));",
+                                 g_value_get_int64(value));
+  case G_TYPE_UINT64:
+    return g_strdup_printf(
+        "g_value_set_uint64(&value, G_GUINT64_CONSTANT(%" G_GUINT64_FORMAT
+        "));",
+        g_value_get_uint64(value));
+  case G_TYPE_FLOAT:
+  case G_TYPE_DOUBLE: {
+    gboolean is_float = G_VALUE_HOLDS_FLOAT(value);
+    double number =
+        is_float ? g_value_get_float(value) : g_value_get_double(value);
+    if (!isfinite(number)) {
+      return NULL;
+    }
+
+    g_autofree char *literal = format_double_literal(number);
+    return g_strdup_printf("g_value_set_%s(&value, %s);",
+                           is_float ? "float" : "double", literal);
+  }
+  case G_TYPE_ENUM:
+    return g_strdup_printf("g_value_set_enum(&value, %d);",
+                           g_value_get_enum(value));
+  case G_TYPE_FLAGS:
+    return g_strdup_printf("g_value_set_flags(&value, %uu);",
+                           g_value_get_flags(value));
+  case G_TYPE_STRING: {
+    const char *str = g_value_get_string(value);
+    if (str == NULL) {
+      return NULL;
+    }
+
+    g_autofree char *literal = format_string_literal(str);
+    return g_strdup_printf("g_value_set_static_string(&value, %s);", literal);
+  }
+  default:
+    return NULL;
+  }
+}
+
+// Returns the statement setting a constant binding's value, or NULL if it has
+// to be applied by the inflator instead.
+static char *
+generate_constant_setter(CodeGenerator *gen, GrexFragment *fragment,
+                         const char *name, GrexBinding *binding) {
+  GType target_type = grex_fragment_get_target_type(fragment);
+  if (g_hash_table_contains(gen->scope->placeholder_types,
+                            GSIZE_TO_POINTER(target_type))) {
+    return NULL;
+  }
+
+  GObjectClass *target_class = g_type_class_ref(target_type);
+  GParamSpec *pspec = g_object_class_find_property(target_class, name);
+  g_type_class_unref(target_class);
+  if (pspec == NULL) {
+    return NULL;
+  }
+
+  g_autoptr(GrexExpressionContext) context = grex_expression_context_new(NULL);
+  g_autoptr(GrexValueHolder) value = grex_binding_evaluate(
+      binding, pspec->value_type, context, FALSE, NULL);
+  if (value == NULL) {
+    return NULL;
+  }
+
+  return format_value_setter(grex_value_holder_get_value(value));
+}
+
+static void
+generate_property(CodeGenerator *gen, GrexFragment *fragment, guint index,
+                  const GrexFragmentInstruction *instruction) {
+  GString *code = gen->functions;
+  const char *prefix = gen->prefix;
+
+  g_autofree char *name = format_string_literal(instruction->name);
+  guint binding_index = gen->n_bindings++;
+  g_string_append_printf(
+      gen->setup,
+      "    %s_bindings[%u] =\n"
+      "        grex_fragment_get_binding(%s_fragments[%u], %s);\n"
+      "    %s_targets[%u] =\n"
+      "        grex_compiled_target_new(%s_fragments[%u], %s);\n",
+      prefix, binding_index, prefix, index, name, prefix, binding_index,
+      prefix, index, name);
+
+  g_autofree char *setter = NULL;
+  if (instruction->op == GREX_FRAGMENT_OP_SET) {
+    setter = generate_constant_setter(gen, fragment, instruction->name,
+                                      instruction->binding);
+  }
+
+  if (setter == NULL) {
+    g_string_append_printf(
+        code,
+        "  grex_inflator_apply_compiled_binding(\n"
+        "      inflator, host, %s_targets[%u], %s_bindings[%u], flags);\n",
+        prefix, binding_index, prefix, binding_index);
+    return;
+  }
+
+  guint pspec_index = gen->n_pspecs++;
+  g_string_append_printf(gen->setup,
+                         "    %s_pspecs[%u] = %s_find_property(%u, %s);\n",
+                         prefix, pspec_index, prefix, index, name);
+
+  g_string_append_printf(
+      code,
+      "  if (!grex_inflator_keep_compiled_constant(host, %s_targets[%u],\n"
+      "                                            %s_bindings[%u])) {\n"
+      "    g_auto(GValue) value = G_VALUE_INIT;\n"
+      "    g_value_init(&value, %s_pspecs[%u]->value_type);\n"
+      "    %s\n"
+      "    grex_inflator_add_compiled_property(host, %s_targets[%u], "
+      "&value);\n"
+      "  }\n",
+      prefix, binding_index, prefix, binding_index, prefix, pspec_index,
+      setter, prefix, binding_index);
+}
+
+static void
+generate_node(CodeGenerator *gen, const GrexFragmentInstruction *node) {
+  const char *prefix = gen->prefix;
+  guint index = get_fragment_index(gen, node->fragment);
+
+  // The children's functions come first, so they don't need to be declared.
+  GREX_FRAGMENT_FOREACH_CHILD(node, child) {
+    if (can_generate_child(child)) {
+      generate_node(gen, child);
+    }
+  }
+
+  GString *code = gen->functions;
+  g_string_append_printf(
+      code,
+      "static void\n"
+      "%s_inflate_%u(GrexInflator *inflator, GObject *target,\n"
+      "    GrexInflationFlags flags) {\n"
+      "  g_autoptr(GrexFragmentHost) host =\n"
+      "      grex_inflator_begin_compiled_host(inflator, target,\n"
+      "                                        %s_fragments[%u], flags);\n"
+      "  if (host == NULL) {\n"
+      "    return;\n"
+      "  }\n"
+      "\n",
+      prefix, index, prefix, index);
+
+  // Properties are set in the same order as the program applies them, which is
+  // also what keeps the output stable.
+  GREX_FRAGMENT_FOREACH_INSTRUCTION(node, instruction) {
+    if (instruction->op == GREX_FRAGMENT_OP_SET ||
+        instruction->op == GREX_FRAGMENT_OP_BIND ||
+        instruction->op == GREX_FRAGMENT_OP_CONNECT) {
+      generate_property(gen, node->fragment, index, instruction);
+    }
+  }
+
+  g_string_append_printf(
+      code,
+      "  grex_inflator_apply_compiled_directives(inflator, host,\n"
+      "                                          %s_fragments[%u], flags);\n",
+      prefix, index);
+
+  int child_index = 0;
+  GREX_FRAGMENT_FOREACH_CHILD(node, child) {
+    guint child_fragment_index = get_fragment_index(gen, child->fragment);
+    g_autofree char *func =
+        can_generate_child(child)
+            ? g_strdup_printf("%s_inflate_%u", prefix, child_fragment_index)
+            : g_strdup("NULL");
+    g_string_append_printf(
+        code,
+        "  grex_inflator_inflate_compiled_child(\n"
+        "      inflator, host, %d, %s_fragments[%u], %s, flags);\n",
+        child_index++, prefix, child_fragment_index, func);
+  }
+
+  g_string_append(code,
+                  "\n"
+                  "  grex_inflator_commit_compiled_host(host);\n"
+                  "}\n"
+                  "\n");
+}
+
+static char *
+generate_header(const char *prefix, const char *filename) {
+  return g_strdup_printf(
+      "/* Generated by grex-compile from %s, do not edit. */\n"
+      "\n"
+      "#pragma once\n"
+      "\n"
+      "#include <grex.h>\n"
+      "\n"
+      "G_BEGIN_DECLS\n"
+      "\n"
+      "GrexFragment *%s_get_fragment(void);\n"
+      "\n"
+      "G_END_DECLS\n",
+      filename, prefix);
+}
+
+static char *
+generate_source(GrexCompileScope *scope, GrexFragment *fragment,
+                GBytes *bytes, const char *prefix, const char *filename,
+                const char *header) {
+  CodeGenerator gen = {
+      .scope = scope,
+      .prefix = prefix,
+      .fragment_indexes = g_hash_table_new(NULL, NULL),
+      .functions = g_string_new(NULL),
+      .setup = g_string_new(NULL),
+  };
+
+  index_fragments(&gen, fragment);
+
+  g_autoptr(GrexFragmentProgram) program =
+      grex_fragment_program_ref(grex_fragment_get_program(fragment));
+  const GrexFragmentInstruction *root = grex_fragment_program_get_root(program);
+  gboolean is_compiled = can_generate_node(root);
+  if (is_compiled) {
+    generate_node(&gen, root);
+  }
+
+  g_autoptr(GString) code = g_string_new(NULL);
+  g_autofree char *filename_literal = format_string_literal(filename);
+
+  g_string_append_printf(code,
+                         "/* Generated by grex-compile from %s, do not edit. "
+                         "*/\n\n#include <grex.h>\n",
+                         filename);
+  if (header != NULL) {
+    g_autofree char *header_name = g_path_get_basename(header);
+    g_string_append_printf(code, "#include \"%s\"\n", header_name);
+  }
+
+  // The template itself, in the binary format.
+  gsize size = 0;
+  const guint8 *data = g_bytes_get_data(bytes, &size);
+  g_string_append_printf(code, "\nstatic const guint8 %s_data[] = {", prefix);
+  for (gsize i = 0; i < size; i++) {
+    g_string_append_printf(code, "%s0x%02x,", i % 12 == 0 ? "\n  " : "",
+                           data[i]);
+    if (i % 12 != 11 && i + 1 < size) {
+      g_string_append_c(code, ' ');
+    }
+  }
+
+  g_string_append_printf(
+      code,
+      "\n};\n"
+      "\n"
+      "static GrexFragment *%s_fragments[%u];\n",
+      prefix, g_hash_table_size(gen.fragment_indexes));
+  if (gen.n_bindings > 0) {
+    g_string_append_printf(code,
+                           "static GrexBinding *%s_bindings[%u];\n"
+                           "static GrexCompiledTarget *%s_targets[%u];\n",
+                           prefix, gen.n_bindings, prefix, gen.n_bindings);
+  }
+  if (gen.n_pspecs > 0) {
+    g_string_append_printf(code, "static GParamSpec *%s_pspecs[%u];\n", prefix,
+                           gen.n_pspecs);
+  }
+
+  g_string_append_printf(
+      code,
+      "\n"
+      "static void\n"
+      "%s_collect_fragments(GrexFragment *fragment, guint *n_fragments) {\n"
+      "  %s_fragments[(*n_fragments)++] = fragment;\n"
+      "\n"
+      "  g_autoptr(GList) children = grex_fragment_get_children(fragment);\n"
+      "  for (GList *child = children; child != NULL; child = child->next) "
+      "{\n"
+      "    %s_collect_fragments(child->data, n_fragments);\n"
+      "  }\n"
+      "}\n"
+      "\n",
+      prefix, prefix, prefix);
+
+  if (gen.n_pspecs > 0) {
+    g_string_append_printf(
+        code,
+        "static GParamSpec *\n"
+        "%s_find_property(guint index, const char *name) {\n"
+        "  GType type = grex_fragment_get_target_type(%s_fragments[index]);\n"
+        "  // The class is never unreffed, so the pspec stays valid.\n"
+        "  GParamSpec *pspec =\n"
+        "      g_object_class_find_property(g_type_class_ref(type), name);\n"
+        "  if (pspec == NULL) {\n"
+        "    g_error(\"%%s: Invalid property '%%s' on type '%%s'\", %s,\n"
+        "            name, g_type_name(type));\n"
+        "  }\n"
+        "\n"
+        "  return pspec;\n"
+        "}\n"
+        "\n",
+        prefix, prefix, filename_literal);
+  }
+
+  g_string_append(code, gen.functions->str);
+
+  g_string_append_printf(
+      code,
+      "GrexFragment *\n"
+      "%s_get_fragment(void) {\n"
+      "  static gsize initialized = 0;\n"
+      "  if (g_once_init_enter(&initialized)) {\n"
+      "    g_autoptr(GBytes) bytes =\n"
+      "        g_bytes_new_static(%s_data, sizeof(%s_data));\n"
+      "    g_autoptr(GError) error = NULL;\n"
+      "    GrexFragment *fragment =\n"
+      "        grex_fragment_parse_binary(bytes, NULL, &error);\n"
+      "    if (fragment == NULL) {\n"
+      "      g_error(\"%%s: %%s\", %s, error->message);\n"
+      "    }\n"
+      "\n"
+      "    guint n_fragments = 0;\n"
+      "    %s_collect_fragments(fragment, &n_fragments);\n"
+      "%s",
+      prefix, prefix, prefix, filename_literal, prefix, gen.setup->str);
+  if (is_compiled) {
+    g_string_append_printf(
+        code,
+        "\n"
+        "    grex_inflator_register_compiled_fragment(fragment, "
+        "%s_inflate_0);\n",
+        prefix);
+  }
+
+  g_string_append_printf(code,
+                         "    g_once_init_leave(&initialized, 1);\n"
+                         "  }\n"
+                         "\n"
+                         "  return %s_fragments[0];\n"
+                         "}\n",
+                         prefix);
+
+  g_hash_table_unref(gen.fragment_indexes);
+  g_string_free(gen.functions, TRUE);
+  g_string_free(gen.setup, TRUE);
+  return g_string_free(g_steal_pointer(&code), FALSE);
+}
+
+// Derives the generated functions' prefix from the template's file name, e.g.
+// hello-window.xml becomes hello_window_template.
+static char *
+get_default_prefix(const char *filename) {
+  g_autofree char *basename = g_path_get_basename(filename);
+  char *extension = strchr(basename, '.');
+  if (extension != NULL) {
+    *extension = '\0';
+  }
+
+  g_autoptr(GString) prefix = g_string_new(NULL);
+  if (g_ascii_isdigit(basename[0])) {
+    g_string_append_c(prefix, '_');
+  }
+
+  for (const char *c = basename; *c != '\0'; c++) {
+    g_string_append_c(prefix,
+                      g_ascii_isalnum(*c) ? g_ascii_tolower(*c) : '_');
+  }
+
+  g_string_append(prefix, "_template");
+  return g_string_free(g_steal_pointer(&prefix), FALSE);
+}
+
+static gboolean
+write_file(const char *path, const char *data, gsize size) {
+  g_autoptr(GError) error = NULL;
+  if (!g_file_set_contents(path, data, size, &error)) {
+    g_printerr("%s\n", error->message);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+load_libraries(char **libraries) {
+  for (char **library = libraries; library != NULL && *library != NULL;
+       library++) {
+    // Not local, so GtkBuilder can find the library's get_type() functions.
+    GModule *module = g_module_open(*library, 0);
+    if (module == NULL) {
+      g_printerr("Failed to load %s: %s\n", *library, g_module_error());
+      return FALSE;
+    }
+
+    g_module_make_resident(module);
+  }
+
+  return TRUE;
+}
+
+int
+main(int argc, char **argv) {
+  g_autofree char *output = NULL;
+  g_autofree char *c_source = NULL;
+  g_autofree char *c_header = NULL;
+  g_autofree char *c_prefix = NULL;
+  g_autofree char *filename = NULL;
+  g_auto(GStrv) libraries = NULL;
+  g_auto(GStrv) inputs = NULL;
+  gboolean allow_unknown_types = FALSE;
+
+  GOptionEntry entries[] = {
+      {"output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+       "Write the binary template to FILE (otherwise, only check the input)",
+       "FILE"},
+      {"c-source", 0, 0, G_OPTION_ARG_FILENAME, &c_source,
+       "Write C code inflating the template to FILE", "FILE"},
+      {"c-header", 0, 0, G_OPTION_ARG_FILENAME, &c_header,
+       "Write the header for --c-source to FILE", "FILE"},
+      {"c-prefix", 0, 0, G_OPTION_ARG_STRING, &c_prefix,
+       "Prefix the generated C functions with PREFIX (defaults to the file "
+       "name followed by _template)",
+       "PREFIX"},
+      {"filename", 0, 0, G_OPTION_ARG_STRING, &filename,
+       "Use NAME as the file name in source locations (defaults to the "
+       "input's base name)",
+       "NAME"},
+      {"library", 'l', 0, G_OPTION_ARG_FILENAME_ARRAY, &libraries,
+       "Load types from LIBRARY (may be given multiple times)", "LIBRARY"},
+      {"allow-unknown-types", 0, 0, G_OPTION_ARG_NONE, &allow_unknown_types,
+       "Accept types that can't be found, without checking their bindings",
+       NULL},
+      {G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &inputs, NULL,
+       "INPUT"},
+      {NULL},
+  };
+
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GOptionContext) option_context =
+      g_option_context_new("- compile a Grex template");
+  g_option_context_add_main_entries(option_context, entries, NULL);
+  if (!g_option_context_parse(option_context, &argc, &argv, &error)) {
+    g_printerr("%s\n", error->message);
+    return 1;
+  }
+
+  if (inputs == NULL || g_strv_length(inputs) != 1) {
+    g_printerr("Expected exactly one input template\n");
+    return 1;
+  }
+
+  if (!load_libraries(libraries)) {
+    return 1;
+  }
+
+  const char *input = inputs[0];
+  if (filename == NULL) {
+    filename = g_path_get_basename(input);
+  }
+
+  g_autofree char *xml = NULL;
+  gsize len = 0;
+  if (!g_file_get_contents(input, &xml, &len, &error)) {
+    g_printerr("%s\n", error->message);
+    return 1;
+  }
+
+  g_autoptr(GrexCompileScope) scope =
+      g_object_new(GREX_TYPE_COMPILE_SCOPE, NULL);
+  scope->allow_unknown_types = allow_unknown_types;
+
+  g_autoptr(GrexFragment) fragment = grex_fragment_parse_xml(
+      xml, len, filename, GTK_BUILDER_SCOPE(scope), &error);
+  if (fragment == NULL) {
+    g_printerr("%s: %s\n", filename, error->message);
+    return 1;
+  }
+
+  guint n_errors = check_fragment(scope, fragment);
+  if (n_errors > 0) {
+    g_printerr("%s: %u error(s)\n", filename, n_errors);
+    return 1;
+  }
+
+  if (output == NULL && c_source == NULL && c_header == NULL) {
+    return 0;
+  }
+
+  g_autoptr(GBytes) bytes = grex_fragment_write_binary(fragment, &error);
+  if (bytes == NULL) {
+    g_printerr("%s\n", error->message);
+    return 1;
+  }
+
+  if (output != NULL) {
+    gsize size = 0;
+    const char *data = g_bytes_get_data(bytes, &size);
+    if (!write_file(output, data, size)) {
+      return 1;
+    }
+  }
+
+  if (c_prefix == NULL) {
+    c_prefix = get_default_prefix(filename);
+  }
+
+  if (c_source != NULL) {
+    g_autofree char *source = generate_source(scope, fragment, bytes, c_prefix,
+                                              filename, c_header);
+    if (!write_file(c_source, source, strlen(source))) {
+      return 1;
+    }
+  }
+
+  if (c_header != NULL) {
+    g_autofree char *header = generate_header(c_prefix, filename);
+    if (!write_file(c_header, header, strlen(header))) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -44,21 +44,23 @@ grex_constant_value_expression_finalize(GObject *object) {
   g_clear_pointer(&const_expr->value, grex_value_holder_unref);
 }
 
-static GrexValueHolder *
-grex_constant_value_expression_evaluate(GrexExpression *expression,
-                                        GrexExpressionContext *context,
-                                        GrexExpressionEvaluationFlags flags,
-                                        GError **error) {
+static void
+grex_constant_value_expression_compile(GrexExpression *expression,
+                                       GrexExpressionCompiler *compiler,
+                                       guint dest) {
   GrexConstantValueExpression *const_expr =
       GREX_CONSTANT_VALUE_EXPRESSION(expression);
-  return grex_value_holder_ref(const_expr->value);
+  guint index = grex_expression_compiler_emit(
+      compiler, GREX_EXPRESSION_OP_CONSTANT, expression, dest);
+  grex_expression_compiler_get_instruction(compiler, index)->constant =
+      const_expr->value;
 }
 
 static void
 grex_constant_value_expression_class_init(
     GrexConstantValueExpressionClass *klass) {
   GrexExpressionClass *expr_class = GREX_EXPRESSION_CLASS(klass);
-  expr_class->evaluate = grex_constant_value_expression_evaluate;
+  expr_class->compile = grex_constant_value_expression_compile;
 
   GObjectClass *object_class = G_OBJECT_CLASS(klass);
 
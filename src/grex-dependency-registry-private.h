@@ -0,0 +1,82 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "grex-config.h"
+
+#ifndef _GREX_INTERNAL
+#error "This is internal stuff, you shouldn't be here!"
+#endif
+
+// A dependency owner collects the dependencies tracked on its behalf, so that a
+// change to one of them can be traced back to whatever read it (e.g. a single
+// binding on a single host).
+typedef struct _GrexDependencyOwner GrexDependencyOwner;
+
+GrexDependencyOwner *grex_dependency_owner_new(gpointer data,
+                                               GDestroyNotify data_destroy);
+GrexDependencyOwner *grex_dependency_owner_ref(GrexDependencyOwner *owner);
+void grex_dependency_owner_unref(GrexDependencyOwner *owner);
+
+gpointer grex_dependency_owner_get_data(GrexDependencyOwner *owner);
+
+void grex_dependency_owner_begin_tracking(GrexDependencyOwner *owner);
+void grex_dependency_owner_end_tracking(GrexDependencyOwner *owner);
+void grex_dependency_owner_reset(GrexDependencyOwner *owner);
+
+GObject *grex_dependency_owner_lookup_path(GrexDependencyOwner *owner,
+                                           GObject *key);
+void grex_dependency_owner_begin_path(GrexDependencyOwner *owner,
+                                      GObject *key);
+void grex_dependency_owner_end_path(GrexDependencyOwner *owner, GObject *key,
+                                    GObject *object);
+
+// A memo caches a value computed from tracked dependencies, until one of them
+// changes.
+typedef struct _GrexDependencyMemo GrexDependencyMemo;
+
+GrexDependencyMemo *grex_dependency_memo_new();
+void grex_dependency_memo_free(GrexDependencyMemo *memo);
+
+gboolean grex_dependency_memo_use(GrexDependencyMemo *memo,
+                                  GrexDependencyOwner *owner, GValue *dest);
+
+void grex_dependency_owner_begin_memo(GrexDependencyOwner *owner);
+void grex_dependency_owner_end_memo(GrexDependencyOwner *owner,
+                                    GrexDependencyMemo *memo,
+                                    const GValue *value);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GrexDependencyOwner, grex_dependency_owner_unref)
+
+// The registry keeps the signal connections for every tracked dependency, and
+// collects the owners whose dependencies changed.
+typedef struct _GrexDependencyRegistry GrexDependencyRegistry;
+
+typedef void (*GrexDependencyRegistryChangedFunc)(GObject *object,
+                                                  GParamSpec *pspec,
+                                                  gpointer user_data);
+
+GrexDependencyRegistry *
+grex_dependency_registry_new(GrexDependencyRegistryChangedFunc changed_func,
+                             gpointer user_data);
+void grex_dependency_registry_free(GrexDependencyRegistry *registry);
+
+GrexDependencyOwner *
+grex_dependency_registry_get_root_owner(GrexDependencyRegistry *registry);
+
+void grex_dependency_registry_track(GrexDependencyRegistry *registry,
+                                    GrexDependencyOwner *owner,
+                                    GObject *object, const char *property,
+                                    const GValue *value);
+
+void grex_dependency_registry_track_name(GrexDependencyRegistry *registry,
+                                         GrexDependencyOwner *owner,
+                                         const char *name);
+
+void grex_dependency_registry_invalidate_name(GrexDependencyRegistry *registry,
+                                              const char *name);
+GPtrArray *
+grex_dependency_registry_take_invalidated(GrexDependencyRegistry *registry,
+                                          gboolean *out_root_invalidated);
@@ -0,0 +1,731 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "grex-dependency-registry-private.h"
+
+// Either a property of an object, or (if object is NULL) an extra name in the
+// context.
+typedef struct {
+  GObject *object;
+  GParamSpec *pspec;
+  GQuark name;
+} DependencyKey;
+
+static guint
+dependency_key_hash(const DependencyKey *key) {
+  return g_direct_hash(key->object) ^ g_direct_hash(key->pspec) ^ key->name;
+}
+
+static gboolean
+dependency_key_equals(const DependencyKey *a, const DependencyKey *b) {
+  return a->object == b->object && a->pspec == b->pspec && a->name == b->name;
+}
+
+// The single notify connection for a property of an object, shared by every
+// owner that read it. Subscriptions are referenced by the registry (as long as
+// they're connected) and by each reader. Subscriptions to names have no
+// connection, and are only invalidated explicitly.
+typedef struct {
+  // NOTE: Must be first, so a Subscription * can be used as a DependencyKey *.
+  DependencyKey key;
+
+  grefcount rc;
+
+  // NULL once the registry was freed.
+  GrexDependencyRegistry *registry;
+  // Set of the owners that read this dependency.
+  GHashTable *readers;
+
+  // The value most recently read or notified, used to ignore notifications that
+  // don't actually change anything.
+  GValue last_value;
+
+  // Unset once the object is finalized; the key's object pointer is kept
+  // around as-is for hashing.
+  gboolean alive;
+  gulong handler_id;
+
+  // Bumped on every change that invalidates the readers, so cached paths and
+  // memos can tell if anything they read changed since.
+  guint64 serial;
+} Subscription;
+
+// A read of a subscription as part of resolving a path or computing a memo,
+// along with the subscription's serial at the time.
+typedef struct {
+  Subscription *subscription;
+  guint64 serial;
+} CachedRead;
+
+// The object a path (e.g. the "a.b" part of "a.b.c") last resolved to, and
+// every read it took to get there.
+typedef struct {
+  GWeakRef object;
+  GArray *reads;
+  guint generation;
+} Path;
+
+struct _GrexDependencyOwner {
+  grefcount rc;
+
+  gpointer data;
+  GDestroyNotify data_destroy;
+
+  // Subscription -> the tracking generation it was last read in.
+  GHashTable *subscriptions;
+  guint generation;
+  gboolean invalidated;
+
+  // Path key -> the Path it last resolved.
+  GHashTable *paths;
+  // The reads of the paths currently being resolved and memos currently being
+  // computed, innermost last.
+  GPtrArray *recorders;
+};
+
+struct _GrexDependencyMemo {
+  // Only initialized if the memo holds a value.
+  GValue value;
+  GArray *reads;
+};
+
+struct _GrexDependencyRegistry {
+  GrexDependencyRegistryChangedFunc changed_func;
+  gpointer user_data;
+
+  // DependencyKey -> the connected Subscription for it.
+  GHashTable *subscriptions;
+
+  GrexDependencyOwner *root_owner;
+  GPtrArray *invalidated_owners;
+};
+
+static Subscription *
+subscription_ref(Subscription *subscription) {
+  g_ref_count_inc(&subscription->rc);
+  return subscription;
+}
+
+static void
+subscription_unref(Subscription *subscription) {
+  if (g_ref_count_dec(&subscription->rc)) {
+    g_clear_pointer(&subscription->readers, g_hash_table_unref);
+    if (G_IS_VALUE(&subscription->last_value)) {
+      g_value_unset(&subscription->last_value);
+    }
+
+    g_free(subscription);
+  }
+}
+
+static void
+on_subscribed_object_finalized(gpointer user_data,
+                               GObject *where_the_object_was) {
+  Subscription *subscription = user_data;
+
+  // The object's signal handlers are already gone at this point.
+  subscription->alive = FALSE;
+  subscription->handler_id = 0;
+
+  if (subscription->registry != NULL) {
+    g_hash_table_remove(subscription->registry->subscriptions, subscription);
+  }
+}
+
+static void
+subscription_disconnect(Subscription *subscription) {
+  if (subscription->alive && subscription->key.object != NULL) {
+    g_signal_handler_disconnect(subscription->key.object,
+                                subscription->handler_id);
+    g_object_weak_unref(subscription->key.object,
+                        on_subscribed_object_finalized, subscription);
+
+    subscription->alive = FALSE;
+    subscription->handler_id = 0;
+  }
+}
+
+static void
+invalidate_owner(GrexDependencyRegistry *registry, GrexDependencyOwner *owner) {
+  if (!owner->invalidated) {
+    owner->invalidated = TRUE;
+    g_ptr_array_add(registry->invalidated_owners,
+                    grex_dependency_owner_ref(owner));
+  }
+}
+
+static void
+invalidate_readers(GrexDependencyRegistry *registry,
+                   Subscription *subscription) {
+  GHashTableIter iter;
+  gpointer reader;
+  g_hash_table_iter_init(&iter, subscription->readers);
+  while (g_hash_table_iter_next(&iter, &reader, NULL)) {
+    invalidate_owner(registry, reader);
+  }
+}
+
+static void
+on_subscribed_notify(GObject *object, GParamSpec *pspec, gpointer user_data) {
+  Subscription *subscription = user_data;
+  GrexDependencyRegistry *registry = subscription->registry;
+  if (registry == NULL) {
+    return;
+  }
+
+  // Many classes notify on every set, even if the value stayed the same.
+  if (G_IS_VALUE(&subscription->last_value)) {
+    g_auto(GValue) current = G_VALUE_INIT;
+    g_value_init(&current, G_VALUE_TYPE(&subscription->last_value));
+    g_object_get_property(object, subscription->key.pspec->name, &current);
+
+    if (g_param_values_cmp(subscription->key.pspec, &current,
+                           &subscription->last_value) == 0) {
+      return;
+    }
+
+    g_value_copy(&current, &subscription->last_value);
+  }
+
+  subscription->serial++;
+  invalidate_readers(registry, subscription);
+
+  // However many owners read it, a change is only announced once.
+  registry->changed_func(object, subscription->key.pspec, registry->user_data);
+}
+
+static guint
+get_notify_signal_id() {
+  static guint notify_signal_id = 0;
+  if (G_UNLIKELY(notify_signal_id == 0)) {
+    notify_signal_id = g_signal_lookup("notify", G_TYPE_OBJECT);
+  }
+
+  return notify_signal_id;
+}
+
+static Subscription *
+subscription_new(GrexDependencyRegistry *registry, const DependencyKey *key) {
+  Subscription *subscription = g_new0(Subscription, 1);
+  g_ref_count_init(&subscription->rc);
+
+  subscription->key = *key;
+  subscription->registry = registry;
+  subscription->readers = g_hash_table_new(NULL, NULL);
+
+  if (key->object != NULL) {
+    // The detail is resolved from the pspec directly, rather than parsing a
+    // "notify::" string for every read.
+    subscription->handler_id = g_signal_connect_closure_by_id(
+        key->object, get_notify_signal_id(),
+        g_param_spec_get_name_quark(key->pspec),
+        g_cclosure_new(G_CALLBACK(on_subscribed_notify), subscription, NULL),
+        FALSE);
+    g_object_weak_ref(key->object, on_subscribed_object_finalized,
+                      subscription);
+  }
+
+  subscription->alive = TRUE;
+
+  // The registry's reference, which lasts until the last reader is gone.
+  g_hash_table_add(registry->subscriptions, subscription);
+  return subscription;
+}
+
+// Drops an owner's reference to a subscription, disconnecting it if that owner
+// was the last reader.
+static void
+subscription_release(GrexDependencyOwner *owner, Subscription *subscription) {
+  g_hash_table_remove(subscription->readers, owner);
+
+  if (g_hash_table_size(subscription->readers) == 0 &&
+      subscription->registry != NULL && subscription->alive) {
+    // Removing it from the registry disconnects it.
+    g_hash_table_remove(subscription->registry->subscriptions, subscription);
+  }
+
+  subscription_unref(subscription);
+}
+
+static void
+registry_subscription_free(Subscription *subscription) {
+  subscription_disconnect(subscription);
+  subscription_unref(subscription);
+}
+
+static void
+cached_read_clear(CachedRead *read) {
+  subscription_unref(read->subscription);
+}
+
+static GArray *
+cached_reads_new() {
+  GArray *reads = g_array_new(FALSE, FALSE, sizeof(CachedRead));
+  g_array_set_clear_func(reads, (GDestroyNotify)cached_read_clear);
+  return reads;
+}
+
+static void
+cached_reads_append(GArray *reads, Subscription *subscription,
+                    guint64 serial) {
+  CachedRead read = {.subscription = subscription_ref(subscription),
+                     .serial = serial};
+  g_array_append_val(reads, read);
+}
+
+// Checks that nothing read changed since, and that all of it is still being
+// watched for changes at all.
+static gboolean
+cached_reads_are_current(GArray *reads) {
+  for (guint i = 0; i < reads->len; i++) {
+    CachedRead *read = &g_array_index(reads, CachedRead, i);
+    if (!read->subscription->alive ||
+        read->subscription->serial != read->serial) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+static void
+path_free(Path *path) {
+  g_weak_ref_clear(&path->object);
+  g_clear_pointer(&path->reads, g_array_unref);
+  g_free(path);
+}
+
+// Adds a read to the innermost path or memo currently being recorded, if any.
+static void
+owner_record_read(GrexDependencyOwner *owner, Subscription *subscription,
+                  guint64 serial) {
+  if (owner->recorders->len > 0) {
+    GArray *reads =
+        g_ptr_array_index(owner->recorders, owner->recorders->len - 1);
+    cached_reads_append(reads, subscription, serial);
+  }
+}
+
+static void
+owner_begin_recording(GrexDependencyOwner *owner) {
+  g_ptr_array_add(owner->recorders, cached_reads_new());
+}
+
+// Returns the reads recorded since the matching begin, which are also added to
+// whatever was being recorded before.
+static GArray *
+owner_end_recording(GrexDependencyOwner *owner) {
+  GArray *reads =
+      g_ptr_array_steal_index(owner->recorders, owner->recorders->len - 1);
+
+  for (guint i = 0; i < reads->len; i++) {
+    CachedRead *read = &g_array_index(reads, CachedRead, i);
+    owner_record_read(owner, read->subscription, read->serial);
+  }
+
+  return reads;
+}
+
+// Tracks a previous read again on behalf of the owner, without reading the
+// subscription's value again.
+static void
+owner_replay_read(GrexDependencyOwner *owner, CachedRead *read) {
+  Subscription *existing = NULL;
+  if (g_hash_table_lookup_extended(owner->subscriptions, read->subscription,
+                                   (gpointer *)&existing, NULL) &&
+      existing != read->subscription) {
+    // A stale subscription for an object that had the same address.
+    g_hash_table_steal(owner->subscriptions, existing);
+    subscription_release(owner, existing);
+    existing = NULL;
+  }
+
+  if (existing == NULL) {
+    g_hash_table_add(read->subscription->readers, owner);
+    g_hash_table_insert(owner->subscriptions,
+                        subscription_ref(read->subscription),
+                        GUINT_TO_POINTER(owner->generation));
+  } else {
+    g_hash_table_insert(owner->subscriptions, existing,
+                        GUINT_TO_POINTER(owner->generation));
+  }
+
+  owner_record_read(owner, read->subscription, read->serial);
+}
+
+GrexDependencyOwner *
+grex_dependency_owner_new(gpointer data, GDestroyNotify data_destroy) {
+  GrexDependencyOwner *owner = g_new0(GrexDependencyOwner, 1);
+  g_ref_count_init(&owner->rc);
+
+  owner->data = data;
+  owner->data_destroy = data_destroy;
+
+  owner->subscriptions = g_hash_table_new((GHashFunc)dependency_key_hash,
+                                          (GEqualFunc)dependency_key_equals);
+  owner->paths = g_hash_table_new_full(NULL, NULL, g_object_unref,
+                                       (GDestroyNotify)path_free);
+  owner->recorders =
+      g_ptr_array_new_with_free_func((GDestroyNotify)g_array_unref);
+  return owner;
+}
+
+GrexDependencyOwner *
+grex_dependency_owner_ref(GrexDependencyOwner *owner) {
+  g_ref_count_inc(&owner->rc);
+  return owner;
+}
+
+void
+grex_dependency_owner_unref(GrexDependencyOwner *owner) {
+  if (g_ref_count_dec(&owner->rc)) {
+    grex_dependency_owner_reset(owner);
+    g_clear_pointer(&owner->subscriptions, g_hash_table_unref);
+    g_clear_pointer(&owner->paths, g_hash_table_unref);
+    g_clear_pointer(&owner->recorders, g_ptr_array_unref);
+
+    if (owner->data_destroy != NULL) {
+      owner->data_destroy(owner->data);
+    }
+
+    g_free(owner);
+  }
+}
+
+gpointer
+grex_dependency_owner_get_data(GrexDependencyOwner *owner) {
+  return owner->data;
+}
+
+// Starts a new tracking pass for this owner. Any dependencies that aren't
+// tracked again before grex_dependency_owner_end_tracking is called are
+// disconnected, and the rest are left untouched.
+void
+grex_dependency_owner_begin_tracking(GrexDependencyOwner *owner) {
+  owner->generation++;
+}
+
+void
+grex_dependency_owner_end_tracking(GrexDependencyOwner *owner) {
+  GHashTableIter iter;
+  gpointer subscription, generation;
+
+  gpointer path;
+  g_hash_table_iter_init(&iter, owner->paths);
+  while (g_hash_table_iter_next(&iter, NULL, &path)) {
+    if (((Path *)path)->generation != owner->generation) {
+      g_hash_table_iter_remove(&iter);
+    }
+  }
+
+  g_hash_table_iter_init(&iter, owner->subscriptions);
+  while (g_hash_table_iter_next(&iter, &subscription, &generation)) {
+    if (GPOINTER_TO_UINT(generation) != owner->generation) {
+      g_hash_table_iter_steal(&iter);
+      subscription_release(owner, subscription);
+    }
+  }
+}
+
+// Drops all the dependencies tracked by this owner.
+void
+grex_dependency_owner_reset(GrexDependencyOwner *owner) {
+  g_hash_table_remove_all(owner->paths);
+
+  GHashTableIter iter;
+  gpointer subscription;
+  g_hash_table_iter_init(&iter, owner->subscriptions);
+  while (g_hash_table_iter_next(&iter, &subscription, NULL)) {
+    g_hash_table_iter_steal(&iter);
+    subscription_release(owner, subscription);
+  }
+}
+
+// Looks up the object that the path identified by key resolved to when it was
+// last resolved on behalf of this owner. If nothing it read changed since, the
+// reads are tracked again as if the path was resolved from scratch, and the
+// object is returned. Otherwise, returns NULL, and the path has to be resolved
+// again between grex_dependency_owner_begin_path and
+// grex_dependency_owner_end_path.
+GObject *
+grex_dependency_owner_lookup_path(GrexDependencyOwner *owner, GObject *key) {
+  Path *path = g_hash_table_lookup(owner->paths, key);
+  if (path == NULL || !cached_reads_are_current(path->reads)) {
+    return NULL;
+  }
+
+  GObject *object = g_weak_ref_get(&path->object);
+  if (object == NULL) {
+    return NULL;
+  }
+
+  path->generation = owner->generation;
+  for (guint i = 0; i < path->reads->len; i++) {
+    owner_replay_read(owner, &g_array_index(path->reads, CachedRead, i));
+  }
+
+  return object;
+}
+
+// Starts recording the dependencies tracked to resolve the path identified by
+// key. Paths can be nested, in which case the inner path's reads are part of
+// the outer one's as well.
+void
+grex_dependency_owner_begin_path(GrexDependencyOwner *owner, GObject *key) {
+  owner_begin_recording(owner);
+}
+
+// Finishes resolving the path identified by key, caching the object it
+// resolved to. If object is NULL, the path couldn't be resolved, and nothing
+// is cached.
+void
+grex_dependency_owner_end_path(GrexDependencyOwner *owner, GObject *key,
+                               GObject *object) {
+  g_return_if_fail(owner->recorders->len > 0);
+
+  g_autoptr(GArray) reads = owner_end_recording(owner);
+
+  if (object == NULL) {
+    g_hash_table_remove(owner->paths, key);
+    return;
+  }
+
+  Path *path = g_new0(Path, 1);
+  g_weak_ref_init(&path->object, object);
+  path->reads = g_steal_pointer(&reads);
+  path->generation = owner->generation;
+  g_hash_table_insert(owner->paths, g_object_ref(key), path);
+}
+
+GrexDependencyMemo *
+grex_dependency_memo_new() {
+  return g_new0(GrexDependencyMemo, 1);
+}
+
+static void
+grex_dependency_memo_clear(GrexDependencyMemo *memo) {
+  if (G_IS_VALUE(&memo->value)) {
+    g_value_unset(&memo->value);
+  }
+
+  g_clear_pointer(&memo->reads, g_array_unref);
+}
+
+void
+grex_dependency_memo_free(GrexDependencyMemo *memo) {
+  grex_dependency_memo_clear(memo);
+  g_free(memo);
+}
+
+// Copies the memo's value into dest, as long as none of the dependencies read
+// to compute it changed since. Unlike paths, memos aren't tied to an owner, so
+// any owner can use one, in which case the memo's reads are tracked on its
+// behalf (owner may be NULL if nothing should be tracked). Returns FALSE if the
+// value has to be computed again between grex_dependency_owner_begin_memo and
+// grex_dependency_owner_end_memo.
+gboolean
+grex_dependency_memo_use(GrexDependencyMemo *memo, GrexDependencyOwner *owner,
+                         GValue *dest) {
+  if (memo->reads == NULL || !cached_reads_are_current(memo->reads)) {
+    return FALSE;
+  }
+
+  if (owner != NULL) {
+    for (guint i = 0; i < memo->reads->len; i++) {
+      owner_replay_read(owner, &g_array_index(memo->reads, CachedRead, i));
+    }
+  }
+
+  g_value_init(dest, G_VALUE_TYPE(&memo->value));
+  g_value_copy(&memo->value, dest);
+  return TRUE;
+}
+
+// Starts recording the dependencies tracked on behalf of the owner to compute
+// a memo's value. Like paths, memos can be nested.
+void
+grex_dependency_owner_begin_memo(GrexDependencyOwner *owner) {
+  owner_begin_recording(owner);
+}
+
+// Finishes computing a memo's value, storing it along with everything read to
+// compute it. If value is NULL, the computation failed, and the memo is left
+// empty.
+void
+grex_dependency_owner_end_memo(GrexDependencyOwner *owner,
+                               GrexDependencyMemo *memo, const GValue *value) {
+  g_return_if_fail(owner->recorders->len > 0);
+
+  g_autoptr(GArray) reads = owner_end_recording(owner);
+
+  grex_dependency_memo_clear(memo);
+  if (value != NULL) {
+    g_value_init(&memo->value, G_VALUE_TYPE(value));
+    g_value_copy(value, &memo->value);
+    memo->reads = g_steal_pointer(&reads);
+  }
+}
+
+GrexDependencyRegistry *
+grex_dependency_registry_new(GrexDependencyRegistryChangedFunc changed_func,
+                             gpointer user_data) {
+  GrexDependencyRegistry *registry = g_new0(GrexDependencyRegistry, 1);
+  registry->changed_func = changed_func;
+  registry->user_data = user_data;
+
+  registry->subscriptions = g_hash_table_new_full(
+      (GHashFunc)dependency_key_hash, (GEqualFunc)dependency_key_equals,
+      (GDestroyNotify)registry_subscription_free, NULL);
+
+  registry->root_owner = grex_dependency_owner_new(NULL, NULL);
+  registry->invalidated_owners = g_ptr_array_new_with_free_func(
+      (GDestroyNotify)grex_dependency_owner_unref);
+  return registry;
+}
+
+void
+grex_dependency_registry_free(GrexDependencyRegistry *registry) {
+  // Owners may outlive the registry, so make sure their subscriptions won't try
+  // to reach it anymore.
+  GHashTableIter iter;
+  gpointer subscription;
+  g_hash_table_iter_init(&iter, registry->subscriptions);
+  while (g_hash_table_iter_next(&iter, &subscription, NULL)) {
+    ((Subscription *)subscription)->registry = NULL;
+  }
+
+  g_clear_pointer(&registry->subscriptions, g_hash_table_unref);
+  g_clear_pointer(&registry->root_owner, grex_dependency_owner_unref);
+  g_clear_pointer(&registry->invalidated_owners, g_ptr_array_unref);
+  g_free(registry);
+}
+
+// Returns the owner used for dependencies that are tracked without any other
+// owner being active.
+GrexDependencyOwner *
+grex_dependency_registry_get_root_owner(GrexDependencyRegistry *registry) {
+  return registry->root_owner;
+}
+
+static void
+subscription_set_last_value(Subscription *subscription, const GValue *value) {
+  if (G_IS_VALUE(&subscription->last_value)) {
+    g_value_unset(&subscription->last_value);
+  }
+
+  // Only values of the property's own type can be compared against later ones.
+  if (value != NULL && subscription->key.pspec != NULL &&
+      G_VALUE_TYPE(value) ==
+          G_PARAM_SPEC_VALUE_TYPE(subscription->key.pspec)) {
+    g_value_init(&subscription->last_value, G_VALUE_TYPE(value));
+    g_value_copy(value, &subscription->last_value);
+  }
+}
+
+static void
+grex_dependency_registry_track_key(GrexDependencyRegistry *registry,
+                                   GrexDependencyOwner *owner,
+                                   const DependencyKey *key,
+                                   const GValue *value) {
+  Subscription *subscription = NULL;
+  if (g_hash_table_lookup_extended(owner->subscriptions, key,
+                                   (gpointer *)&subscription, NULL)) {
+    if (subscription->alive) {
+      // Already read by this owner, so just mark it as read again.
+      subscription_set_last_value(subscription, value);
+      g_hash_table_insert(owner->subscriptions, subscription,
+                          GUINT_TO_POINTER(owner->generation));
+      owner_record_read(owner, subscription, subscription->serial);
+      return;
+    }
+
+    // The object it was for is gone, and this is a new one that happens to
+    // have the same address.
+    g_hash_table_steal(owner->subscriptions, subscription);
+    subscription_release(owner, subscription);
+  }
+
+  subscription = g_hash_table_lookup(registry->subscriptions, key);
+  if (subscription == NULL) {
+    subscription = subscription_new(registry, key);
+  }
+
+  subscription_set_last_value(subscription, value);
+  g_hash_table_add(subscription->readers, owner);
+  g_hash_table_insert(owner->subscriptions, subscription_ref(subscription),
+                      GUINT_TO_POINTER(owner->generation));
+  owner_record_read(owner, subscription, subscription->serial);
+}
+
+// Tracks a read of the given property on behalf of the owner. If value is
+// given, it's the value that was read, and later notifications that don't
+// change it are ignored.
+void
+grex_dependency_registry_track(GrexDependencyRegistry *registry,
+                               GrexDependencyOwner *owner, GObject *object,
+                               const char *property, const GValue *value) {
+  GParamSpec *pspec =
+      g_object_class_find_property(G_OBJECT_GET_CLASS(object), property);
+  g_return_if_fail(pspec != NULL);
+
+  DependencyKey key = {.object = object, .pspec = pspec};
+  grex_dependency_registry_track_key(registry, owner, &key, value);
+}
+
+// Tracks a lookup of the given extra name on behalf of the owner, regardless of
+// whether the name was actually found.
+void
+grex_dependency_registry_track_name(GrexDependencyRegistry *registry,
+                                    GrexDependencyOwner *owner,
+                                    const char *name) {
+  DependencyKey key = {.name = g_quark_from_string(name)};
+  grex_dependency_registry_track_key(registry, owner, &key, NULL);
+}
+
+// Invalidates every owner that looked up the given extra name. Unlike property
+// changes, this doesn't call the registry's changed function.
+void
+grex_dependency_registry_invalidate_name(GrexDependencyRegistry *registry,
+                                         const char *name) {
+  GQuark quark = g_quark_try_string(name);
+  if (quark == 0) {
+    return;
+  }
+
+  DependencyKey key = {.name = quark};
+  Subscription *subscription =
+      g_hash_table_lookup(registry->subscriptions, &key);
+  if (subscription != NULL) {
+    subscription->serial++;
+    invalidate_readers(registry, subscription);
+  }
+}
+
+// Returns every non-root owner that had a dependency change since the last
+// call, in the order the changes occurred. out_root_invalidated is set if the
+// root owner was invalidated as well.
+GPtrArray *
+grex_dependency_registry_take_invalidated(GrexDependencyRegistry *registry,
+                                          gboolean *out_root_invalidated) {
+  GPtrArray *owners = g_steal_pointer(&registry->invalidated_owners);
+  registry->invalidated_owners = g_ptr_array_new_with_free_func(
+      (GDestroyNotify)grex_dependency_owner_unref);
+
+  gboolean root_invalidated = registry->root_owner->invalidated;
+  registry->root_owner->invalidated = FALSE;
+  if (root_invalidated) {
+    g_ptr_array_remove(owners, registry->root_owner);
+  }
+
+  for (guint i = 0; i < owners->len; i++) {
+    GrexDependencyOwner *owner = g_ptr_array_index(owners, i);
+    owner->invalidated = FALSE;
+  }
+
+  if (out_root_invalidated != NULL) {
+    *out_root_invalidated = root_invalidated;
+  }
+
+  return owners;
+}
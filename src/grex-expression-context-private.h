@@ -4,11 +4,73 @@
 
 #pragma once
 
+#include "grex-binding.h"
 #include "grex-config.h"
+#include "grex-dependency-registry-private.h"
 #include "grex-expression-context.h"
 
 #ifndef _GREX_INTERNAL
 #error "This is internal stuff, you shouldn't be here!"
 #endif
 
+// A set of named values computed from bindings, each cached until one of its
+// dependencies changes. Scopes can be nested, in which case the inner scope's
+// values shadow the outer ones.
+typedef struct _GrexComputedScope GrexComputedScope;
+
+GrexComputedScope *grex_computed_scope_new();
+GrexComputedScope *grex_computed_scope_ref(GrexComputedScope *scope);
+void grex_computed_scope_unref(GrexComputedScope *scope);
+
+GrexComputedScope *grex_computed_scope_get_parent(GrexComputedScope *scope);
+void grex_computed_scope_set_parent(GrexComputedScope *scope,
+                                    GrexComputedScope *parent);
+
+void grex_computed_scope_begin_update(GrexComputedScope *scope);
+void grex_computed_scope_define(GrexComputedScope *scope, const char *name,
+                                GrexBinding *binding);
+void grex_computed_scope_end_update(GrexComputedScope *scope);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GrexComputedScope, grex_computed_scope_unref)
+
 void grex_expression_context_emit_changed(GrexExpressionContext *context);
+
+void grex_expression_context_push_computed_scope(GrexExpressionContext *context,
+                                                 GrexComputedScope *scope);
+void grex_expression_context_pop_computed_scope(GrexExpressionContext *context);
+gboolean grex_expression_context_find_computed(GrexExpressionContext *context,
+                                               const char *name,
+                                               gboolean track_dependencies,
+                                               GValue *dest, GError **error);
+
+void grex_expression_context_push_change_priority(
+    GrexExpressionContext *context, GrexChangePriority priority);
+void grex_expression_context_pop_change_priority(
+    GrexExpressionContext *context);
+
+void grex_expression_context_begin_tracking(GrexExpressionContext *context);
+void grex_expression_context_end_tracking(GrexExpressionContext *context);
+
+void grex_expression_context_push_dependency_owner(
+    GrexExpressionContext *context, GrexDependencyOwner *owner);
+void grex_expression_context_pop_dependency_owner(
+    GrexExpressionContext *context);
+
+void grex_expression_context_track_dependency(GrexExpressionContext *context,
+                                              GObject *object,
+                                              const char *property,
+                                              const GValue *value);
+
+void grex_expression_context_track_name(GrexExpressionContext *context,
+                                        const char *name);
+
+GObject *grex_expression_context_lookup_path(GrexExpressionContext *context,
+                                             GObject *key);
+void grex_expression_context_begin_path(GrexExpressionContext *context,
+                                        GObject *key);
+void grex_expression_context_end_path(GrexExpressionContext *context,
+                                      GObject *key, GObject *object);
+
+GPtrArray *
+grex_expression_context_get_invalidated_owners(GrexExpressionContext *context,
+                                               gboolean *out_unowned_changed);
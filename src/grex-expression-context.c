@@ -5,6 +5,7 @@
 #include "grex-expression-context.h"
 
 #include "gpropz.h"
+#include "grex-change-set-private.h"
 #include "grex-expression-context-private.h"
 
 struct _GrexExpressionContext {
@@ -12,8 +13,50 @@ struct _GrexExpressionContext {
 
   GObject *scope;
   GHashTable *extra_names;
+
+  GrexDependencyRegistry *registry;
+  GPtrArray *owner_stack;
+
+  // The changes since the last emission of "changed", and the ones being
+  // dispatched by the current emission.
+  GrexChangeSet *pending_changes;
+  GrexChangeSet *dispatched_changes;
+  // The dependency owners invalidated by the changes being dispatched. Every
+  // handler gets to see all of them, since a context can be shared by several
+  // inflators.
+  GPtrArray *dispatched_owners;
+  gboolean dispatched_unowned_changed;
+
+  guint batch_depth;
+  gboolean changed_in_batch;
+
+  // Maps objects to the GrexChangePriority of changes to their properties.
+  GHashTable *source_priorities;
+  // Overrides the priority of any changes made while it's not empty.
+  GArray *priority_stack;
+
+  // Stack of GrexComputedScope, innermost last.
+  GPtrArray *computed_scopes;
+};
+
+struct _GrexComputedScope {
+  grefcount rc;
+
+  GrexComputedScope *parent;
+  // Name -> ComputedValue.
+  GHashTable *values;
+  guint generation;
 };
 
+typedef struct {
+  GrexBinding *binding;
+  GrexDependencyMemo *memo;
+  // The update generation it was last defined in.
+  guint generation;
+  // Set while it's being computed, to catch values that depend on themselves.
+  gboolean computing;
+} ComputedValue;
+
 enum {
   PROP_SCOPE = 1,
   N_PROPS,
@@ -31,18 +74,123 @@ static guint signals[N_SIGNALS] = {0};
 
 G_DEFINE_TYPE(GrexExpressionContext, grex_expression_context, G_TYPE_OBJECT)
 
+static void
+computed_value_free(ComputedValue *value) {
+  g_clear_object(&value->binding);
+  g_clear_pointer(&value->memo, grex_dependency_memo_free);
+  g_free(value);
+}
+
+GrexComputedScope *
+grex_computed_scope_new() {
+  GrexComputedScope *scope = g_new0(GrexComputedScope, 1);
+  g_ref_count_init(&scope->rc);
+
+  scope->values = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                        (GDestroyNotify)computed_value_free);
+  return scope;
+}
+
+GrexComputedScope *
+grex_computed_scope_ref(GrexComputedScope *scope) {
+  g_ref_count_inc(&scope->rc);
+  return scope;
+}
+
+void
+grex_computed_scope_unref(GrexComputedScope *scope) {
+  if (g_ref_count_dec(&scope->rc)) {
+    g_clear_pointer(&scope->parent, grex_computed_scope_unref);
+    g_clear_pointer(&scope->values, g_hash_table_unref);
+    g_free(scope);
+  }
+}
+
+GrexComputedScope *
+grex_computed_scope_get_parent(GrexComputedScope *scope) {
+  return scope->parent;
+}
+
+void
+grex_computed_scope_set_parent(GrexComputedScope *scope,
+                               GrexComputedScope *parent) {
+  if (parent != NULL) {
+    grex_computed_scope_ref(parent);
+  }
+
+  g_clear_pointer(&scope->parent, grex_computed_scope_unref);
+  scope->parent = parent;
+}
+
+// Starts redefining the scope's values. Any values that aren't defined again
+// before grex_computed_scope_end_update is called are removed, and the ones
+// that are defined with the same binding keep their cached values.
+void
+grex_computed_scope_begin_update(GrexComputedScope *scope) {
+  scope->generation++;
+}
+
+void
+grex_computed_scope_define(GrexComputedScope *scope, const char *name,
+                           GrexBinding *binding) {
+  ComputedValue *value = g_hash_table_lookup(scope->values, name);
+  if (value == NULL || value->binding != binding) {
+    value = g_new0(ComputedValue, 1);
+    value->binding = g_object_ref(binding);
+    value->memo = grex_dependency_memo_new();
+    g_hash_table_insert(scope->values, g_strdup(name), value);
+  }
+
+  value->generation = scope->generation;
+}
+
+void
+grex_computed_scope_end_update(GrexComputedScope *scope) {
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init(&iter, scope->values);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    if (((ComputedValue *)value)->generation != scope->generation) {
+      g_hash_table_iter_remove(&iter);
+    }
+  }
+}
+
 static void
 destroy_gvalue(GValue *value) {
   g_value_unset(value);
   g_free(value);
 }
 
+static void
+on_prioritized_source_finalized(gpointer user_data, GObject *source) {
+  GrexExpressionContext *context = GREX_EXPRESSION_CONTEXT(user_data);
+  g_hash_table_remove(context->source_priorities, source);
+}
+
 static void
 grex_expression_context_dispose(GObject *object) {
   GrexExpressionContext *context = GREX_EXPRESSION_CONTEXT(object);
 
+  if (context->source_priorities != NULL) {
+    GHashTableIter iter;
+    gpointer source;
+    g_hash_table_iter_init(&iter, context->source_priorities);
+    while (g_hash_table_iter_next(&iter, &source, NULL)) {
+      g_object_weak_unref(source, on_prioritized_source_finalized, context);
+    }
+
+    g_clear_pointer(&context->source_priorities, g_hash_table_unref);
+  }
+
+  g_clear_pointer(&context->priority_stack, g_array_unref);
+  g_clear_pointer(&context->computed_scopes, g_ptr_array_unref);
+
   g_clear_object(&context->scope);
   g_clear_pointer(&context->extra_names, g_hash_table_unref);
+  g_clear_pointer(&context->owner_stack, g_ptr_array_unref);
+  g_clear_pointer(&context->registry, grex_dependency_registry_free);
+  g_clear_object(&context->pending_changes);
 }
 
 static void
@@ -59,10 +207,12 @@ grex_expression_context_class_init(GrexExpressionContextClass *klass) {
   gpropz_install_property(object_class, GrexExpressionContext, scope,
                           PROP_SCOPE, properties[PROP_SCOPE], NULL);
 
+  // Changes made by handlers are emitted recursively, each emission with its
+  // own change set.
   signals[SIGNAL_CHANGED] =
       g_signal_new("changed", G_TYPE_FROM_CLASS(object_class),
-                   G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
-                   0, NULL, NULL, NULL, G_TYPE_NONE, 0);
+                   G_SIGNAL_RUN_LAST | G_SIGNAL_NO_HOOKS, 0, NULL, NULL, NULL,
+                   G_TYPE_NONE, 0);
 
   signals[SIGNAL_RESET] =
       g_signal_new("reset", G_TYPE_FROM_CLASS(object_class),
@@ -70,10 +220,46 @@ grex_expression_context_class_init(GrexExpressionContextClass *klass) {
                    0, NULL, NULL, NULL, G_TYPE_NONE, 0);
 }
 
+static GrexChangePriority
+get_change_priority(GrexExpressionContext *context, GObject *source) {
+  if (context->priority_stack->len > 0) {
+    return g_array_index(context->priority_stack, GrexChangePriority,
+                         context->priority_stack->len - 1);
+  }
+
+  gpointer priority = NULL;
+  if (source != NULL &&
+      g_hash_table_lookup_extended(context->source_priorities, source, NULL,
+                                   &priority)) {
+    return GPOINTER_TO_INT(priority);
+  }
+
+  return GREX_CHANGE_PRIORITY_HIGH;
+}
+
+static void
+on_dependency_changed(GObject *object, GParamSpec *pspec, gpointer user_data) {
+  GrexExpressionContext *context = GREX_EXPRESSION_CONTEXT(user_data);
+
+  grex_change_set_add_property(context->pending_changes, object, pspec,
+                               get_change_priority(context, object));
+  grex_expression_context_emit_changed(context);
+}
+
 static void
 grex_expression_context_init(GrexExpressionContext *context) {
   context->extra_names = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
                                                (GDestroyNotify)destroy_gvalue);
+  context->registry =
+      grex_dependency_registry_new(on_dependency_changed, context);
+  context->pending_changes = grex_change_set_new();
+  context->owner_stack = g_ptr_array_new_with_free_func(
+      (GDestroyNotify)grex_dependency_owner_unref);
+  context->source_priorities = g_hash_table_new(NULL, NULL);
+  context->priority_stack =
+      g_array_new(FALSE, FALSE, sizeof(GrexChangePriority));
+  context->computed_scopes = g_ptr_array_new_with_free_func(
+      (GDestroyNotify)grex_computed_scope_unref);
 }
 
 /**
@@ -128,6 +314,8 @@ GPROPZ_DEFINE_RO(GObject *, GrexExpressionContext, grex_expression_context,
  */
 void
 grex_expression_context_reset_dependencies(GrexExpressionContext *context) {
+  grex_dependency_owner_reset(
+      grex_dependency_registry_get_root_owner(context->registry));
   g_signal_emit(context, signals[SIGNAL_RESET], 0);
 }
 
@@ -149,6 +337,10 @@ grex_expression_context_insert(GrexExpressionContext *context, const char *name,
 
   gboolean newly_inserted =
       g_hash_table_insert(context->extra_names, g_strdup(name), cloned_value);
+
+  grex_change_set_add_name(context->pending_changes, name,
+                           get_change_priority(context, NULL));
+  grex_dependency_registry_invalidate_name(context->registry, name);
   grex_expression_context_emit_changed(context);
   return newly_inserted;
 }
@@ -190,9 +382,318 @@ grex_expression_context_find_name(GrexExpressionContext *context,
   return FALSE;
 }
 
+/**
+ * grex_expression_context_begin_batch:
+ *
+ * Starts a batch of changes. Until the matching call to
+ * grex_expression_context_end_batch(), any insertions or dependency changes
+ * are only accumulated, and #GrexExpressionContext::changed is emitted once
+ * when the batch ends. Batches can be nested, in which case the signal is
+ * emitted when the outermost one ends.
+ */
+void
+grex_expression_context_begin_batch(GrexExpressionContext *context) {
+  context->batch_depth++;
+}
+
+/**
+ * grex_expression_context_end_batch:
+ *
+ * Ends a batch of changes started by grex_expression_context_begin_batch(),
+ * emitting #GrexExpressionContext::changed if anything changed during it.
+ */
+void
+grex_expression_context_end_batch(GrexExpressionContext *context) {
+  g_return_if_fail(context->batch_depth > 0);
+
+  if (--context->batch_depth == 0 && context->changed_in_batch) {
+    context->changed_in_batch = FALSE;
+    grex_expression_context_emit_changed(context);
+  }
+}
+
+/**
+ * grex_expression_context_get_changes:
+ *
+ * Returns the changes being announced by the current emission of
+ * #GrexExpressionContext::changed, i.e. every tracked property and extra name
+ * that changed since the previous emission. This can only be used from a
+ * signal handler.
+ *
+ * Returns: (transfer none) (nullable): The changes, or %NULL if the signal is
+ *          not being emitted.
+ */
+GrexChangeSet *
+grex_expression_context_get_changes(GrexExpressionContext *context) {
+  return context->dispatched_changes;
+}
+
+/**
+ * grex_expression_context_set_source_priority:
+ * @source: The object to set the priority of.
+ * @priority: The new priority.
+ *
+ * Sets the priority of changes to any property of @source. By default, all
+ * changes have %GREX_CHANGE_PRIORITY_HIGH, but e.g. objects that are updated
+ * by timers or background data refreshes can be set to
+ * %GREX_CHANGE_PRIORITY_LOW, so a #GrexReactiveInflator can defer their
+ * updates until the main loop is idle. Changes pushed back into the scope by
+ * two-way bindings always have %GREX_CHANGE_PRIORITY_HIGH.
+ */
+void
+grex_expression_context_set_source_priority(GrexExpressionContext *context,
+                                            GObject *source,
+                                            GrexChangePriority priority) {
+  if (!g_hash_table_contains(context->source_priorities, source)) {
+    g_object_weak_ref(source, on_prioritized_source_finalized, context);
+  }
+
+  g_hash_table_insert(context->source_priorities, source,
+                      GINT_TO_POINTER(priority));
+}
+
+// Overrides the priority of any changes made until the matching pop,
+// regardless of their source.
+void
+grex_expression_context_push_change_priority(GrexExpressionContext *context,
+                                             GrexChangePriority priority) {
+  g_array_append_val(context->priority_stack, priority);
+}
+
+void
+grex_expression_context_pop_change_priority(GrexExpressionContext *context) {
+  g_return_if_fail(context->priority_stack->len > 0);
+  g_array_set_size(context->priority_stack, context->priority_stack->len - 1);
+}
+
+// Makes the scope's computed values (and its parents') visible to any
+// expressions evaluated until the matching pop.
+void
+grex_expression_context_push_computed_scope(GrexExpressionContext *context,
+                                            GrexComputedScope *scope) {
+  g_ptr_array_add(context->computed_scopes, grex_computed_scope_ref(scope));
+}
+
+void
+grex_expression_context_pop_computed_scope(GrexExpressionContext *context) {
+  g_return_if_fail(context->computed_scopes->len > 0);
+  g_ptr_array_remove_index(context->computed_scopes,
+                           context->computed_scopes->len - 1);
+}
+
+static GrexDependencyOwner *
+grex_expression_context_get_current_owner(GrexExpressionContext *context);
+
+// Looks up a computed value in the innermost computed scope. Returns FALSE if
+// it's not defined there. Otherwise, returns TRUE and either stores the value
+// in dest, or leaves dest untouched and sets error if it couldn't be computed.
+// A cached value is only used if none of its dependencies changed, and if
+// track_dependencies is set, those dependencies are tracked as if the value
+// was computed from scratch, so whatever read it is invalidated along with it.
+gboolean
+grex_expression_context_find_computed(GrexExpressionContext *context,
+                                      const char *name,
+                                      gboolean track_dependencies,
+                                      GValue *dest, GError **error) {
+  if (context->computed_scopes->len == 0) {
+    return FALSE;
+  }
+
+  GrexComputedScope *scope = g_ptr_array_index(
+      context->computed_scopes, context->computed_scopes->len - 1);
+  ComputedValue *value = NULL;
+  for (; scope != NULL; scope = scope->parent) {
+    if ((value = g_hash_table_lookup(scope->values, name)) != NULL) {
+      break;
+    }
+  }
+
+  if (value == NULL) {
+    return FALSE;
+  }
+
+  GrexDependencyOwner *owner =
+      track_dependencies ? grex_expression_context_get_current_owner(context)
+                         : NULL;
+  if (grex_dependency_memo_use(value->memo, owner, dest)) {
+    return TRUE;
+  }
+
+  if (value->computing) {
+    grex_set_located_error(error, grex_binding_get_location(value->binding),
+                           GREX_EXPRESSION_EVALUATION_ERROR,
+                           GREX_EXPRESSION_EVALUATION_ERROR_RECURSIVE_NAME,
+                           "Computed value '%s' depends on itself", name);
+    return TRUE;
+  }
+
+  // The value only sees what's visible where it was defined.
+  grex_expression_context_push_computed_scope(context, scope);
+  value->computing = TRUE;
+
+  // Without tracking, there's no way to tell when the result becomes stale, so
+  // it can't be cached.
+  if (owner != NULL) {
+    grex_dependency_owner_begin_memo(owner);
+  }
+
+  g_autoptr(GrexValueHolder) result =
+      grex_binding_evaluate(value->binding, G_TYPE_NONE, context,
+                            track_dependencies, error);
+
+  if (owner != NULL) {
+    grex_dependency_owner_end_memo(
+        owner, value->memo,
+        result != NULL ? grex_value_holder_get_value(result) : NULL);
+  }
+
+  value->computing = FALSE;
+  grex_expression_context_pop_computed_scope(context);
+
+  if (result != NULL) {
+    const GValue *result_value = grex_value_holder_get_value(result);
+    g_value_init(dest, G_VALUE_TYPE(result_value));
+    g_value_copy(result_value, dest);
+  }
+
+  return TRUE;
+}
+
 void
 grex_expression_context_emit_changed(GrexExpressionContext *context) {
-  g_object_freeze_notify(G_OBJECT(context));
+  if (context->batch_depth > 0) {
+    context->changed_in_batch = TRUE;
+    return;
+  }
+
+  g_autoptr(GrexChangeSet) changes =
+      g_steal_pointer(&context->pending_changes);
+  context->pending_changes = grex_change_set_new();
+
+  gboolean unowned_changed = FALSE;
+  g_autoptr(GPtrArray) owners = grex_dependency_registry_take_invalidated(
+      context->registry, &unowned_changed);
+
+  GrexChangeSet *outer_changes = context->dispatched_changes;
+  GPtrArray *outer_owners = context->dispatched_owners;
+  gboolean outer_unowned_changed = context->dispatched_unowned_changed;
+  context->dispatched_changes = changes;
+  context->dispatched_owners = owners;
+  context->dispatched_unowned_changed = unowned_changed;
   g_signal_emit(context, signals[SIGNAL_CHANGED], 0);
-  g_object_thaw_notify(G_OBJECT(context));
+  context->dispatched_changes = outer_changes;
+  context->dispatched_owners = outer_owners;
+  context->dispatched_unowned_changed = outer_unowned_changed;
+}
+
+// Starts tracking the dependencies read without any dependency owner pushed.
+// Dependencies that were tracked before but aren't read again until
+// grex_expression_context_end_tracking is called are disconnected, while the
+// ones that are read again keep their existing connections.
+void
+grex_expression_context_begin_tracking(GrexExpressionContext *context) {
+  grex_dependency_owner_begin_tracking(
+      grex_dependency_registry_get_root_owner(context->registry));
+}
+
+void
+grex_expression_context_end_tracking(GrexExpressionContext *context) {
+  grex_dependency_owner_end_tracking(
+      grex_dependency_registry_get_root_owner(context->registry));
+}
+
+// Pushes an owner for the dependencies tracked until the matching pop. Like
+// with grex_expression_context_begin_tracking, the dependencies tracked in
+// between replace the owner's previous ones.
+void
+grex_expression_context_push_dependency_owner(GrexExpressionContext *context,
+                                              GrexDependencyOwner *owner) {
+  grex_dependency_owner_begin_tracking(owner);
+  g_ptr_array_add(context->owner_stack, grex_dependency_owner_ref(owner));
+}
+
+void
+grex_expression_context_pop_dependency_owner(GrexExpressionContext *context) {
+  g_return_if_fail(context->owner_stack->len > 0);
+
+  g_autoptr(GrexDependencyOwner) owner =
+      g_ptr_array_steal_index(context->owner_stack,
+                              context->owner_stack->len - 1);
+  grex_dependency_owner_end_tracking(owner);
+}
+
+static GrexDependencyOwner *
+grex_expression_context_get_current_owner(GrexExpressionContext *context) {
+  if (context->owner_stack->len == 0) {
+    return grex_dependency_registry_get_root_owner(context->registry);
+  }
+
+  return g_ptr_array_index(context->owner_stack,
+                           context->owner_stack->len - 1);
+}
+
+// Tracks a read of the given property, emitting "changed" once the property
+// changes to something other than the value that was read. The dependency
+// belongs to the currently pushed dependency owner, or to the context itself if
+// there is none, in which case it lasts until it's no longer read or
+// grex_expression_context_reset_dependencies is called.
+void
+grex_expression_context_track_dependency(GrexExpressionContext *context,
+                                         GObject *object,
+                                         const char *property,
+                                         const GValue *value) {
+  grex_dependency_registry_track(
+      context->registry, grex_expression_context_get_current_owner(context),
+      object, property, value);
+}
+
+// Tracks a lookup of the given extra name, so that inserting it later
+// invalidates whatever looked it up. Like property dependencies, it belongs to
+// the current dependency owner (or to the context itself if there is none).
+void
+grex_expression_context_track_name(GrexExpressionContext *context,
+                                   const char *name) {
+  grex_dependency_registry_track_name(
+      context->registry, grex_expression_context_get_current_owner(context),
+      name);
+}
+
+// Returns the object that a path (identified by the expression resolving it)
+// resolved to the last time the current dependency owner tracked it, as long as
+// none of the dependencies read to resolve it changed since. Those dependencies
+// are tracked again as if they were just read. Returns NULL if the path has to
+// be resolved again, which must be surrounded by
+// grex_expression_context_begin_path and grex_expression_context_end_path.
+GObject *
+grex_expression_context_lookup_path(GrexExpressionContext *context,
+                                    GObject *key) {
+  return grex_dependency_owner_lookup_path(
+      grex_expression_context_get_current_owner(context), key);
+}
+
+void
+grex_expression_context_begin_path(GrexExpressionContext *context,
+                                   GObject *key) {
+  grex_dependency_owner_begin_path(
+      grex_expression_context_get_current_owner(context), key);
+}
+
+// Caches the object the path resolved to, or NULL if it couldn't be resolved.
+void
+grex_expression_context_end_path(GrexExpressionContext *context, GObject *key,
+                                 GObject *object) {
+  grex_dependency_owner_end_path(
+      grex_expression_context_get_current_owner(context), key, object);
+}
+
+// Returns every dependency owner invalidated by the changes currently being
+// dispatched via "changed", in the order the changes occurred, or NULL outside
+// of an emission. The owners aren't consumed, so every handler sees the same
+// ones. out_unowned_changed is set if a dependency without an owner changed as
+// well.
+GPtrArray *
+grex_expression_context_get_invalidated_owners(GrexExpressionContext *context,
+                                               gboolean *out_unowned_changed) {
+  *out_unowned_changed = context->dispatched_unowned_changed;
+  return context->dispatched_owners;
 }
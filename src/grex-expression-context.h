@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "grex-change-set.h"
 #include "grex-config.h"
 #include "grex-source-location.h"
 #include "grex-value-holder.h"
@@ -29,4 +30,14 @@ gboolean grex_expression_context_find_name(GrexExpressionContext *context,
 
 void grex_expression_context_reset_dependencies(GrexExpressionContext *context);
 
+void grex_expression_context_begin_batch(GrexExpressionContext *context);
+void grex_expression_context_end_batch(GrexExpressionContext *context);
+
+GrexChangeSet *
+grex_expression_context_get_changes(GrexExpressionContext *context);
+
+void grex_expression_context_set_source_priority(
+    GrexExpressionContext *context, GObject *source,
+    GrexChangePriority priority);
+
 G_END_DECLS
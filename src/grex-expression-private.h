@@ -11,18 +11,104 @@
 #error "This is internal stuff, you shouldn't be here!"
 #endif
 
-#define GREX_EXPRESSION_EVALUATION_PROPAGATE_FLAGS(flags) \
-  ((flags) & (GREX_EXPRESSION_EVALUATION_TRACK_DEPENDENCIES))
+typedef enum {
+  // Loads a constant into dest.
+  GREX_EXPRESSION_OP_CONSTANT,
+  // Loads the context's scope object into dest.
+  GREX_EXPRESSION_OP_SCOPE,
+  // Loads a computed value or a name from the scope into dest.
+  GREX_EXPRESSION_OP_LOOKUP_NAME,
+  // Starts resolving a property path (see GrexPropertyExpression). If the
+  // context already has the path's object, it's loaded into dest, and
+  // execution continues at jump, skipping the path's own instructions.
+  GREX_EXPRESSION_OP_BEGIN_PATH,
+  // Checks that src holds a non-null object to get a property from.
+  GREX_EXPRESSION_OP_CHECK_OBJECT,
+  // Finishes resolving the property path whose object is in src.
+  GREX_EXPRESSION_OP_END_PATH,
+  // Loads a property of the object in src into dest.
+  GREX_EXPRESSION_OP_GET_PROPERTY,
+  // Emits a signal on the object in src, with the n_args registers after it as
+  // the arguments, and loads the return value into dest.
+  GREX_EXPRESSION_OP_EMIT_SIGNAL,
+} GrexExpressionOp;
+
+typedef struct {
+  GrexExpressionOp op;
+
+  // The expression this instruction was compiled from, used for error
+  // locations. For paths and object checks, this is the object expression.
+  GrexExpression *expression;
+
+  // The registers written and read.
+  guint dest;
+  guint src;
+
+  // For property names, signals and names in the scope, interned.
+  const char *name;
+
+  union {
+    // For CONSTANT.
+    GrexValueHolder *constant;
+    // For BEGIN_PATH.
+    guint jump;
+    // For EMIT_SIGNAL, along with the expression for the object, or NULL if
+    // it's emitted on the scope.
+    struct {
+      guint n_args;
+      GQuark detail;
+      GrexExpression *object;
+    };
+  };
+} GrexExpressionInstruction;
+
+// An expression tree compiled into a flat list of instructions operating on
+// registers. The result always ends up in register 0.
+typedef struct {
+  GrexExpressionInstruction *instructions;
+  guint n_instructions;
+  guint n_registers;
+} GrexExpressionProgram;
+
+typedef struct _GrexExpressionCompiler GrexExpressionCompiler;
+
+guint grex_expression_compiler_add_registers(GrexExpressionCompiler *compiler,
+                                             guint n);
+guint grex_expression_compiler_emit(GrexExpressionCompiler *compiler,
+                                    GrexExpressionOp op,
+                                    GrexExpression *expression, guint dest);
+GrexExpressionInstruction *
+grex_expression_compiler_get_instruction(GrexExpressionCompiler *compiler,
+                                         guint index);
+guint grex_expression_compiler_get_position(GrexExpressionCompiler *compiler);
+
+void grex_expression_compile(GrexExpression *expression,
+                             GrexExpressionCompiler *compiler, guint dest);
+
+GrexExpressionProgram *grex_expression_program_new(GrexExpression *expression);
+void grex_expression_program_free(GrexExpressionProgram *program);
+
+GrexValueHolder *
+grex_expression_program_run(GrexExpressionProgram *program,
+                            GrexExpressionContext *context,
+                            GrexExpressionEvaluationFlags flags,
+                            GError **error);
 
 struct _GrexExpressionClass {
   GObjectClass parent_class;
 
-  GrexValueHolder *(*evaluate)(GrexExpression *expression,
-                               GrexExpressionContext *context,
-                               GrexExpressionEvaluationFlags flags,
-                               GError **error);
+  // Emits the instructions that evaluate this expression into the dest
+  // register.
+  void (*compile)(GrexExpression *expression, GrexExpressionCompiler *compiler,
+                  guint dest);
 };
 
+GType grex_constant_value_expression_get_type();
+GType grex_property_expression_get_type();
+GType grex_signal_expression_get_type();
+
+GPtrArray *grex_signal_expression_get_args(GrexExpression *expression);
+
 void grex_set_expression_parse_error(GError **error,
                                      GrexSourceLocation *location, int code,
                                      const char *format, ...)
@@ -0,0 +1,504 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "grex-expression-context-private.h"
+#include "grex-expression-private.h"
+#include "grex-value-parser.h"
+
+// Expressions with up to this many registers don't need any allocations for
+// them.
+#define STACK_REGISTERS 16
+
+struct _GrexExpressionCompiler {
+  GArray *instructions;
+  guint n_registers;
+};
+
+// Reserves n consecutive registers, returning the first one.
+guint
+grex_expression_compiler_add_registers(GrexExpressionCompiler *compiler,
+                                       guint n) {
+  guint first = compiler->n_registers;
+  compiler->n_registers += n;
+  return first;
+}
+
+// Appends an instruction, returning its index. Any operands besides dest need
+// to be filled in via grex_expression_compiler_get_instruction().
+guint
+grex_expression_compiler_emit(GrexExpressionCompiler *compiler,
+                              GrexExpressionOp op, GrexExpression *expression,
+                              guint dest) {
+  GrexExpressionInstruction instruction = {
+      .op = op,
+      .expression = expression,
+      .dest = dest,
+  };
+  g_array_append_val(compiler->instructions, instruction);
+  return compiler->instructions->len - 1;
+}
+
+GrexExpressionInstruction *
+grex_expression_compiler_get_instruction(GrexExpressionCompiler *compiler,
+                                         guint index) {
+  return &g_array_index(compiler->instructions, GrexExpressionInstruction,
+                        index);
+}
+
+// Returns the index the next instruction will be emitted at.
+guint
+grex_expression_compiler_get_position(GrexExpressionCompiler *compiler) {
+  return compiler->instructions->len;
+}
+
+// Compiles the expression tree. The program refers to the expressions it was
+// compiled from without holding references, so the root expression has to
+// outlive it.
+GrexExpressionProgram *
+grex_expression_program_new(GrexExpression *expression) {
+  GrexExpressionCompiler compiler = {
+      .instructions =
+          g_array_new(FALSE, TRUE, sizeof(GrexExpressionInstruction)),
+      // Register 0 holds the result.
+      .n_registers = 1,
+  };
+
+  grex_expression_compile(expression, &compiler, 0);
+
+  GrexExpressionProgram *program = g_new0(GrexExpressionProgram, 1);
+  program->n_instructions = compiler.instructions->len;
+  program->n_registers = compiler.n_registers;
+  program->instructions = (GrexExpressionInstruction *)g_array_free(
+      g_steal_pointer(&compiler.instructions), FALSE);
+  return program;
+}
+
+void
+grex_expression_program_free(GrexExpressionProgram *program) {
+  g_free(program->instructions);
+  g_free(program);
+}
+
+typedef struct {
+  GrexExpressionContext *context;
+  GrexExpressionEvaluationFlags flags;
+  GValue *registers;
+
+  // The object the result was read from, for two-way bindings.
+  GObject *push_object;
+  const char *push_property;
+} Frame;
+
+typedef struct {
+  GObject *object;
+  char *property;
+} PushValueData;
+
+static void
+push_value_data_free(gpointer user_data) {
+  PushValueData *data = user_data;
+  g_object_unref(data->object);
+  g_free(data->property);
+  g_free(data);
+}
+
+static void
+on_push_value(const GValue *value, gpointer user_data) {
+  PushValueData *data = user_data;
+  g_object_set_property(data->object, data->property, value);
+}
+
+static GValue *
+reset_register(Frame *frame, guint index) {
+  GValue *value = &frame->registers[index];
+  if (G_IS_VALUE(value)) {
+    g_value_unset(value);
+  }
+
+  return value;
+}
+
+static void
+set_push_source(Frame *frame, const GrexExpressionInstruction *instruction,
+                GObject *object) {
+  // Only the result itself can be pushed back.
+  if (instruction->dest == 0 && object != NULL &&
+      frame->flags & GREX_EXPRESSION_EVALUATION_ENABLE_PUSH) {
+    g_set_object(&frame->push_object, object);
+    frame->push_property = instruction->name;
+  }
+}
+
+static void
+run_constant(Frame *frame, const GrexExpressionInstruction *instruction) {
+  const GValue *constant = grex_value_holder_get_value(instruction->constant);
+  GValue *dest = reset_register(frame, instruction->dest);
+  g_value_init(dest, G_VALUE_TYPE(constant));
+  // Always a real copy: the result can outlive the expression the constant
+  // belongs to, and a borrowed string would be carried along by any
+  // g_value_copy() of it.
+  g_value_copy(constant, dest);
+}
+
+static void
+run_scope(Frame *frame, const GrexExpressionInstruction *instruction) {
+  // TODO: this won't work when derived contexts become a thing
+  GObject *scope = grex_expression_context_get_scope(frame->context);
+  GValue *dest = reset_register(frame, instruction->dest);
+  g_value_init(dest, G_OBJECT_TYPE(scope));
+  g_value_set_object(dest, scope);
+}
+
+static gboolean
+run_lookup_name(Frame *frame, const GrexExpressionInstruction *instruction,
+                GError **error) {
+  gboolean track_dependencies =
+      frame->flags & GREX_EXPRESSION_EVALUATION_TRACK_DEPENDENCIES;
+
+  g_autoptr(GObject) originating_object = NULL;
+  GValue *dest = reset_register(frame, instruction->dest);
+
+  if (grex_expression_context_find_computed(frame->context, instruction->name,
+                                            track_dependencies, dest, error)) {
+    if (!G_IS_VALUE(dest)) {
+      return FALSE;
+    }
+  } else if (!grex_expression_context_find_name(frame->context,
+                                                instruction->name, dest,
+                                                &originating_object)) {
+    grex_set_expression_evaluation_error(
+        error, instruction->expression,
+        GREX_EXPRESSION_EVALUATION_ERROR_UNDEFINED_NAME, "Undefined name '%s'",
+        instruction->name);
+    return FALSE;
+  }
+
+  if (track_dependencies) {
+    // Inserting an extra name with the same name would shadow the scope, so
+    // the name itself is a dependency as well.
+    grex_expression_context_track_name(frame->context, instruction->name);
+
+    if (originating_object != NULL) {
+      grex_expression_context_track_dependency(
+          frame->context, originating_object, instruction->name, dest);
+    }
+  }
+
+  set_push_source(frame, instruction, originating_object);
+  return TRUE;
+}
+
+// Returns the index of the next instruction to run.
+static guint
+run_begin_path(Frame *frame, const GrexExpressionInstruction *instruction,
+               guint pc) {
+  if (!(frame->flags & GREX_EXPRESSION_EVALUATION_TRACK_DEPENDENCIES)) {
+    return pc + 1;
+  }
+
+  GObject *key = G_OBJECT(instruction->expression);
+  GObject *object = grex_expression_context_lookup_path(frame->context, key);
+  if (object == NULL) {
+    grex_expression_context_begin_path(frame->context, key);
+    return pc + 1;
+  }
+
+  GValue *dest = reset_register(frame, instruction->dest);
+  g_value_init(dest, G_OBJECT_TYPE(object));
+  g_value_take_object(dest, object);
+  return instruction->jump;
+}
+
+static gboolean
+run_check_object(Frame *frame, const GrexExpressionInstruction *instruction,
+                 GError **error) {
+  const GValue *value = &frame->registers[instruction->src];
+  GType type = G_VALUE_TYPE(value);
+  if (!g_type_is_a(type, G_TYPE_OBJECT)) {
+    grex_set_expression_evaluation_error(
+        error, instruction->expression,
+        GREX_EXPRESSION_EVALUATION_ERROR_INVALID_TYPE,
+        "Cannot get property on type '%s'", g_type_name(type));
+    return FALSE;
+  } else if (g_value_get_object(value) == NULL) {
+    grex_set_expression_evaluation_error(
+        error, instruction->expression,
+        GREX_EXPRESSION_EVALUATION_ERROR_INVALID_TYPE,
+        "Cannot get property on a null object");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+run_end_path(Frame *frame, const GrexExpressionInstruction *instruction) {
+  if (frame->flags & GREX_EXPRESSION_EVALUATION_TRACK_DEPENDENCIES) {
+    grex_expression_context_end_path(
+        frame->context, G_OBJECT(instruction->expression),
+        g_value_get_object(&frame->registers[instruction->src]));
+  }
+}
+
+static gboolean
+run_get_property(Frame *frame, const GrexExpressionInstruction *instruction,
+                 GError **error) {
+  GObject *object = g_value_get_object(&frame->registers[instruction->src]);
+
+  GParamSpec *pspec = g_object_class_find_property(G_OBJECT_GET_CLASS(object),
+                                                   instruction->name);
+  if (pspec == NULL) {
+    grex_set_expression_evaluation_error(
+        error, instruction->expression,
+        GREX_EXPRESSION_EVALUATION_ERROR_UNDEFINED_PROPERTY,
+        "Undefined property '%s'", instruction->name);
+    return FALSE;
+  }
+
+  GValue *dest = reset_register(frame, instruction->dest);
+  g_value_init(dest, pspec->value_type);
+  g_object_get_property(object, instruction->name, dest);
+
+  if (frame->flags & GREX_EXPRESSION_EVALUATION_TRACK_DEPENDENCIES) {
+    grex_expression_context_track_dependency(frame->context, object,
+                                             instruction->name, dest);
+  }
+
+  set_push_source(frame, instruction, object);
+  return TRUE;
+}
+
+// Converts the value in the register to the given type in place.
+static gboolean
+convert_register(GValue *value, GType type, GError **error) {
+  g_auto(GValue) converted = G_VALUE_INIT;
+
+  if (g_value_type_transformable(G_VALUE_TYPE(value), type)) {
+    g_value_init(&converted, type);
+    g_value_transform(value, &converted);
+  } else {
+    // Anything else (like parsing strings) needs to go through the value
+    // parser.
+    g_autoptr(GrexValueHolder) source = grex_value_holder_new(value);
+    g_autoptr(GrexValueHolder) result = grex_value_parser_try_transform(
+        grex_value_parser_default(), source, type, error);
+    if (result == NULL) {
+      return FALSE;
+    }
+
+    const GValue *result_value = grex_value_holder_get_value(result);
+    g_value_init(&converted, G_VALUE_TYPE(result_value));
+    g_value_copy(result_value, &converted);
+  }
+
+  g_value_unset(value);
+  *value = converted;
+  converted = (GValue)G_VALUE_INIT;
+  return TRUE;
+}
+
+static gboolean
+run_emit_signal(Frame *frame, const GrexExpressionInstruction *instruction,
+                GError **error) {
+  // The target is followed by the arguments, which is exactly what
+  // g_signal_emitv() needs.
+  GValue *values = &frame->registers[instruction->src];
+
+  GType type = G_VALUE_TYPE(&values[0]);
+  if (!g_type_is_a(type, G_TYPE_OBJECT)) {
+    grex_set_expression_evaluation_error(
+        error, instruction->object,
+        GREX_EXPRESSION_EVALUATION_ERROR_INVALID_TYPE,
+        "Cannot emit signal on type '%s'", g_type_name(type));
+    return FALSE;
+  }
+
+  GObject *target_object = g_value_get_object(&values[0]);
+  guint signal_id =
+      g_signal_lookup(instruction->name, G_OBJECT_TYPE(target_object));
+  if (signal_id == 0) {
+    grex_set_expression_evaluation_error(
+        error, instruction->expression,
+        GREX_EXPRESSION_EVALUATION_ERROR_UNDEFINED_SIGNAL,
+        "Undefined signal '%s'", instruction->name);
+    return FALSE;
+  }
+
+  GSignalQuery query = {0};
+  g_signal_query(signal_id, &query);
+  g_warn_if_fail(query.signal_id != 0);
+
+  if (instruction->detail != 0 && !(query.signal_flags & G_SIGNAL_DETAILED)) {
+    grex_set_expression_evaluation_error(
+        error, instruction->expression,
+        GREX_EXPRESSION_EVALUATION_ERROR_INVALID_DETAIL,
+        "Signal '%s' does not take any detail", instruction->name);
+    return FALSE;
+  } else if (instruction->detail == 0 &&
+             query.signal_flags & G_SIGNAL_DETAILED) {
+    grex_set_expression_evaluation_error(
+        error, instruction->expression,
+        GREX_EXPRESSION_EVALUATION_ERROR_INVALID_DETAIL,
+        "Signal '%s' needs a detail value", instruction->name);
+    return FALSE;
+  }
+
+  if (instruction->n_args != query.n_params) {
+    grex_set_expression_evaluation_error(
+        error, instruction->expression,
+        GREX_EXPRESSION_EVALUATION_ERROR_INVALID_ARGUMENT_COUNT,
+        "Invalid number of arguments to '%s': expected %u, got %u",
+        instruction->name, query.n_params, instruction->n_args);
+    return FALSE;
+  }
+
+  for (guint i = 0; i < instruction->n_args; i++) {
+    GValue *arg = &values[i + 1];
+    if (G_VALUE_TYPE(arg) == query.param_types[i]) {
+      continue;
+    }
+
+    g_autoptr(GError) transform_error = NULL;
+    if (!convert_register(arg, query.param_types[i], &transform_error)) {
+      GPtrArray *arg_exprs =
+          grex_signal_expression_get_args(instruction->expression);
+      grex_set_expression_evaluation_error(
+          error, g_ptr_array_index(arg_exprs, i),
+          GREX_EXPRESSION_EVALUATION_ERROR_INVALID_TYPE,
+          "Failed to convert type for '%s' argument %u: %s", instruction->name,
+          i + 1, transform_error->message);
+      return FALSE;
+    }
+  }
+
+  GValue *dest = reset_register(frame, instruction->dest);
+
+  if (query.return_type != G_TYPE_NONE) {
+    g_value_init(dest, query.return_type);
+    g_signal_emitv(values, query.signal_id, instruction->detail, dest);
+  } else {
+    g_signal_emitv(values, query.signal_id, instruction->detail, NULL);
+
+    // XXX: Not sure how to return null values other than this.
+    g_value_init(dest, G_TYPE_OBJECT);
+    g_value_set_object(dest, NULL);
+  }
+
+  return TRUE;
+}
+
+// Finishes any paths that were still being resolved when the instruction at pc
+// failed, so the context doesn't expect them to end later.
+static void
+abort_paths(Frame *frame, GrexExpressionProgram *program, guint pc) {
+  if (!(frame->flags & GREX_EXPRESSION_EVALUATION_TRACK_DEPENDENCIES)) {
+    return;
+  }
+
+  // A path that's still open started before pc and ends after it (paths that
+  // were cached jumped over their instructions entirely).
+  for (guint i = pc; i-- > 0;) {
+    const GrexExpressionInstruction *instruction = &program->instructions[i];
+    if (instruction->op == GREX_EXPRESSION_OP_BEGIN_PATH &&
+        instruction->jump > pc) {
+      grex_expression_context_end_path(
+          frame->context, G_OBJECT(instruction->expression), NULL);
+    }
+  }
+}
+
+static gboolean
+run_program(Frame *frame, GrexExpressionProgram *program, GError **error) {
+  guint pc = 0;
+  while (pc < program->n_instructions) {
+    const GrexExpressionInstruction *instruction = &program->instructions[pc];
+    gboolean success = TRUE;
+
+    switch (instruction->op) {
+    case GREX_EXPRESSION_OP_CONSTANT:
+      run_constant(frame, instruction);
+      break;
+    case GREX_EXPRESSION_OP_SCOPE:
+      run_scope(frame, instruction);
+      break;
+    case GREX_EXPRESSION_OP_LOOKUP_NAME:
+      success = run_lookup_name(frame, instruction, error);
+      break;
+    case GREX_EXPRESSION_OP_BEGIN_PATH:
+      pc = run_begin_path(frame, instruction, pc);
+      continue;
+    case GREX_EXPRESSION_OP_CHECK_OBJECT:
+      success = run_check_object(frame, instruction, error);
+      break;
+    case GREX_EXPRESSION_OP_END_PATH:
+      run_end_path(frame, instruction);
+      break;
+    case GREX_EXPRESSION_OP_GET_PROPERTY:
+      success = run_get_property(frame, instruction, error);
+      break;
+    case GREX_EXPRESSION_OP_EMIT_SIGNAL:
+      success = run_emit_signal(frame, instruction, error);
+      break;
+    }
+
+    if (!success) {
+      abort_paths(frame, program, pc);
+      return FALSE;
+    }
+
+    pc++;
+  }
+
+  return TRUE;
+}
+
+// Runs the program, keeping every intermediate value in a register and only
+// creating a value holder for the result.
+GrexValueHolder *
+grex_expression_program_run(GrexExpressionProgram *program,
+                            GrexExpressionContext *context,
+                            GrexExpressionEvaluationFlags flags,
+                            GError **error) {
+  // A lone constant can be returned as-is.
+  if (program->n_instructions == 1 &&
+      program->instructions[0].op == GREX_EXPRESSION_OP_CONSTANT) {
+    return grex_value_holder_ref(program->instructions[0].constant);
+  }
+
+  GValue stack_registers[STACK_REGISTERS];
+  Frame frame = {
+      .context = context,
+      .flags = flags,
+      .registers = program->n_registers <= STACK_REGISTERS
+                       ? stack_registers
+                       : g_new(GValue, program->n_registers),
+  };
+  memset(frame.registers, 0, sizeof(GValue) * program->n_registers);
+
+  GrexValueHolder *result = NULL;
+  if (run_program(&frame, program, error)) {
+    if (frame.push_object != NULL) {
+      PushValueData *data = g_new0(PushValueData, 1);
+      data->object = g_steal_pointer(&frame.push_object);
+      data->property = g_strdup(frame.push_property);
+      result = grex_value_holder_new_with_push_handler(
+          &frame.registers[0], on_push_value, data, push_value_data_free);
+    } else {
+      result = grex_value_holder_new(&frame.registers[0]);
+    }
+  }
+
+  g_clear_object(&frame.push_object);
+  for (guint i = 0; i < program->n_registers; i++) {
+    if (G_IS_VALUE(&frame.registers[i])) {
+      g_value_unset(&frame.registers[i]);
+    }
+  }
+
+  if (frame.registers != stack_registers) {
+    g_free(frame.registers);
+  }
+
+  return result;
+}
@@ -13,6 +13,9 @@
 typedef struct {
   GrexSourceLocation *location;
   gboolean is_constant;
+
+  // Compiled the first time the expression is evaluated.
+  GrexExpressionProgram *program;
 } GrexExpressionPrivate;
 
 enum {
@@ -36,6 +39,7 @@ grex_expression_dispose(GObject *object) {
   GrexExpressionPrivate *priv =
       grex_expression_get_instance_private(expression);
   g_clear_object(&priv->location);
+  g_clear_pointer(&priv->program, grex_expression_program_free);
 }
 
 static void
@@ -129,9 +133,22 @@ GrexValueHolder *
 grex_expression_evaluate(GrexExpression *expression,
                          GrexExpressionContext *context,
                          GrexExpressionEvaluationFlags flags, GError **error) {
+  GrexExpressionPrivate *priv =
+      grex_expression_get_instance_private(expression);
+  if (priv->program == NULL) {
+    priv->program = grex_expression_program_new(expression);
+  }
+
+  return grex_expression_program_run(priv->program, context, flags, error);
+}
+
+// Emits the instructions evaluating the expression into the dest register.
+void
+grex_expression_compile(GrexExpression *expression,
+                        GrexExpressionCompiler *compiler, guint dest) {
   GrexExpressionClass *expression_class = GREX_EXPRESSION_GET_CLASS(expression);
-  g_return_val_if_fail(expression_class->evaluate != NULL, NULL);
-  return expression_class->evaluate(expression, context, flags, error);
+  g_return_if_fail(expression_class->compile != NULL);
+  expression_class->compile(expression, compiler, dest);
 }
 
 void
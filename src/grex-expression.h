@@ -21,6 +21,7 @@ typedef enum {
   GREX_EXPRESSION_EVALUATION_ERROR_INVALID_TYPE,
   GREX_EXPRESSION_EVALUATION_ERROR_INVALID_ARGUMENT_COUNT,
   GREX_EXPRESSION_EVALUATION_ERROR_INVALID_DETAIL,
+  GREX_EXPRESSION_EVALUATION_ERROR_RECURSIVE_NAME,
 } GrexExpressionEvaluationError;
 
 #define GREX_EXPRESSION_EVALUATION_ERROR \
@@ -0,0 +1,877 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "grex-fragment.h"
+
+#include "grex-binding-private.h"
+#include "grex-expression-private.h"
+#include "grex-fragment-private.h"
+
+// A binary fragment is a header followed by several sections, each an array of
+// records made of little-endian 32-bit words. Strings are stored once in a
+// table of NUL-terminated strings and referenced by their offsets, fragments
+// are stored in pre-order, and expressions are stored after their operands, so
+// the whole tree can be loaded in a single forward pass without copying any of
+// the data first.
+
+#define BINARY_MAGIC "GREXFRG"
+#define BINARY_MAGIC_SIZE 8
+#define BINARY_VERSION 1
+
+// An absent string or expression.
+#define NO_REF G_MAXUINT32
+
+typedef enum {
+  // The count is the size in bytes.
+  SECTION_STRINGS,
+  SECTION_FRAGMENTS,
+  SECTION_BINDINGS,
+  SECTION_SEGMENTS,
+  SECTION_EXPRESSIONS,
+  // Expression references, used for signal arguments.
+  SECTION_ARGUMENTS,
+  N_SECTIONS,
+} SectionId;
+
+typedef struct {
+  guint32 offset;
+  guint32 count;
+} Section;
+
+typedef struct {
+  guint32 version;
+  Section sections[N_SECTIONS];
+} Header;
+
+#define HEADER_SIZE (BINARY_MAGIC_SIZE + sizeof(Header))
+
+#define FRAGMENT_STATIC (1 << 0)
+
+typedef struct {
+  guint32 type_name;
+  guint32 file;
+  guint32 line;
+  guint32 column;
+  guint32 flags;
+  guint32 n_children;
+  guint32 first_binding;
+  guint32 n_bindings;
+} FragmentRecord;
+
+typedef struct {
+  guint32 target;
+  guint32 file;
+  guint32 line;
+  guint32 column;
+  guint32 first_segment;
+  guint32 n_segments;
+} BindingRecord;
+
+typedef enum {
+  SEGMENT_CONSTANT,
+  SEGMENT_EXPRESSION,
+  SEGMENT_BIDIRECTIONAL_EXPRESSION,
+} SegmentKind;
+
+typedef struct {
+  guint32 kind;
+  // The string for constants, otherwise the expression.
+  guint32 value;
+} SegmentRecord;
+
+typedef enum {
+  // The low and high 32 bits of the value.
+  EXPRESSION_INT64,
+  // The value.
+  EXPRESSION_BOOLEAN,
+  // The string.
+  EXPRESSION_STRING,
+  // The object expression (or NO_REF), then the property name.
+  EXPRESSION_PROPERTY,
+  // The object expression (or NO_REF), the signal, the detail (or NO_REF), then
+  // the first argument and the number of arguments.
+  EXPRESSION_SIGNAL,
+} ExpressionKind;
+
+typedef struct {
+  guint32 kind;
+  guint32 file;
+  guint32 line;
+  guint32 column;
+  guint32 operands[5];
+} ExpressionRecord;
+
+static const gsize record_sizes[N_SECTIONS] = {
+    [SECTION_STRINGS] = 1,
+    [SECTION_FRAGMENTS] = sizeof(FragmentRecord),
+    [SECTION_BINDINGS] = sizeof(BindingRecord),
+    [SECTION_SEGMENTS] = sizeof(SegmentRecord),
+    [SECTION_EXPRESSIONS] = sizeof(ExpressionRecord),
+    [SECTION_ARGUMENTS] = sizeof(guint32),
+};
+
+G_DEFINE_QUARK("grex-fragment-binary-error-quark", grex_fragment_binary_error)
+
+typedef struct {
+  GHashTable *string_offsets;
+  GString *strings;
+
+  GArray *sections[N_SECTIONS];
+} Writer;
+
+static void
+writer_clear(Writer *writer) {
+  g_clear_pointer(&writer->string_offsets, g_hash_table_unref);
+  if (writer->strings != NULL) {
+    g_string_free(g_steal_pointer(&writer->strings), TRUE);
+  }
+
+  for (int i = 0; i < N_SECTIONS; i++) {
+    g_clear_pointer(&writer->sections[i], g_array_unref);
+  }
+}
+
+G_DEFINE_AUTO_CLEANUP_CLEAR_FUNC(Writer, writer_clear)
+
+static void
+writer_init(Writer *writer) {
+  writer->string_offsets =
+      g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  writer->strings = g_string_new("");
+
+  for (int i = SECTION_FRAGMENTS; i < N_SECTIONS; i++) {
+    writer->sections[i] = g_array_new(FALSE, TRUE, record_sizes[i]);
+  }
+}
+
+static guint32
+writer_add_string(Writer *writer, const char *string) {
+  if (string == NULL) {
+    return NO_REF;
+  }
+
+  gpointer offset = NULL;
+  if (g_hash_table_lookup_extended(writer->string_offsets, string, NULL,
+                                   &offset)) {
+    return GPOINTER_TO_UINT(offset);
+  }
+
+  guint32 new_offset = writer->strings->len;
+  g_string_append_len(writer->strings, string, strlen(string) + 1);
+  g_hash_table_insert(writer->string_offsets, g_strdup(string),
+                      GUINT_TO_POINTER(new_offset));
+  return new_offset;
+}
+
+// Appends the record to the section, returning its index.
+static guint32
+writer_add_record(Writer *writer, SectionId section, gconstpointer record) {
+  GArray *records = writer->sections[section];
+  g_array_append_vals(records, record, 1);
+  return records->len - 1;
+}
+
+static void
+writer_set_location(Writer *writer, GrexSourceLocation *location,
+                    guint32 *file, guint32 *line, guint32 *column) {
+  if (location == NULL) {
+    *file = NO_REF;
+    *line = *column = 0;
+    return;
+  }
+
+  *file = writer_add_string(writer, grex_source_location_get_file(location));
+  *line = grex_source_location_get_line(location);
+  *column = grex_source_location_get_column(location);
+}
+
+static guint32 writer_add_expression(Writer *writer,
+                                     GrexExpression *expression,
+                                     GError **error);
+
+static gboolean
+writer_set_constant_value(Writer *writer, ExpressionRecord *record,
+                          GrexExpression *expression, GError **error) {
+  g_autoptr(GrexValueHolder) holder = NULL;
+  g_object_get(expression, "value", &holder, NULL);
+
+  const GValue *value = grex_value_holder_get_value(holder);
+  switch (G_VALUE_TYPE(value)) {
+  case G_TYPE_INT64: {
+    guint64 int_value = g_value_get_int64(value);
+    record->kind = EXPRESSION_INT64;
+    record->operands[0] = int_value & G_MAXUINT32;
+    record->operands[1] = int_value >> 32;
+    return TRUE;
+  }
+  case G_TYPE_BOOLEAN:
+    record->kind = EXPRESSION_BOOLEAN;
+    record->operands[0] = g_value_get_boolean(value);
+    return TRUE;
+  case G_TYPE_STRING:
+    if (g_value_get_string(value) == NULL) {
+      break;
+    }
+
+    record->kind = EXPRESSION_STRING;
+    record->operands[0] =
+        writer_add_string(writer, g_value_get_string(value));
+    return TRUE;
+  default:
+    break;
+  }
+
+  grex_set_located_error(
+      error, grex_expression_get_location(expression),
+      GREX_FRAGMENT_BINARY_ERROR,
+      GREX_FRAGMENT_BINARY_ERROR_UNSUPPORTED_EXPRESSION,
+      "Constant values of type '%s' cannot be stored",
+      g_type_name(G_VALUE_TYPE(value)));
+  return FALSE;
+}
+
+// Adds the expression's operands before the expression itself, returning its
+// index or NO_REF on error.
+static guint32
+writer_add_expression(Writer *writer, GrexExpression *expression,
+                      GError **error) {
+  ExpressionRecord record = {0};
+  writer_set_location(writer, grex_expression_get_location(expression),
+                      &record.file, &record.line, &record.column);
+
+  if (G_TYPE_CHECK_INSTANCE_TYPE(expression,
+                                 grex_constant_value_expression_get_type())) {
+    if (!writer_set_constant_value(writer, &record, expression, error)) {
+      return NO_REF;
+    }
+  } else if (G_TYPE_CHECK_INSTANCE_TYPE(expression,
+                                        grex_property_expression_get_type())) {
+    g_autoptr(GrexExpression) object = NULL;
+    g_autofree char *name = NULL;
+    g_object_get(expression, "object", &object, "name", &name, NULL);
+
+    record.kind = EXPRESSION_PROPERTY;
+    record.operands[0] = NO_REF;
+    if (object != NULL && (record.operands[0] = writer_add_expression(
+                               writer, object, error)) == NO_REF) {
+      return NO_REF;
+    }
+
+    record.operands[1] = writer_add_string(writer, name);
+  } else if (G_TYPE_CHECK_INSTANCE_TYPE(expression,
+                                        grex_signal_expression_get_type())) {
+    g_autoptr(GrexExpression) object = NULL;
+    g_autofree char *signal = NULL;
+    g_autofree char *detail = NULL;
+    g_object_get(expression, "object", &object, "signal", &signal, "detail",
+                 &detail, NULL);
+
+    record.kind = EXPRESSION_SIGNAL;
+    record.operands[0] = NO_REF;
+    if (object != NULL && (record.operands[0] = writer_add_expression(
+                               writer, object, error)) == NO_REF) {
+      return NO_REF;
+    }
+
+    record.operands[1] = writer_add_string(writer, signal);
+    record.operands[2] = writer_add_string(writer, detail);
+
+    // The arguments' own arguments are added along the way, so only add these
+    // once they're all done.
+    GPtrArray *args = grex_signal_expression_get_args(expression);
+    g_autoptr(GArray) arg_indexes =
+        g_array_sized_new(FALSE, FALSE, sizeof(guint32), args->len);
+    for (guint i = 0; i < args->len; i++) {
+      guint32 index =
+          writer_add_expression(writer, g_ptr_array_index(args, i), error);
+      if (index == NO_REF) {
+        return NO_REF;
+      }
+
+      g_array_append_val(arg_indexes, index);
+    }
+
+    record.operands[3] = writer->sections[SECTION_ARGUMENTS]->len;
+    record.operands[4] = arg_indexes->len;
+    g_array_append_vals(writer->sections[SECTION_ARGUMENTS], arg_indexes->data,
+                        arg_indexes->len);
+  } else {
+    grex_set_located_error(error, grex_expression_get_location(expression),
+                           GREX_FRAGMENT_BINARY_ERROR,
+                           GREX_FRAGMENT_BINARY_ERROR_UNSUPPORTED_EXPRESSION,
+                           "Expressions of type '%s' cannot be stored",
+                           G_OBJECT_TYPE_NAME(expression));
+    return NO_REF;
+  }
+
+  return writer_add_record(writer, SECTION_EXPRESSIONS, &record);
+}
+
+static gboolean
+writer_add_binding(Writer *writer, const char *target, GrexBinding *binding,
+                   GError **error) {
+  BindingRecord record = {0};
+  record.target = writer_add_string(writer, target);
+  writer_set_location(writer, grex_binding_get_location(binding), &record.file,
+                      &record.line, &record.column);
+
+  // Expressions don't add any segments, so these stay contiguous.
+  record.first_segment = writer->sections[SECTION_SEGMENTS]->len;
+  record.n_segments = grex_binding_get_n_segments(binding);
+  for (guint i = 0; i < record.n_segments; i++) {
+    GrexExpression *expression = NULL;
+    gboolean is_bidirectional = FALSE;
+    const char *constant = grex_binding_get_segment(binding, i, &expression,
+                                                    &is_bidirectional);
+
+    SegmentRecord segment = {0};
+    if (constant != NULL) {
+      segment.kind = SEGMENT_CONSTANT;
+      segment.value = writer_add_string(writer, constant);
+    } else {
+      segment.kind = is_bidirectional ? SEGMENT_BIDIRECTIONAL_EXPRESSION
+                                      : SEGMENT_EXPRESSION;
+      segment.value = writer_add_expression(writer, expression, error);
+      if (segment.value == NO_REF) {
+        return FALSE;
+      }
+    }
+
+    writer_add_record(writer, SECTION_SEGMENTS, &segment);
+  }
+
+  writer_add_record(writer, SECTION_BINDINGS, &record);
+  return TRUE;
+}
+
+static gboolean
+writer_add_fragment(Writer *writer, GrexFragment *fragment, GError **error) {
+  FragmentRecord record = {0};
+  record.type_name = writer_add_string(
+      writer, g_type_name(grex_fragment_get_target_type(fragment)));
+  writer_set_location(writer, grex_fragment_get_location(fragment),
+                      &record.file, &record.line, &record.column);
+  if (grex_fragment_is_static(fragment)) {
+    record.flags |= FRAGMENT_STATIC;
+  }
+
+  guint32 index = writer_add_record(writer, SECTION_FRAGMENTS, &record);
+
+  // Written in the order they're applied in, which reading them back restores.
+  g_autoptr(GList) targets = grex_fragment_get_binding_targets(fragment);
+  guint32 first_binding = writer->sections[SECTION_BINDINGS]->len;
+  for (GList *target = targets; target != NULL; target = target->next) {
+    if (!writer_add_binding(writer, target->data,
+                            grex_fragment_get_binding(fragment, target->data),
+                            error)) {
+      return FALSE;
+    }
+  }
+
+  g_autoptr(GList) children = grex_fragment_get_children(fragment);
+  for (GList *child = children; child != NULL; child = child->next) {
+    if (!writer_add_fragment(writer, child->data, error)) {
+      return FALSE;
+    }
+  }
+
+  FragmentRecord *stored = &g_array_index(writer->sections[SECTION_FRAGMENTS],
+                                          FragmentRecord, index);
+  stored->n_children = g_list_length(children);
+  stored->first_binding = first_binding;
+  stored->n_bindings = g_list_length(targets);
+  return TRUE;
+}
+
+static void
+append_words(GByteArray *data, const guint32 *words, gsize n_words) {
+  for (gsize i = 0; i < n_words; i++) {
+    guint32 word = GUINT32_TO_LE(words[i]);
+    g_byte_array_append(data, (const guint8 *)&word, sizeof(word));
+  }
+}
+
+static GBytes *
+writer_finish(Writer *writer) {
+  // Keep every record section aligned.
+  while (writer->strings->len % sizeof(guint32) != 0) {
+    g_string_append_c(writer->strings, '\0');
+  }
+
+  Header header = {.version = BINARY_VERSION};
+  guint32 offset = HEADER_SIZE;
+
+  header.sections[SECTION_STRINGS].offset = offset;
+  header.sections[SECTION_STRINGS].count = writer->strings->len;
+  offset += writer->strings->len;
+
+  for (int i = SECTION_FRAGMENTS; i < N_SECTIONS; i++) {
+    header.sections[i].offset = offset;
+    header.sections[i].count = writer->sections[i]->len;
+    offset += writer->sections[i]->len * record_sizes[i];
+  }
+
+  GByteArray *data = g_byte_array_sized_new(offset);
+  g_byte_array_append(data, (const guint8 *)BINARY_MAGIC, BINARY_MAGIC_SIZE);
+  append_words(data, (const guint32 *)&header,
+               sizeof(header) / sizeof(guint32));
+  g_byte_array_append(data, (const guint8 *)writer->strings->str,
+                      writer->strings->len);
+
+  for (int i = SECTION_FRAGMENTS; i < N_SECTIONS; i++) {
+    GArray *records = writer->sections[i];
+    append_words(data, (const guint32 *)records->data,
+                 records->len * record_sizes[i] / sizeof(guint32));
+  }
+
+  return g_byte_array_free_to_bytes(data);
+}
+
+/**
+ * grex_fragment_write_binary:
+ * @error: Return location for a #GError.
+ *
+ * Serializes this fragment's tree into Grex's binary format, which can be
+ * loaded again via grex_fragment_parse_binary() without having to parse any
+ * XML or expressions. Only expressions created by the expression parser can be
+ * stored.
+ *
+ * Returns: (transfer full): The binary data, or %NULL on error.
+ */
+GBytes *
+grex_fragment_write_binary(GrexFragment *fragment, GError **error) {
+  g_auto(Writer) writer = {NULL};
+  writer_init(&writer);
+
+  if (!writer_add_fragment(&writer, fragment, error)) {
+    return NULL;
+  }
+
+  return writer_finish(&writer);
+}
+
+typedef struct {
+  const guint8 *data;
+  gsize size;
+  Section sections[N_SECTIONS];
+
+  GtkBuilderScope *scope;
+  // Only created if a type isn't registered yet.
+  GtkBuilder *builder;
+
+  GPtrArray *expressions;
+} Reader;
+
+static void
+reader_clear(Reader *reader) {
+  g_clear_object(&reader->builder);
+  g_clear_pointer(&reader->expressions, g_ptr_array_unref);
+}
+
+G_DEFINE_AUTO_CLEANUP_CLEAR_FUNC(Reader, reader_clear)
+
+static void
+set_invalid_error(GError **error, const char *message) {
+  g_set_error(error, GREX_FRAGMENT_BINARY_ERROR,
+              GREX_FRAGMENT_BINARY_ERROR_INVALID, "Invalid binary fragment: %s",
+              message);
+}
+
+static void
+read_words(const guint8 *data, guint32 *words, gsize n_words) {
+  memcpy(words, data, n_words * sizeof(guint32));
+  for (gsize i = 0; i < n_words; i++) {
+    words[i] = GUINT32_FROM_LE(words[i]);
+  }
+}
+
+static gboolean
+reader_read_header(Reader *reader, GError **error) {
+  if (!grex_fragment_is_binary(reader->data, reader->size)) {
+    set_invalid_error(error, "missing header");
+    return FALSE;
+  }
+
+  Header header;
+  read_words(reader->data + BINARY_MAGIC_SIZE, (guint32 *)&header,
+             sizeof(header) / sizeof(guint32));
+  if (header.version != BINARY_VERSION) {
+    g_set_error(error, GREX_FRAGMENT_BINARY_ERROR,
+                GREX_FRAGMENT_BINARY_ERROR_UNSUPPORTED_VERSION,
+                "Unsupported binary fragment version %u (expected %u)",
+                header.version, BINARY_VERSION);
+    return FALSE;
+  }
+
+  for (int i = 0; i < N_SECTIONS; i++) {
+    Section *section = &header.sections[i];
+    if (section->offset > reader->size ||
+        section->count > (reader->size - section->offset) / record_sizes[i]) {
+      set_invalid_error(error, "section out of bounds");
+      return FALSE;
+    }
+
+    reader->sections[i] = *section;
+  }
+
+  // Make sure every string is terminated.
+  Section *strings = &reader->sections[SECTION_STRINGS];
+  if (strings->count > 0 &&
+      reader->data[strings->offset + strings->count - 1] != '\0') {
+    set_invalid_error(error, "unterminated string table");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+reader_read_record(Reader *reader, SectionId section, guint32 index,
+                   gpointer record, GError **error) {
+  if (index >= reader->sections[section].count) {
+    set_invalid_error(error, "record out of bounds");
+    return FALSE;
+  }
+
+  gsize size = record_sizes[section];
+  read_words(reader->data + reader->sections[section].offset + index * size,
+             record, size / sizeof(guint32));
+  return TRUE;
+}
+
+// Points right into the data, which already contains the terminator.
+static gboolean
+reader_get_string(Reader *reader, guint32 ref, gboolean nullable,
+                  const char **string, GError **error) {
+  if (ref == NO_REF && nullable) {
+    *string = NULL;
+    return TRUE;
+  } else if (ref >= reader->sections[SECTION_STRINGS].count) {
+    set_invalid_error(error, "string out of bounds");
+    return FALSE;
+  }
+
+  *string = (const char *)reader->data +
+            reader->sections[SECTION_STRINGS].offset + ref;
+  return TRUE;
+}
+
+static GrexSourceLocation *
+reader_get_location(Reader *reader, guint32 file_ref, guint32 line,
+                    guint32 column, GError **error) {
+  const char *file = NULL;
+  if (!reader_get_string(reader, file_ref, TRUE, &file, error)) {
+    return NULL;
+  }
+
+  return grex_source_location_new(file, line, column);
+}
+
+// Expressions may only refer to the ones before them, so there are no cycles.
+static gboolean
+reader_get_expression(Reader *reader, guint32 ref, gboolean nullable,
+                      GrexExpression **expression, GError **error) {
+  if (ref == NO_REF && nullable) {
+    *expression = NULL;
+    return TRUE;
+  } else if (ref >= reader->expressions->len) {
+    set_invalid_error(error, "expression out of order");
+    return FALSE;
+  }
+
+  *expression = g_ptr_array_index(reader->expressions, ref);
+  return TRUE;
+}
+
+static GrexExpression *
+reader_read_expression(Reader *reader, guint32 index, GError **error) {
+  ExpressionRecord record;
+  if (!reader_read_record(reader, SECTION_EXPRESSIONS, index, &record,
+                          error)) {
+    return NULL;
+  }
+
+  g_autoptr(GrexSourceLocation) location = reader_get_location(
+      reader, record.file, record.line, record.column, error);
+  if (location == NULL) {
+    return NULL;
+  }
+
+  g_auto(GValue) value = G_VALUE_INIT;
+  GrexExpression *object = NULL;
+  const char *name = NULL, *detail = NULL;
+
+  switch (record.kind) {
+  case EXPRESSION_INT64:
+    g_value_init(&value, G_TYPE_INT64);
+    g_value_set_int64(&value, ((guint64)record.operands[1] << 32) |
+                                  record.operands[0]);
+    return grex_constant_value_expression_new(location, &value);
+  case EXPRESSION_BOOLEAN:
+    g_value_init(&value, G_TYPE_BOOLEAN);
+    g_value_set_boolean(&value, record.operands[0]);
+    return grex_constant_value_expression_new(location, &value);
+  case EXPRESSION_STRING:
+    if (!reader_get_string(reader, record.operands[0], FALSE, &name, error)) {
+      return NULL;
+    }
+
+    g_value_init(&value, G_TYPE_STRING);
+    g_value_set_static_string(&value, name);
+    return grex_constant_value_expression_new(location, &value);
+  case EXPRESSION_PROPERTY:
+    if (!reader_get_expression(reader, record.operands[0], TRUE, &object,
+                               error) ||
+        !reader_get_string(reader, record.operands[1], FALSE, &name, error)) {
+      return NULL;
+    }
+
+    return grex_property_expression_new(location, object, name);
+  case EXPRESSION_SIGNAL: {
+    if (!reader_get_expression(reader, record.operands[0], TRUE, &object,
+                               error) ||
+        !reader_get_string(reader, record.operands[1], FALSE, &name, error) ||
+        !reader_get_string(reader, record.operands[2], TRUE, &detail,
+                           error)) {
+      return NULL;
+    }
+
+    guint32 first_arg = record.operands[3], n_args = record.operands[4];
+    if (first_arg > reader->sections[SECTION_ARGUMENTS].count ||
+        n_args > reader->sections[SECTION_ARGUMENTS].count - first_arg) {
+      set_invalid_error(error, "arguments out of bounds");
+      return NULL;
+    }
+
+    g_autofree GrexExpression **args = g_new0(GrexExpression *, n_args);
+    for (guint32 i = 0; i < n_args; i++) {
+      guint32 arg_ref;
+      if (!reader_read_record(reader, SECTION_ARGUMENTS, first_arg + i,
+                              &arg_ref, error) ||
+          !reader_get_expression(reader, arg_ref, FALSE, &args[i], error)) {
+        return NULL;
+      }
+    }
+
+    return grex_signal_expression_new(location, object, name, detail, args,
+                                      n_args);
+  }
+  default:
+    set_invalid_error(error, "unknown expression kind");
+    return NULL;
+  }
+}
+
+static GrexBinding *
+reader_read_binding(Reader *reader, guint32 index, const char **target,
+                    GError **error) {
+  BindingRecord record;
+  if (!reader_read_record(reader, SECTION_BINDINGS, index, &record, error) ||
+      !reader_get_string(reader, record.target, FALSE, target, error)) {
+    return NULL;
+  }
+
+  g_autoptr(GrexSourceLocation) location = reader_get_location(
+      reader, record.file, record.line, record.column, error);
+  if (location == NULL) {
+    return NULL;
+  }
+
+  g_autoptr(GrexBindingBuilder) builder = grex_binding_builder_new();
+  for (guint32 i = 0; i < record.n_segments; i++) {
+    SegmentRecord segment;
+    if (!reader_read_record(reader, SECTION_SEGMENTS, record.first_segment + i,
+                            &segment, error)) {
+      return NULL;
+    }
+
+    if (segment.kind == SEGMENT_CONSTANT) {
+      const char *constant = NULL;
+      if (!reader_get_string(reader, segment.value, FALSE, &constant, error)) {
+        return NULL;
+      }
+
+      grex_binding_builder_add_constant(builder, constant, -1);
+    } else {
+      GrexExpression *expression = NULL;
+      if (!reader_get_expression(reader, segment.value, FALSE, &expression,
+                                 error)) {
+        return NULL;
+      }
+
+      grex_binding_builder_add_expression(
+          builder, expression,
+          segment.kind == SEGMENT_BIDIRECTIONAL_EXPRESSION);
+    }
+  }
+
+  return grex_binding_builder_build(builder, location);
+}
+
+static GType
+reader_resolve_type(Reader *reader, const char *name, GError **error) {
+  // The name was written from the GType itself, so this finds it unless its
+  // type wasn't registered yet, in which case GtkBuilder can find its
+  // get_type() function.
+  GType type = g_type_from_name(name);
+  if (type == 0) {
+    if (reader->builder == NULL) {
+      reader->builder = gtk_builder_new();
+      gtk_builder_set_scope(reader->builder, reader->scope);
+    }
+
+    type = gtk_builder_get_type_from_name(reader->builder, name);
+  }
+
+  if (type == 0) {
+    g_set_error(error, GREX_FRAGMENT_BINARY_ERROR,
+                GREX_FRAGMENT_BINARY_ERROR_UNKNOWN_TYPE, "Unknown type: %s",
+                name);
+  }
+
+  return type;
+}
+
+static GrexFragment *
+reader_read_fragment(Reader *reader, guint32 index, gboolean is_root,
+                     FragmentRecord *record, GError **error) {
+  const char *type_name = NULL;
+  if (!reader_read_record(reader, SECTION_FRAGMENTS, index, record, error) ||
+      !reader_get_string(reader, record->type_name, FALSE, &type_name,
+                         error)) {
+    return NULL;
+  }
+
+  GType type = reader_resolve_type(reader, type_name, error);
+  if (type == 0) {
+    return NULL;
+  }
+
+  g_autoptr(GrexSourceLocation) location = reader_get_location(
+      reader, record->file, record->line, record->column, error);
+  if (location == NULL) {
+    return NULL;
+  }
+
+  g_autoptr(GrexFragment) fragment =
+      grex_fragment_new(type, location, is_root);
+  for (guint32 i = 0; i < record->n_bindings; i++) {
+    const char *target = NULL;
+    g_autoptr(GrexBinding) binding =
+        reader_read_binding(reader, record->first_binding + i, &target, error);
+    if (binding == NULL) {
+      return NULL;
+    }
+
+    grex_fragment_insert_binding(fragment, target, binding);
+  }
+
+  return g_steal_pointer(&fragment);
+}
+
+gboolean
+grex_fragment_is_binary(const guint8 *data, gsize size) {
+  return size >= HEADER_SIZE &&
+         memcmp(data, BINARY_MAGIC, BINARY_MAGIC_SIZE) == 0;
+}
+
+/**
+ * grex_fragment_parse_binary:
+ * @bytes: The binary data, as written by grex_fragment_write_binary().
+ * @scope: (nullable): The #GtkBuilderScope to resolve type names that aren't
+ *         registered yet.
+ * @error: Return location for a #GError.
+ *
+ * Loads a fragment tree from Grex's binary format. The data is read in place,
+ * so it may come straight from a #GResource.
+ *
+ * Returns: (transfer full): A new fragment, or %NULL on error.
+ */
+GrexFragment *
+grex_fragment_parse_binary(GBytes *bytes, GtkBuilderScope *scope,
+                           GError **error) {
+  g_auto(Reader) reader = {NULL};
+  reader.data = g_bytes_get_data(bytes, &reader.size);
+  reader.scope = scope;
+
+  if (!reader_read_header(&reader, error)) {
+    return NULL;
+  }
+
+  guint32 n_expressions = reader.sections[SECTION_EXPRESSIONS].count;
+  reader.expressions =
+      g_ptr_array_new_full(n_expressions, (GDestroyNotify)g_object_unref);
+  for (guint32 i = 0; i < n_expressions; i++) {
+    GrexExpression *expression = reader_read_expression(&reader, i, error);
+    if (expression == NULL) {
+      return NULL;
+    }
+
+    g_ptr_array_add(reader.expressions, expression);
+  }
+
+  guint32 n_fragments = reader.sections[SECTION_FRAGMENTS].count;
+  if (n_fragments == 0) {
+    set_invalid_error(error, "no root fragment");
+    return NULL;
+  }
+
+  g_autoptr(GrexFragment) root = NULL;
+
+  // The fragments whose children are still being read, along with how many
+  // are left.
+  g_autoptr(GPtrArray) parents = g_ptr_array_new();
+  g_autoptr(GArray) remaining_children =
+      g_array_new(FALSE, FALSE, sizeof(guint32));
+
+  // Adding bindings and children clears the static flag, so it's only set
+  // once everything is loaded.
+  g_autoptr(GPtrArray) static_fragments = g_ptr_array_new();
+
+  for (guint32 i = 0; i < n_fragments; i++) {
+    gboolean is_root = i == 0;
+    if (!is_root && parents->len == 0) {
+      set_invalid_error(error, "multiple root fragments");
+      return NULL;
+    }
+
+    FragmentRecord record;
+    g_autoptr(GrexFragment) fragment =
+        reader_read_fragment(&reader, i, is_root, &record, error);
+    if (fragment == NULL) {
+      return NULL;
+    }
+
+    if (is_root) {
+      root = g_object_ref(fragment);
+    } else {
+      guint last = parents->len - 1;
+      grex_fragment_add_child(g_ptr_array_index(parents, last), fragment);
+      if (--g_array_index(remaining_children, guint32, last) == 0) {
+        g_ptr_array_remove_index(parents, last);
+        g_array_remove_index(remaining_children, last);
+      }
+    }
+
+    if (record.n_children > 0) {
+      g_ptr_array_add(parents, fragment);
+      g_array_append_val(remaining_children, record.n_children);
+    }
+
+    if (record.flags & FRAGMENT_STATIC) {
+      g_ptr_array_add(static_fragments, fragment);
+    }
+  }
+
+  if (parents->len > 0) {
+    set_invalid_error(error, "missing child fragments");
+    return NULL;
+  }
+
+  for (guint i = 0; i < static_fragments->len; i++) {
+    grex_fragment_set_static(g_ptr_array_index(static_fragments, i));
+  }
+
+  return g_steal_pointer(&root);
+}
@@ -0,0 +1,35 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "grex-config.h"
+#include "grex-fragment-host.h"
+
+#ifndef _GREX_INTERNAL
+#error "This is internal stuff, you shouldn't be here!"
+#endif
+
+void grex_fragment_host_clear_subtree_dirty(GrexFragmentHost *host);
+
+void grex_fragment_host_begin_deferred_inflation(GrexFragmentHost *host);
+
+void grex_fragment_host_add_resolved_property(GrexFragmentHost *host,
+                                              GrexKey *key, GParamSpec *pspec,
+                                              GrexValueHolder *value);
+gboolean grex_fragment_host_keep_resolved_property(GrexFragmentHost *host,
+                                                   GrexKey *key);
+void grex_fragment_host_update_resolved_property(GrexFragmentHost *host,
+                                                 GrexKey *key,
+                                                 GrexValueHolder *value);
+
+void grex_fragment_host_add_resolved_signal(GrexFragmentHost *host,
+                                            GrexKey *key, guint signal_id,
+                                            GQuark detail, GClosure *closure,
+                                            gboolean after);
+void grex_fragment_host_replace_resolved_signal(GrexFragmentHost *host,
+                                                GrexKey *key, guint signal_id,
+                                                GQuark detail,
+                                                GClosure *closure,
+                                                gboolean after);
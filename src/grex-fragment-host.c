@@ -5,6 +5,7 @@
 #include "grex-fragment-host.h"
 
 #include "gpropz.h"
+#include "grex-fragment-host-private.h"
 #include "grex-key-private.h"
 #include "grex-property-directive.h"
 
@@ -88,24 +89,131 @@ incremental_table_diff_commit_inflation(
   g_hash_table_remove_all(diff->leftovers);
 }
 
+static void
+incremental_table_diff_abort_inflation(IncrementalTableDiff *diff) {
+  // Nothing was removed yet, so keep the values from both inflations.
+  GHashTableIter iter;
+  gpointer key, value;
+  g_hash_table_iter_init(&iter, diff->leftovers);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    g_hash_table_iter_steal(&iter);
+    g_hash_table_insert(diff->current, key, value);
+  }
+}
+
 static void
 incremental_table_diff_clear(IncrementalTableDiff *diff) {
   g_clear_pointer(&diff->leftovers, g_hash_table_unref);
   g_clear_pointer(&diff->current, g_hash_table_unref);
 }
 
+// Copies the values committed by the previous inflation, so they can be put
+// back by incremental_table_diff_restore_inflation.
+static GHashTable *
+incremental_table_diff_save_current(IncrementalTableDiff *diff,
+                                    GBoxedCopyFunc value_copy_func,
+                                    GDestroyNotify value_destroy_func) {
+  GHashTable *saved = g_hash_table_new_full(
+      (GHashFunc)grex_key_hash, (GEqualFunc)grex_key_equals,
+      (GDestroyNotify)grex_key_unref, value_destroy_func);
+
+  GHashTableIter iter;
+  gpointer key, value;
+  g_hash_table_iter_init(&iter, diff->current);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    g_hash_table_insert(saved, grex_key_ref(key),
+                        value_copy_func != NULL ? value_copy_func(value)
+                                                : value);
+  }
+
+  return saved;
+}
+
+static void
+incremental_table_diff_restore_inflation(IncrementalTableDiff *diff,
+                                         GHashTable *saved) {
+  // Drop everything from the current inflation, as if it never began.
+  g_hash_table_remove_all(diff->leftovers);
+  g_hash_table_unref(diff->current);
+  diff->current = saved;
+}
+
+typedef struct {
+  GParamSpec *pspec;
+  GrexValueHolder *value;
+} PendingProperty;
+
+static void
+pending_property_clear(PendingProperty *pending) {
+  g_clear_pointer(&pending->pspec, g_param_spec_unref);
+  g_clear_pointer(&pending->value, grex_value_holder_unref);
+}
+
+typedef struct {
+  GrexKey *key;
+  guint signal_id;
+  GQuark detail;
+  GClosure *closure;
+  gboolean after;
+} PendingSignal;
+
+static void
+pending_signal_clear(PendingSignal *pending) {
+  g_clear_pointer(&pending->key, grex_key_unref);
+  g_clear_pointer(&pending->closure, g_closure_unref);
+}
+
+// Everything a deferred inflation would change on the target, held back until
+// it's committed.
+typedef struct {
+  // PendingProperty and PendingSignal, in the order they were added.
+  GArray *properties;
+  GArray *signals;
+  // The children to insert, in order.
+  GPtrArray *children;
+
+  // The state committed by the previous inflation, which is put back as-is if
+  // this one is aborted. (The previous signal handlers also stay connected
+  // until the commit.)
+  GHashTable *old_properties;
+  GHashTable *old_signals;
+  GHashTable *old_children;
+} DeferredInflation;
+
+static void
+deferred_inflation_free(DeferredInflation *deferred) {
+  g_clear_pointer(&deferred->properties, g_array_unref);
+  g_clear_pointer(&deferred->signals, g_array_unref);
+  g_clear_pointer(&deferred->children, g_ptr_array_unref);
+  g_clear_pointer(&deferred->old_properties, g_hash_table_unref);
+  g_clear_pointer(&deferred->old_signals, g_hash_table_unref);
+  g_clear_pointer(&deferred->old_children, g_hash_table_unref);
+  g_free(deferred);
+}
+
 struct _GrexFragmentHost {
   GObject parent_instance;
 
   GWeakRef target;
   GrexContainerAdapter *container_adapter;
 
+  // The host this one's target was last added to as a child.
+  GWeakRef parent;
+
   gboolean in_inflation;
+  // Whether this host needs to be inflated again. Hosts start out dirty, since
+  // they haven't been inflated at all yet.
+  gboolean dirty;
+  // Whether this host or any of its descendants are dirty.
+  gboolean subtree_dirty;
 
   // Everything below is inflation-related state:
 
   // The last child added to this inflation.
   GObject *last_child;
+  // Set if the current inflation was begun via
+  // grex_fragment_host_begin_deferred_inflation.
+  DeferredInflation *deferred;
 
   IncrementalTableDiff property_diff;
   IncrementalTableDiff signal_diff;
@@ -165,6 +273,7 @@ grex_fragment_host_dispose(GObject *object) {
   incremental_table_diff_clear(&host->signal_diff);
   incremental_table_diff_clear(&host->prop_directive_diff);
   g_clear_pointer(&host->pending_prop_directive_updates, g_list_free);
+  g_clear_pointer(&host->deferred, deferred_inflation_free);
   incremental_table_diff_clear(&host->struct_directive_diff);
   incremental_table_diff_clear(&host->children_diff);
 }
@@ -173,6 +282,7 @@ static void
 grex_fragment_host_finalize(GObject *object) {
   GrexFragmentHost *host = GREX_FRAGMENT_HOST(object);
   g_weak_ref_clear(&host->target);
+  g_weak_ref_clear(&host->parent);
 }
 
 static void
@@ -227,8 +337,13 @@ grex_fragment_host_class_init(GrexFragmentHostClass *klass) {
 static void
 grex_fragment_host_init(GrexFragmentHost *host) {
   g_weak_ref_init(&host->target, NULL);
+  g_weak_ref_init(&host->parent, NULL);
 
-  incremental_table_diff_init(&host->property_diff, g_free);
+  host->dirty = TRUE;
+  host->subtree_dirty = TRUE;
+
+  incremental_table_diff_init(&host->property_diff,
+                              (GDestroyNotify)g_param_spec_unref);
   incremental_table_diff_init(&host->signal_diff, NULL);
   incremental_table_diff_init(&host->prop_directive_diff, g_object_unref);
   incremental_table_diff_init(&host->struct_directive_diff, g_object_unref);
@@ -333,9 +448,11 @@ grex_fragment_host_begin_inflation(GrexFragmentHost *host) {
 
   host->last_child = NULL;
 
-  // We have no way of checking for duplicate signals atm, so just clear them
-  // all out at the start of the inflation.
-  grex_fragment_host_clear_all_signal_handlers(host);
+  if (host->deferred == NULL) {
+    // We have no way of checking for duplicate signals atm, so just clear them
+    // all out at the start of the inflation.
+    grex_fragment_host_clear_all_signal_handlers(host);
+  }
 
   incremental_table_diff_begin_inflation(&host->property_diff);
   incremental_table_diff_begin_inflation(&host->signal_diff);
@@ -344,6 +461,35 @@ grex_fragment_host_begin_inflation(GrexFragmentHost *host) {
   incremental_table_diff_begin_inflation(&host->struct_directive_diff);
 }
 
+// Same as grex_fragment_host_begin_inflation, but nothing is set on the
+// target, connected to it, or inserted into it until the inflation is
+// committed, and aborting it leaves the target exactly as the previous
+// inflation did. (Property directives are still attached right away.)
+void
+grex_fragment_host_begin_deferred_inflation(GrexFragmentHost *host) {
+  g_return_if_fail(!host->in_inflation);
+
+  DeferredInflation *deferred = g_new0(DeferredInflation, 1);
+  deferred->properties = g_array_new(FALSE, FALSE, sizeof(PendingProperty));
+  g_array_set_clear_func(deferred->properties,
+                         (GDestroyNotify)pending_property_clear);
+  deferred->signals = g_array_new(FALSE, FALSE, sizeof(PendingSignal));
+  g_array_set_clear_func(deferred->signals,
+                         (GDestroyNotify)pending_signal_clear);
+  deferred->children = g_ptr_array_new_with_free_func(g_object_unref);
+
+  deferred->old_properties = incremental_table_diff_save_current(
+      &host->property_diff, (GBoxedCopyFunc)g_param_spec_ref,
+      (GDestroyNotify)g_param_spec_unref);
+  deferred->old_signals =
+      incremental_table_diff_save_current(&host->signal_diff, NULL, NULL);
+  deferred->old_children = incremental_table_diff_save_current(
+      &host->children_diff, g_object_ref, g_object_unref);
+
+  host->deferred = deferred;
+  grex_fragment_host_begin_inflation(host);
+}
+
 /**
  * grex_fragment_host_get_leftover_property_directive:
  * @key: The property directive's key.
@@ -402,6 +548,38 @@ grex_fragment_host_get_leftover_child(GrexFragmentHost *host, GrexKey *key) {
   return incremental_table_diff_get_leftover_value(&host->children_diff, key);
 }
 
+static GParamSpec *
+grex_fragment_host_find_property(GrexFragmentHost *host, const char *name) {
+  GObject *target = grex_fragment_host_get_target(host);
+  GParamSpec *pspec =
+      g_object_class_find_property(G_OBJECT_GET_CLASS(target), name);
+  if (pspec == NULL) {
+    // NOTE: GrexInflator should generally have already caught this, this check
+    // is just a failsafe.
+    g_warning("Unknown property: %s", name);
+  }
+
+  return pspec;
+}
+
+static void
+grex_fragment_host_set_property_if_changed(GrexFragmentHost *host,
+                                           GParamSpec *pspec,
+                                           GrexValueHolder *value) {
+  GObject *target = grex_fragment_host_get_target(host);
+
+  g_auto(GValue) current_value = G_VALUE_INIT;
+  g_value_init(&current_value, pspec->value_type);
+  g_object_get_property(target, pspec->name, &current_value);
+
+  // Only actually set it if changed.
+  if (g_param_values_cmp(pspec, &current_value,
+                         grex_value_holder_get_value(value)) != 0) {
+    g_object_set_property(target, pspec->name,
+                          grex_value_holder_get_value(value));
+  }
+}
+
 /**
  * grex_fragment_host_add_property:
  * @name: The property name.
@@ -417,34 +595,118 @@ grex_fragment_host_add_property(GrexFragmentHost *host, const char *name,
                                 GrexValueHolder *value) {
   g_return_if_fail(host->in_inflation);
 
-  // NOTE: We don't bother checking if this is in the current inflation, since
-  // overwriting properties is an entirely valid use case.
-
-  GObject *target = grex_fragment_host_get_target(host);
-  GObjectClass *target_class = G_OBJECT_GET_CLASS(target);
-
-  GParamSpec *pspec = g_object_class_find_property(target_class, name);
+  GParamSpec *pspec = grex_fragment_host_find_property(host, name);
   if (pspec == NULL) {
-    // NOTE: GrexInflator should generally have already caught this, this check
-    // is just a failsafe.
-    g_warning("Unknown property: %s", name);
     return;
   }
 
-  g_auto(GValue) current_value = G_VALUE_INIT;
-  g_value_init(&current_value, pspec->value_type);
-  g_object_get_property(target, name, &current_value);
+  g_autoptr(GrexKey) key =
+      grex_key_new_string(GREX_PRIVATE_KEY_NAMESPACE, name);
+  grex_fragment_host_add_resolved_property(host, key, pspec, value);
+}
 
-  // Only actually set it if changed.
-  if (g_param_values_cmp(pspec, &current_value,
-                         grex_value_holder_get_value(value)) != 0) {
-    g_object_set_property(target, name, grex_value_holder_get_value(value));
+// Same as grex_fragment_host_add_property, but for a property that was already
+// looked up, identified by a key equal to the one for its name.
+void
+grex_fragment_host_add_resolved_property(GrexFragmentHost *host, GrexKey *key,
+                                         GParamSpec *pspec,
+                                         GrexValueHolder *value) {
+  g_return_if_fail(host->in_inflation);
+
+  // NOTE: We don't bother checking if this is in the current inflation, since
+  // overwriting properties is an entirely valid use case.
+
+  if (host->deferred != NULL) {
+    PendingProperty pending = {g_param_spec_ref(pspec),
+                               grex_value_holder_ref(value)};
+    g_array_append_val(host->deferred->properties, pending);
+  } else {
+    grex_fragment_host_set_property_if_changed(host, pspec, value);
   }
 
+  incremental_table_diff_add_to_current_inflation(&host->property_diff, key,
+                                                  g_param_spec_ref(pspec));
+}
+
+/**
+ * grex_fragment_host_keep_property:
+ * @name: The property name.
+ *
+ * Keeps a property set by the previous inflation as part of the current one,
+ * without setting it again. This is much cheaper than
+ * grex_fragment_host_add_property() for values that are known not to have
+ * changed.
+ *
+ * May only be called during an inflation.
+ *
+ * Returns: %TRUE if the property was kept, or %FALSE if the previous inflation
+ *          didn't set it (in which case it needs to be added instead).
+ */
+gboolean
+grex_fragment_host_keep_property(GrexFragmentHost *host, const char *name) {
   g_autoptr(GrexKey) key =
       grex_key_new_string(GREX_PRIVATE_KEY_NAMESPACE, name);
+  return grex_fragment_host_keep_resolved_property(host, key);
+}
+
+// Same as grex_fragment_host_keep_property, but with the property identified
+// by a key equal to the one for its name.
+gboolean
+grex_fragment_host_keep_resolved_property(GrexFragmentHost *host,
+                                          GrexKey *key) {
+  g_return_val_if_fail(host->in_inflation, FALSE);
+
+  if (incremental_table_diff_is_in_current_inflation(&host->property_diff,
+                                                     key)) {
+    return TRUE;
+  }
+
+  GParamSpec *pspec =
+      incremental_table_diff_get_leftover_value(&host->property_diff, key);
+  if (pspec == NULL) {
+    return FALSE;
+  }
+
   incremental_table_diff_add_to_current_inflation(&host->property_diff, key,
-                                                  g_strdup(name));
+                                                  g_param_spec_ref(pspec));
+  return TRUE;
+}
+
+/**
+ * grex_fragment_host_update_property:
+ * @name: The property name.
+ * @value: The new value.
+ *
+ * Assigns a new value to a property that was added in the most recently
+ * committed inflation, without performing a new inflation.
+ *
+ * May only be called outside of an inflation.
+ */
+void
+grex_fragment_host_update_property(GrexFragmentHost *host, const char *name,
+                                   GrexValueHolder *value) {
+  g_autoptr(GrexKey) key =
+      grex_key_new_string(GREX_PRIVATE_KEY_NAMESPACE, name);
+  grex_fragment_host_update_resolved_property(host, key, value);
+}
+
+// Same as grex_fragment_host_update_property, but with the property identified
+// by a key equal to the one for its name.
+void
+grex_fragment_host_update_resolved_property(GrexFragmentHost *host,
+                                            GrexKey *key,
+                                            GrexValueHolder *value) {
+  g_return_if_fail(!host->in_inflation);
+
+  GParamSpec *pspec = g_hash_table_lookup(host->property_diff.current, key);
+  if (pspec == NULL) {
+    g_autofree char *key_desc = grex_key_describe(key);
+    g_warning("Attempted to update property '%s' that was never added",
+              key_desc);
+    return;
+  }
+
+  grex_fragment_host_set_property_if_changed(host, pspec, value);
 }
 
 /**
@@ -464,22 +726,116 @@ grex_fragment_host_add_signal(GrexFragmentHost *host, GrexKey *key,
                               gboolean after) {
   g_return_if_fail(host->in_inflation);
 
+  GObject *target = grex_fragment_host_get_target(host);
+
+  guint signal_id = 0;
+  GQuark detail = 0;
+  if (!g_signal_parse_name(signal, G_OBJECT_TYPE(target), &signal_id, &detail,
+                           TRUE)) {
+    g_warning("Unknown signal: %s", signal);
+    return;
+  }
+
+  grex_fragment_host_add_resolved_signal(host, key, signal_id, detail, closure,
+                                         after);
+}
+
+// Same as grex_fragment_host_add_signal, but for a signal that was already
+// looked up.
+void
+grex_fragment_host_add_resolved_signal(GrexFragmentHost *host, GrexKey *key,
+                                       guint signal_id, GQuark detail,
+                                       GClosure *closure, gboolean after) {
+  g_return_if_fail(host->in_inflation);
+
   if (incremental_table_diff_is_in_current_inflation(&host->signal_diff, key)) {
     g_autofree char *key_desc = grex_key_describe(key);
     g_warning("Attempted to add signal with key '%s' twice", key_desc);
     return;
   }
 
+  if (host->deferred != NULL) {
+    // The closure may be floating, so sink it the same way connecting it
+    // would.
+    PendingSignal pending = {grex_key_ref(key), signal_id, detail,
+                             g_closure_ref(closure), after};
+    g_closure_sink(closure);
+    g_array_append_val(host->deferred->signals, pending);
+
+    // The handler ID is filled in once it's connected on commit.
+    incremental_table_diff_add_to_current_inflation(&host->signal_diff, key,
+                                                    NULL);
+    return;
+  }
+
   GObject *target = grex_fragment_host_get_target(host);
 
   // NOTE: we don't need to detach the signal, they're all detached at the start
   // of the inflation.
 
-  gulong id = g_signal_connect_closure(target, signal, closure, after);
+  gulong id =
+      g_signal_connect_closure_by_id(target, signal_id, detail, closure, after);
   incremental_table_diff_add_to_current_inflation(&host->signal_diff, key,
                                                   (gpointer)id);
 }
 
+/**
+ * grex_fragment_host_replace_signal:
+ * @signal: The signal name.
+ * @key: The key identifying the connection to replace.
+ * @closure: The closure to connect to.
+ *
+ * Replaces a signal handler that was added in the most recently committed
+ * inflation with a new one, without performing a new inflation.
+ *
+ * May only be called outside of an inflation.
+ */
+void
+grex_fragment_host_replace_signal(GrexFragmentHost *host, GrexKey *key,
+                                  const char *signal, GClosure *closure,
+                                  gboolean after) {
+  g_return_if_fail(!host->in_inflation);
+
+  GObject *target = grex_fragment_host_get_target(host);
+
+  guint signal_id = 0;
+  GQuark detail = 0;
+  if (!g_signal_parse_name(signal, G_OBJECT_TYPE(target), &signal_id, &detail,
+                           TRUE)) {
+    g_warning("Unknown signal: %s", signal);
+    return;
+  }
+
+  grex_fragment_host_replace_resolved_signal(host, key, signal_id, detail,
+                                             closure, after);
+}
+
+// Same as grex_fragment_host_replace_signal, but for a signal that was already
+// looked up.
+void
+grex_fragment_host_replace_resolved_signal(GrexFragmentHost *host,
+                                           GrexKey *key, guint signal_id,
+                                           GQuark detail, GClosure *closure,
+                                           gboolean after) {
+  g_return_if_fail(!host->in_inflation);
+
+  gpointer old_id = NULL;
+  if (!g_hash_table_lookup_extended(host->signal_diff.current, key, NULL,
+                                    &old_id)) {
+    g_autofree char *key_desc = grex_key_describe(key);
+    g_warning("Attempted to replace signal with unknown key '%s'", key_desc);
+    return;
+  }
+
+  GObject *target = grex_fragment_host_get_target(host);
+  g_signal_handler_disconnect(target, (gulong)old_id);
+
+  gulong id =
+      g_signal_connect_closure_by_id(target, signal_id, detail, closure, after);
+  g_hash_table_insert(host->signal_diff.current, grex_key_ref(key),
+                      (gpointer)id);
+}
+
 /**
  * grex_fragment_host_add_property_directive:
  * @directive: The directive.
@@ -561,6 +917,26 @@ grex_fragment_host_add_structural_directive(
                                                   key, g_object_ref(directive));
 }
 
+static void
+insert_child(GrexFragmentHost *host, GObject *child) {
+  // Insert it after the last inserted child (or at the front if there is no
+  // last child, which would mean we're still at the front).
+  GObject *parent = grex_fragment_host_get_target(host);
+  if (host->last_child == NULL) {
+    grex_container_adapter_insert_at_front(host->container_adapter, parent,
+                                           child);
+  } else {
+    grex_container_adapter_insert_next_to(host->container_adapter, parent,
+                                          child, host->last_child);
+  }
+  host->last_child = child;
+
+  GrexFragmentHost *child_host = grex_fragment_host_for_target(child);
+  if (child_host != NULL) {
+    g_weak_ref_set(&child_host->parent, host);
+  }
+}
+
 /**
  * grex_fragment_host_add_inflated_child:
  * @key: The child's key.
@@ -588,34 +964,42 @@ grex_fragment_host_add_inflated_child(GrexFragmentHost *host, GrexKey *key,
     return;
   }
 
-  // Insert it after the last inserted child (or at the front if there is no
-  // last child, which would mean we're still at the front).
-  GObject *parent = grex_fragment_host_get_target(host);
-  if (host->last_child == NULL) {
-    grex_container_adapter_insert_at_front(host->container_adapter, parent,
-                                           child);
+  if (host->deferred != NULL) {
+    g_ptr_array_add(host->deferred->children, g_object_ref(child));
   } else {
-    grex_container_adapter_insert_next_to(host->container_adapter, parent,
-                                          child, host->last_child);
+    insert_child(host, child);
   }
-  host->last_child = child;
 
   incremental_table_diff_add_to_current_inflation(&host->children_diff, key,
                                                   g_object_ref(child));
 }
 
+/**
+ * grex_fragment_host_get_inflated_child:
+ * @key: The child's key.
+ *
+ * Finds and returns the child with the given key from the most recently
+ * committed inflation.
+ *
+ * May only be called outside of an inflation.
+ *
+ * Returns: (transfer none): The child, or NULL if none was found.
+ */
+GObject *
+grex_fragment_host_get_inflated_child(GrexFragmentHost *host, GrexKey *key) {
+  g_return_val_if_fail(!host->in_inflation, NULL);
+  return g_hash_table_lookup(host->children_diff.current, key);
+}
+
 static void
 property_diff_removal_callback(GrexKey *key, gpointer value,
                                gpointer user_data) {
   GrexFragmentHost *host = GREX_FRAGMENT_HOST(user_data);
-  char *name = value;
+  GParamSpec *pspec = value;
 
   GObject *target = grex_fragment_host_get_target(host);
-  GObjectClass *object_class = G_OBJECT_GET_CLASS(target);
-
-  GParamSpec *pspec = g_object_class_find_property(object_class, name);
   const GValue *default_value = g_param_spec_get_default_value(pspec);
-  g_object_set_property(target, name, default_value);
+  g_object_set_property(target, pspec->name, default_value);
 }
 
 static void
@@ -637,6 +1021,45 @@ property_directive_detach_removal_callback(GrexKey *key, gpointer directive,
   detach_directive(host, GREX_PROPERTY_DIRECTIVE(directive));
 }
 
+// Applies everything a deferred inflation held back, in the order it was
+// added.
+static void
+apply_deferred_inflation(GrexFragmentHost *host) {
+  DeferredInflation *deferred = g_steal_pointer(&host->deferred);
+  GObject *target = grex_fragment_host_get_target(host);
+
+  for (guint i = 0; i < deferred->properties->len; i++) {
+    PendingProperty *pending =
+        &g_array_index(deferred->properties, PendingProperty, i);
+    grex_fragment_host_set_property_if_changed(host, pending->pspec,
+                                               pending->value);
+  }
+
+  GHashTableIter iter;
+  gpointer old_id;
+  g_hash_table_iter_init(&iter, deferred->old_signals);
+  while (g_hash_table_iter_next(&iter, NULL, &old_id)) {
+    g_signal_handler_disconnect(target, (gulong)old_id);
+  }
+
+  for (guint i = 0; i < deferred->signals->len; i++) {
+    PendingSignal *pending =
+        &g_array_index(deferred->signals, PendingSignal, i);
+    gulong id = g_signal_connect_closure_by_id(
+        target, pending->signal_id, pending->detail, pending->closure,
+        pending->after);
+    g_hash_table_insert(host->signal_diff.current, grex_key_ref(pending->key),
+                        (gpointer)id);
+  }
+
+  host->last_child = NULL;
+  for (guint i = 0; i < deferred->children->len; i++) {
+    insert_child(host, g_ptr_array_index(deferred->children, i));
+  }
+
+  deferred_inflation_free(deferred);
+}
+
 /**
  * grex_fragment_host_commit_inflation:
  *
@@ -647,9 +1070,15 @@ void
 grex_fragment_host_commit_inflation(GrexFragmentHost *host) {
   g_return_if_fail(host->in_inflation);
 
+  if (host->deferred != NULL) {
+    apply_deferred_inflation(host);
+  }
+
   grex_fragment_host_apply_pending_directive_updates(host);
 
   host->in_inflation = FALSE;
+  host->dirty = FALSE;
+  host->subtree_dirty = FALSE;
 
   incremental_table_diff_commit_inflation(&host->property_diff,
                                           property_diff_removal_callback, host);
@@ -662,3 +1091,98 @@ grex_fragment_host_commit_inflation(GrexFragmentHost *host) {
   incremental_table_diff_commit_inflation(&host->children_diff,
                                           child_diff_removal_callback, host);
 }
+
+/**
+ * grex_fragment_host_abort_inflation:
+ *
+ * Aborts the current inflation without removing anything. Everything from the
+ * previous inflation is kept alongside whatever was added by the current one,
+ * and any outstanding directive updates are dropped. (A deferred inflation
+ * never applied anything to the target, so the previous inflation is simply
+ * left in place instead.) The host is marked dirty, so the next inflation with
+ * %GREX_INFLATION_ONLY_DIRTY brings it back in sync.
+ */
+void
+grex_fragment_host_abort_inflation(GrexFragmentHost *host) {
+  g_return_if_fail(host->in_inflation);
+
+  g_clear_pointer(&host->pending_prop_directive_updates, g_list_free);
+
+  host->in_inflation = FALSE;
+
+  if (host->deferred != NULL) {
+    // Nothing was applied to the target, so go back to exactly what the
+    // previous inflation left there.
+    DeferredInflation *deferred = g_steal_pointer(&host->deferred);
+    incremental_table_diff_restore_inflation(
+        &host->property_diff, g_steal_pointer(&deferred->old_properties));
+    incremental_table_diff_restore_inflation(
+        &host->signal_diff, g_steal_pointer(&deferred->old_signals));
+    incremental_table_diff_restore_inflation(
+        &host->children_diff, g_steal_pointer(&deferred->old_children));
+    deferred_inflation_free(deferred);
+  } else {
+    incremental_table_diff_abort_inflation(&host->property_diff);
+    // The old signal handlers were already disconnected when the inflation
+    // began, so only the new ones are left to track.
+    g_hash_table_remove_all(host->signal_diff.leftovers);
+    incremental_table_diff_abort_inflation(&host->children_diff);
+  }
+
+  incremental_table_diff_abort_inflation(&host->prop_directive_diff);
+  incremental_table_diff_abort_inflation(&host->struct_directive_diff);
+
+  grex_fragment_host_mark_dirty(host);
+}
+
+/**
+ * grex_fragment_host_mark_dirty:
+ *
+ * Marks this fragment host as needing a new inflation. All of its ancestors
+ * are marked as having a dirty subtree, so an inflation with
+ * %GREX_INFLATION_ONLY_DIRTY can find it without touching any clean hosts.
+ */
+void
+grex_fragment_host_mark_dirty(GrexFragmentHost *host) {
+  host->dirty = TRUE;
+
+  g_autoptr(GrexFragmentHost) current = g_object_ref(host);
+  while (current != NULL && !current->subtree_dirty) {
+    current->subtree_dirty = TRUE;
+
+    GrexFragmentHost *parent = g_weak_ref_get(&current->parent);
+    g_object_unref(current);
+    current = parent;
+  }
+}
+
+/**
+ * grex_fragment_host_is_dirty:
+ *
+ * Checks if this fragment host needs a new inflation, either because it was
+ * marked dirty or because it was never inflated.
+ *
+ * Returns: %TRUE if the host is dirty.
+ */
+gboolean
+grex_fragment_host_is_dirty(GrexFragmentHost *host) {
+  return host->dirty;
+}
+
+/**
+ * grex_fragment_host_is_subtree_dirty:
+ *
+ * Checks if this fragment host or any of its descendants are dirty.
+ *
+ * Returns: %TRUE if the host or a descendant is dirty.
+ */
+gboolean
+grex_fragment_host_is_subtree_dirty(GrexFragmentHost *host) {
+  return host->subtree_dirty;
+}
+
+void
+grex_fragment_host_clear_subtree_dirty(GrexFragmentHost *host) {
+  g_return_if_fail(!host->dirty);
+  host->subtree_dirty = FALSE;
+}
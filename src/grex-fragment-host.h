@@ -36,10 +36,19 @@ void grex_fragment_host_begin_inflation(GrexFragmentHost *host);
 
 void grex_fragment_host_add_property(GrexFragmentHost *host, const char *name,
                                      GrexValueHolder *value);
+gboolean grex_fragment_host_keep_property(GrexFragmentHost *host,
+                                          const char *name);
 void grex_fragment_host_add_signal(GrexFragmentHost *host, GrexKey *key,
                                    const char *signal, GClosure *closure,
                                    gboolean after);
 
+void grex_fragment_host_update_property(GrexFragmentHost *host,
+                                        const char *name,
+                                        GrexValueHolder *value);
+void grex_fragment_host_replace_signal(GrexFragmentHost *host, GrexKey *key,
+                                       const char *signal, GClosure *closure,
+                                       gboolean after);
+
 GrexPropertyDirective *
 grex_fragment_host_get_leftover_property_directive(GrexFragmentHost *host,
                                                    GrexKey *key);
@@ -59,7 +68,14 @@ GObject *grex_fragment_host_get_leftover_child(GrexFragmentHost *host,
                                                GrexKey *key);
 void grex_fragment_host_add_inflated_child(GrexFragmentHost *host, GrexKey *key,
                                            GObject *child);
+GObject *grex_fragment_host_get_inflated_child(GrexFragmentHost *host,
+                                               GrexKey *key);
 
 void grex_fragment_host_commit_inflation(GrexFragmentHost *host);
+void grex_fragment_host_abort_inflation(GrexFragmentHost *host);
+
+void grex_fragment_host_mark_dirty(GrexFragmentHost *host);
+gboolean grex_fragment_host_is_dirty(GrexFragmentHost *host);
+gboolean grex_fragment_host_is_subtree_dirty(GrexFragmentHost *host);
 
 G_END_DECLS
@@ -0,0 +1,131 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "grex-config.h"
+#include "grex-fragment.h"
+#include "grex-key.h"
+
+#ifndef _GREX_INTERNAL
+#error "This is internal stuff, you shouldn't be here!"
+#endif
+
+#define GREX_LET_PREFIX "Grex.let."
+
+typedef enum {
+  // Starts a fragment, followed by its own instructions, then its children,
+  // then the matching LEAVE.
+  GREX_FRAGMENT_OP_ENTER,
+  // Defines a computed value via Grex.let.NAME.
+  GREX_FRAGMENT_OP_LET,
+  // Sets a property from a constant binding.
+  GREX_FRAGMENT_OP_SET,
+  // Binds a property to a non-constant binding.
+  GREX_FRAGMENT_OP_BIND,
+  // Connects a signal via on.NAME.
+  GREX_FRAGMENT_OP_CONNECT,
+  // Passes an input to a property directive.
+  GREX_FRAGMENT_OP_DIRECTIVE,
+  // Passes an input to a structural directive, applied by the parent.
+  GREX_FRAGMENT_OP_STRUCTURAL,
+  GREX_FRAGMENT_OP_LEAVE,
+} GrexFragmentOp;
+
+// What a property or signal binding applies to, looked up on a type once so
+// that applying the binding doesn't need to find it by name again.
+typedef struct {
+  // The (interned) name the binding targets, and the key identifying it in a
+  // host.
+  const char *name;
+  GrexKey *key;
+
+  // For properties: the property itself, along with the notify signal and the
+  // key used to connect a two-way binding's push handler to it.
+  GParamSpec *pspec;
+  GrexKey *notify_key;
+
+  // For on.NAME bindings, the signal, otherwise the property's notify signal.
+  guint signal_id;
+  GQuark signal_detail;
+} GrexBindingTarget;
+
+void grex_binding_target_init(GrexBindingTarget *target, GType type,
+                              const char *name);
+void grex_binding_target_copy(GrexBindingTarget *dest,
+                              const GrexBindingTarget *src);
+void grex_binding_target_clear(GrexBindingTarget *target);
+
+// Checks if the target was found, i.e. if it's either a property or a signal.
+static inline gboolean
+grex_binding_target_is_resolved(const GrexBindingTarget *target) {
+  return target->pspec != NULL || target->signal_id != 0;
+}
+
+typedef struct {
+  GrexFragmentOp op;
+
+  // The fragment the instruction belongs to.
+  GrexFragment *fragment;
+
+  // For ENTER: the distance to the matching LEAVE, the distance to the first
+  // child (or the LEAVE if there are none), whether there are any STRUCTURAL
+  // instructions, and whether the whole subtree is static.
+  guint length;
+  guint children_offset;
+  gboolean has_structural;
+  gboolean is_static;
+
+  // For everything else: the binding's (interned) target name and the binding
+  // itself. LET instructions store the name being defined in arg, and
+  // STRUCTURAL ones the directive name without the underscore prefix.
+  const char *name;
+  const char *arg;
+  GrexBinding *binding;
+
+  // For SET, BIND and CONNECT: the binding's target, resolved on the
+  // fragment's target type.
+  GrexBindingTarget target;
+} GrexFragmentInstruction;
+
+// A fragment tree flattened into a single array of instructions, in the order
+// an inflation visits them.
+typedef struct {
+  grefcount rc;
+  gint serial;
+
+  GrexFragmentInstruction *instructions;
+  guint n_instructions;
+} GrexFragmentProgram;
+
+// Checks if the data starts with the header of a binary fragment.
+gboolean grex_fragment_is_binary(const guint8 *data, gsize size);
+
+void grex_fragment_set_static(GrexFragment *fragment);
+
+GrexFragmentProgram *grex_fragment_program_ref(GrexFragmentProgram *program);
+void grex_fragment_program_unref(GrexFragmentProgram *program);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GrexFragmentProgram, grex_fragment_program_unref)
+
+GrexFragmentProgram *grex_fragment_get_program(GrexFragment *fragment);
+
+// The ENTER instruction of the program's root fragment.
+static inline const GrexFragmentInstruction *
+grex_fragment_program_get_root(GrexFragmentProgram *program) {
+  return &program->instructions[0];
+}
+
+// Iterates over the instructions of the fragment started by the given ENTER
+// instruction, not including its children.
+#define GREX_FRAGMENT_FOREACH_INSTRUCTION(node, instruction)          \
+  for (const GrexFragmentInstruction *instruction = (node) + 1;       \
+       instruction < (node) + (node)->children_offset; instruction++)
+
+// Iterates over the ENTER instructions of the children of the fragment started
+// by the given ENTER instruction.
+#define GREX_FRAGMENT_FOREACH_CHILD(node, child)                       \
+  for (const GrexFragmentInstruction *child =                         \
+           (node) + (node)->children_offset;                          \
+       child->op == GREX_FRAGMENT_OP_ENTER; child += child->length + 1)
@@ -6,12 +6,35 @@
 
 #include "gpropz.h"
 #include "grex-binding.h"
+#include "grex-fragment-private.h"
+#include "grex-key-private.h"
 
 /*
  * GrexFragment:
  *
  * TODO: docs
  */
+
+// A binding along with what it does, decided once when it's inserted.
+typedef struct {
+  GrexFragmentOp op;
+  // Interned, same as GrexFragmentInstruction.
+  const char *name;
+  const char *arg;
+  GrexBinding *binding;
+} ClassifiedBinding;
+
+// The groups a fragment's bindings are kept in, in the order they're
+// compiled. Within a group, bindings stay in the order they were inserted.
+typedef enum {
+  BINDING_GROUP_LETS,
+  BINDING_GROUP_PROPERTIES,
+  BINDING_GROUP_SIGNALS,
+  BINDING_GROUP_DIRECTIVES,
+  BINDING_GROUP_STRUCTURAL,
+  N_BINDING_GROUPS,
+} BindingGroup;
+
 struct _GrexFragment {
   GObject parent_instance;
 
@@ -21,7 +44,28 @@ struct _GrexFragment {
   gboolean is_root;
 
   GHashTable *bindings;
+  // The same bindings, partitioned by what they do.
+  GArray *binding_groups[N_BINDING_GROUPS];
   GPtrArray *children;
+
+  // Set by grex_fragment_parse_xml if nothing in this subtree can change
+  // between inflations, cleared again by any modification.
+  gboolean is_static;
+
+  // The compiled form of this fragment's subtree, if it was requested since
+  // the last modification.
+  GrexFragmentProgram *program;
+  // Whether this fragment is part of any compiled program, in which case
+  // modifying it invalidates them.
+  gboolean in_program;
+  // Bumped by every modification of this fragment or any of its descendants
+  // once they're in a program, so the programs containing them are compiled
+  // again.
+  gint serial;
+
+  // The fragments this one was added to as a child. They hold a reference to
+  // this one, so they aren't referenced back.
+  GPtrArray *parents;
 };
 
 enum {
@@ -35,13 +79,52 @@ static GParamSpec *properties[N_PROPS] = {NULL};
 
 G_DEFINE_TYPE(GrexFragment, grex_fragment, G_TYPE_OBJECT)
 
+static void
+bump_serials(GrexFragment *fragment) {
+  fragment->serial++;
+  for (guint i = 0; i < fragment->parents->len; i++) {
+    bump_serials(g_ptr_array_index(fragment->parents, i));
+  }
+}
+
+static void
+invalidate_programs(GrexFragment *fragment) {
+  // Fragments that are still being built can't be in any program yet.
+  // Otherwise, only the programs of this fragment's own tree contain it.
+  if (fragment->in_program) {
+    bump_serials(fragment);
+  }
+}
+
+static void
+classified_binding_clear(ClassifiedBinding *classified) {
+  g_clear_object(&classified->binding);
+}
+
 static void
 grex_fragment_dispose(GObject *object) {
   GrexFragment *fragment = GREX_FRAGMENT(object);
 
   g_clear_object(&fragment->location);
   g_clear_pointer(&fragment->bindings, g_hash_table_unref);
+  for (int i = 0; i < N_BINDING_GROUPS; i++) {
+    g_clear_pointer(&fragment->binding_groups[i], g_array_unref);
+  }
+  if (fragment->children != NULL) {
+    for (guint i = 0; i < fragment->children->len; i++) {
+      GrexFragment *child = g_ptr_array_index(fragment->children, i);
+      g_ptr_array_remove(child->parents, fragment);
+    }
+  }
   g_clear_pointer(&fragment->children, g_ptr_array_unref);
+  g_clear_pointer(&fragment->program, grex_fragment_program_unref);
+}
+
+static void
+grex_fragment_finalize(GObject *object) {
+  GrexFragment *fragment = GREX_FRAGMENT(object);
+
+  g_clear_pointer(&fragment->parents, g_ptr_array_unref);
 }
 
 static void
@@ -49,6 +132,7 @@ grex_fragment_class_init(GrexFragmentClass *klass) {
   GObjectClass *object_class = G_OBJECT_CLASS(klass);
 
   object_class->dispose = grex_fragment_dispose;
+  object_class->finalize = grex_fragment_finalize;
 
   gpropz_class_init_property_functions(object_class);
 
@@ -77,7 +161,14 @@ static void
 grex_fragment_init(GrexFragment *fragment) {
   fragment->bindings =
       g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
+  for (int i = 0; i < N_BINDING_GROUPS; i++) {
+    fragment->binding_groups[i] =
+        g_array_new(FALSE, FALSE, sizeof(ClassifiedBinding));
+    g_array_set_clear_func(fragment->binding_groups[i],
+                           (GDestroyNotify)classified_binding_clear);
+  }
   fragment->children = g_ptr_array_new_with_free_func(g_object_unref);
+  fragment->parents = g_ptr_array_new();
 }
 
 /**
@@ -177,6 +268,36 @@ grex_fragment_parser_end_fragment(GMarkupParseContext *context,
   }
 }
 
+// Checks if the fragment and all its descendants only have constant bindings,
+// marking every static fragment along the way.
+static gboolean
+grex_fragment_analyze_static(GrexFragment *fragment) {
+  gboolean is_static = TRUE;
+
+  // Every child needs to be visited to mark it, even once the answer is known.
+  for (guint i = 0; i < fragment->children->len; i++) {
+    if (!grex_fragment_analyze_static(
+            g_ptr_array_index(fragment->children, i))) {
+      is_static = FALSE;
+    }
+  }
+
+  GHashTableIter iter;
+  gpointer target, binding;
+  g_hash_table_iter_init(&iter, fragment->bindings);
+  while (is_static && g_hash_table_iter_next(&iter, &target, &binding)) {
+    // Structural directives (prefixed with an underscore) decide what gets
+    // inflated at all, even with constant inputs.
+    const char *name = target;
+    if (name[0] == '_' || !grex_binding_is_constant(binding)) {
+      is_static = FALSE;
+    }
+  }
+
+  fragment->is_static = is_static;
+  return is_static;
+}
+
 /**
  * grex_fragment_parse_xml:
  * @xml: The XML content.
@@ -216,7 +337,10 @@ grex_fragment_parse_xml(const char *xml, gssize len, const char *filename,
   }
 
   g_return_val_if_fail(fragment_stack->len == 1, NULL);
-  return g_ptr_array_steal_index(fragment_stack, 0);
+
+  GrexFragment *root = g_ptr_array_steal_index(fragment_stack, 0);
+  grex_fragment_analyze_static(root);
+  return root;
 }
 
 /**
@@ -251,6 +375,106 @@ grex_fragment_is_root(GrexFragment *fragment) {
   return fragment->is_root;
 }
 
+/**
+ * grex_fragment_is_static:
+ *
+ * Checks if this fragment's subtree is static, i.e. it only contains constant
+ * bindings and no structural directives, so inflating it again always gives
+ * the same result. (Auto-attached directives only ever receive constant
+ * inputs, so they don't affect this.) An inflator skips static subtrees
+ * entirely once they've been inflated.
+ *
+ * Only fragments created by grex_fragment_parse_xml() are analyzed (and
+ * grex_fragment_parse_binary() keeps the results of that analysis), and
+ * modifying a fragment or any of its descendants marks it as no longer static.
+ *
+ * Returns: %TRUE if the fragment is static.
+ */
+gboolean
+grex_fragment_is_static(GrexFragment *fragment) {
+  if (!fragment->is_static) {
+    return FALSE;
+  }
+
+  // A fragment doesn't know its ancestors, so a modified descendant is only
+  // noticed from here.
+  for (guint i = 0; i < fragment->children->len; i++) {
+    if (!grex_fragment_is_static(g_ptr_array_index(fragment->children, i))) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+// Marks a fragment loaded from a binary fragment as static, since it was
+// already analyzed before it was written.
+void
+grex_fragment_set_static(GrexFragment *fragment) {
+  fragment->is_static = TRUE;
+}
+
+// Decides what a binding on the given target does, based on the same naming
+// rules the inflator has always used: structural directives are prefixed with
+// an underscore, property directives are capitalized (and Grex.let.NAME
+// defines a computed value), on.NAME connects a signal, and everything else is
+// a property.
+static GrexFragmentOp
+classify_binding(const char *name, GrexBinding *binding, const char **arg) {
+  *arg = NULL;
+
+  if (name[0] == '_' && g_ascii_isupper(name[1])) {
+    *arg = g_intern_string(name + 1);
+    return GREX_FRAGMENT_OP_STRUCTURAL;
+  } else if (g_ascii_isupper(name[0])) {
+    if (g_str_has_prefix(name, GREX_LET_PREFIX) &&
+        name[strlen(GREX_LET_PREFIX)] != '\0') {
+      *arg = g_intern_string(name + strlen(GREX_LET_PREFIX));
+      return GREX_FRAGMENT_OP_LET;
+    }
+
+    return GREX_FRAGMENT_OP_DIRECTIVE;
+  } else if (g_str_has_prefix(name, "on.")) {
+    return GREX_FRAGMENT_OP_CONNECT;
+  } else if (grex_binding_is_constant(binding)) {
+    return GREX_FRAGMENT_OP_SET;
+  } else {
+    return GREX_FRAGMENT_OP_BIND;
+  }
+}
+
+static BindingGroup
+get_binding_group(GrexFragmentOp op) {
+  switch (op) {
+  case GREX_FRAGMENT_OP_LET:
+    return BINDING_GROUP_LETS;
+  case GREX_FRAGMENT_OP_SET:
+  case GREX_FRAGMENT_OP_BIND:
+    return BINDING_GROUP_PROPERTIES;
+  case GREX_FRAGMENT_OP_CONNECT:
+    return BINDING_GROUP_SIGNALS;
+  case GREX_FRAGMENT_OP_DIRECTIVE:
+    return BINDING_GROUP_DIRECTIVES;
+  case GREX_FRAGMENT_OP_STRUCTURAL:
+    return BINDING_GROUP_STRUCTURAL;
+  default:
+    g_return_val_if_reached(BINDING_GROUP_PROPERTIES);
+  }
+}
+
+// Finds the binding with the given interned name in the group.
+static gboolean
+find_classified_binding(GArray *group, const char *name, guint *index) {
+  for (guint i = 0; i < group->len; i++) {
+    if (g_array_index(group, ClassifiedBinding, i).name == name) {
+      *index = i;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
 /**
  * grex_fragment_insert_binding:
  * @target: The binding's target property.
@@ -262,21 +486,52 @@ grex_fragment_is_root(GrexFragment *fragment) {
 void
 grex_fragment_insert_binding(GrexFragment *fragment, const char *target,
                              GrexBinding *binding) {
+  fragment->is_static = FALSE;
+  invalidate_programs(fragment);
   g_hash_table_insert(fragment->bindings, g_strdup(target),
                       g_object_ref(binding));
+
+  ClassifiedBinding classified = {
+      .name = g_intern_string(target),
+      .binding = g_object_ref(binding),
+  };
+  classified.op = classify_binding(target, binding, &classified.arg);
+
+  // A name always ends up in the same group, so a binding it replaces can
+  // keep its position.
+  GArray *group = fragment->binding_groups[get_binding_group(classified.op)];
+  guint index = 0;
+  if (find_classified_binding(group, classified.name, &index)) {
+    ClassifiedBinding *existing =
+        &g_array_index(group, ClassifiedBinding, index);
+    classified_binding_clear(existing);
+    *existing = classified;
+  } else {
+    g_array_append_val(group, classified);
+  }
 }
 
 /**
  * grex_fragment_get_binding_targets:
  *
  * Returns the names of the targets contained within this fragment's property
- * bindings under the same name.
+ * bindings under the same name, in the order they're applied in.
  *
  * Returns: (element-type utf8) (transfer container): A list of target names.
  */
 GList *
 grex_fragment_get_binding_targets(GrexFragment *fragment) {
-  return g_hash_table_get_keys(fragment->bindings);
+  GList *targets = NULL;
+  for (int i = N_BINDING_GROUPS - 1; i >= 0; i--) {
+    GArray *group = fragment->binding_groups[i];
+    for (guint j = group->len; j > 0; j--) {
+      ClassifiedBinding *classified =
+          &g_array_index(group, ClassifiedBinding, j - 1);
+      targets = g_list_prepend(targets, (gpointer)classified->name);
+    }
+  }
+
+  return targets;
 }
 
 /**
@@ -302,7 +557,22 @@ grex_fragment_get_binding(GrexFragment *fragment, const char *target) {
  */
 gboolean
 grex_fragment_remove_binding(GrexFragment *fragment, const char *target) {
-  return g_hash_table_remove(fragment->bindings, target);
+  fragment->is_static = FALSE;
+  invalidate_programs(fragment);
+  if (!g_hash_table_remove(fragment->bindings, target)) {
+    return FALSE;
+  }
+
+  const char *name = g_intern_string(target);
+  for (int i = 0; i < N_BINDING_GROUPS; i++) {
+    guint index = 0;
+    if (find_classified_binding(fragment->binding_groups[i], name, &index)) {
+      g_array_remove_index(fragment->binding_groups[i], index);
+      break;
+    }
+  }
+
+  return TRUE;
 }
 
 /**
@@ -313,7 +583,10 @@ grex_fragment_remove_binding(GrexFragment *fragment, const char *target) {
  */
 void
 grex_fragment_add_child(GrexFragment *fragment, GrexFragment *child) {
+  fragment->is_static = FALSE;
+  invalidate_programs(fragment);
   g_ptr_array_add(fragment->children, g_object_ref(child));
+  g_ptr_array_add(child->parents, fragment);
 }
 
 /**
@@ -334,3 +607,175 @@ grex_fragment_get_children(GrexFragment *fragment) {
 
   return g_list_reverse(children);
 }
+
+// Looks up what the binding with the given name applies to on the type. If
+// neither a property nor a signal is found, the target is left unresolved, and
+// the binding needs to be checked against the actual target object instead.
+void
+grex_binding_target_init(GrexBindingTarget *target, GType type,
+                         const char *name) {
+  memset(target, 0, sizeof(*target));
+  target->name = g_intern_string(name);
+  target->key = grex_key_new_string(GREX_PRIVATE_KEY_NAMESPACE, name);
+
+  if (!G_TYPE_IS_OBJECT(type)) {
+    return;
+  }
+
+  GObjectClass *target_class = g_type_class_ref(type);
+  GParamSpec *pspec = g_object_class_find_property(target_class, name);
+  g_type_class_unref(target_class);
+
+  if (pspec != NULL) {
+    g_autofree char *notify = g_strdup_printf("notify::%s", name);
+
+    target->pspec = g_param_spec_ref(pspec);
+    target->notify_key =
+        grex_key_new_string(GREX_PRIVATE_KEY_NAMESPACE, notify);
+    target->signal_id = g_signal_lookup("notify", G_TYPE_OBJECT);
+    target->signal_detail = g_param_spec_get_name_quark(pspec);
+  } else if (g_str_has_prefix(name, "on.")) {
+    target->signal_id = g_signal_lookup(name + strlen("on."), type);
+  }
+}
+
+void
+grex_binding_target_copy(GrexBindingTarget *dest,
+                         const GrexBindingTarget *src) {
+  *dest = *src;
+  grex_key_ref(dest->key);
+  if (dest->pspec != NULL) {
+    g_param_spec_ref(dest->pspec);
+  }
+  if (dest->notify_key != NULL) {
+    grex_key_ref(dest->notify_key);
+  }
+}
+
+void
+grex_binding_target_clear(GrexBindingTarget *target) {
+  g_clear_pointer(&target->key, grex_key_unref);
+  g_clear_pointer(&target->pspec, g_param_spec_unref);
+  g_clear_pointer(&target->notify_key, grex_key_unref);
+}
+
+GrexFragmentProgram *
+grex_fragment_program_ref(GrexFragmentProgram *program) {
+  g_ref_count_inc(&program->rc);
+  return program;
+}
+
+void
+grex_fragment_program_unref(GrexFragmentProgram *program) {
+  if (g_ref_count_dec(&program->rc)) {
+    for (guint i = 0; i < program->n_instructions; i++) {
+      g_clear_object(&program->instructions[i].binding);
+      grex_binding_target_clear(&program->instructions[i].target);
+    }
+
+    g_free(program->instructions);
+    g_free(program);
+  }
+}
+
+static void
+append_instruction(GArray *instructions, GrexFragmentOp op,
+                   GrexFragment *fragment, const char *name, const char *arg,
+                   GrexBinding *binding) {
+  GrexFragmentInstruction instruction = {
+      .op = op,
+      .fragment = fragment,
+      .name = name != NULL ? g_intern_string(name) : NULL,
+      .arg = arg,
+      .binding = binding != NULL ? g_object_ref(binding) : NULL,
+  };
+
+  if (op == GREX_FRAGMENT_OP_SET || op == GREX_FRAGMENT_OP_BIND ||
+      op == GREX_FRAGMENT_OP_CONNECT) {
+    grex_binding_target_init(&instruction.target, fragment->target_type, name);
+  }
+
+  g_array_append_val(instructions, instruction);
+}
+
+static void
+compile_binding_group(GrexFragment *fragment, GArray *instructions,
+                      BindingGroup group) {
+  GArray *bindings = fragment->binding_groups[group];
+  for (guint i = 0; i < bindings->len; i++) {
+    ClassifiedBinding *classified =
+        &g_array_index(bindings, ClassifiedBinding, i);
+    append_instruction(instructions, classified->op, fragment,
+                       classified->name, classified->arg,
+                       classified->binding);
+  }
+}
+
+static void
+compile_fragment(GrexFragment *fragment, GArray *instructions) {
+  fragment->in_program = TRUE;
+
+  guint enter = instructions->len;
+  append_instruction(instructions, GREX_FRAGMENT_OP_ENTER, fragment, NULL,
+                     NULL, NULL);
+
+  // Computed values come first, since the fragment's own bindings can read
+  // them, and directives come last, same as in an inflation.
+  for (int group = 0; group < N_BINDING_GROUPS; group++) {
+    compile_binding_group(fragment, instructions, group);
+  }
+
+  guint children = instructions->len;
+  gboolean has_structural =
+      children > enter + 1 &&
+      g_array_index(instructions, GrexFragmentInstruction, children - 1).op ==
+          GREX_FRAGMENT_OP_STRUCTURAL;
+
+  // Same as grex_fragment_is_static, but without walking the subtree again
+  // for every fragment in it.
+  gboolean is_static = fragment->is_static;
+  for (guint i = 0; i < fragment->children->len; i++) {
+    guint child = instructions->len;
+    compile_fragment(g_ptr_array_index(fragment->children, i), instructions);
+    is_static &=
+        g_array_index(instructions, GrexFragmentInstruction, child).is_static;
+  }
+
+  append_instruction(instructions, GREX_FRAGMENT_OP_LEAVE, fragment, NULL,
+                     NULL, NULL);
+
+  GrexFragmentInstruction *enter_instruction =
+      &g_array_index(instructions, GrexFragmentInstruction, enter);
+  enter_instruction->length = instructions->len - 1 - enter;
+  enter_instruction->children_offset = children - enter;
+  enter_instruction->has_structural = has_structural;
+  enter_instruction->is_static = is_static;
+}
+
+// Returns the compiled form of this fragment's subtree, compiling it first if
+// it's missing or any fragment was modified since. The instructions hold
+// references to their bindings, but not to their fragments, so callers must
+// keep the fragment alive for as long as they use the program.
+GrexFragmentProgram *
+grex_fragment_get_program(GrexFragment *fragment) {
+  if (fragment->program != NULL &&
+      fragment->program->serial == fragment->serial) {
+    return fragment->program;
+  }
+
+  g_autoptr(GArray) instructions =
+      g_array_new(FALSE, FALSE, sizeof(GrexFragmentInstruction));
+  compile_fragment(fragment, instructions);
+
+  GrexFragmentProgram *program = g_new0(GrexFragmentProgram, 1);
+  g_ref_count_init(&program->rc);
+  program->serial = fragment->serial;
+  program->n_instructions = instructions->len;
+  program->instructions =
+      (GrexFragmentInstruction *)g_array_free(g_steal_pointer(&instructions),
+                                              FALSE);
+
+  g_clear_pointer(&fragment->program, grex_fragment_program_unref);
+  fragment->program = program;
+  return program;
+}
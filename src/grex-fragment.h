@@ -14,6 +14,16 @@
 
 G_BEGIN_DECLS
 
+typedef enum {
+  GREX_FRAGMENT_BINARY_ERROR_INVALID,
+  GREX_FRAGMENT_BINARY_ERROR_UNSUPPORTED_VERSION,
+  GREX_FRAGMENT_BINARY_ERROR_UNKNOWN_TYPE,
+  GREX_FRAGMENT_BINARY_ERROR_UNSUPPORTED_EXPRESSION,
+} GrexFragmentBinaryError;
+
+#define GREX_FRAGMENT_BINARY_ERROR grex_fragment_binary_error_quark()
+GQuark grex_fragment_binary_error_quark();
+
 #define GREX_TYPE_FRAGMENT grex_fragment_get_type()
 G_DECLARE_FINAL_TYPE(GrexFragment, grex_fragment, GREX, FRAGMENT, GObject)
 
@@ -24,9 +34,14 @@ GrexFragment *grex_fragment_parse_xml(const char *xml, gssize len,
                                       const char *filename,
                                       GtkBuilderScope *scope, GError **error);
 
+GrexFragment *grex_fragment_parse_binary(GBytes *bytes, GtkBuilderScope *scope,
+                                         GError **error);
+GBytes *grex_fragment_write_binary(GrexFragment *fragment, GError **error);
+
 GType grex_fragment_get_target_type(GrexFragment *fragment);
 GrexSourceLocation *grex_fragment_get_location(GrexFragment *fragment);
 gboolean grex_fragment_is_root(GrexFragment *fragment);
+gboolean grex_fragment_is_static(GrexFragment *fragment);
 
 void grex_fragment_insert_binding(GrexFragment *fragment, const char *target,
                                   GrexBinding *binding);
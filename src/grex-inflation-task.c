@@ -0,0 +1,414 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "grex-inflation-task.h"
+
+#include "gpropz.h"
+#include "grex-enums.h"
+#include "grex-fragment-host.h"
+#include "grex-inflator-private.h"
+#include "grex-key-private.h"
+
+// A host whose inflation has begun, along with the children that still need to
+// be inflated into it.
+typedef struct {
+  GrexFragmentHost *host;
+  GObject *target;
+
+  // The fragment's ENTER instruction, and the one of the next child to inflate
+  // (or the fragment's LEAVE once they're all done).
+  const GrexFragmentInstruction *node;
+  const GrexFragmentInstruction *next_child;
+  int next_index;
+
+  // Where to add the target once all its children are done, or NULL for the
+  // root.
+  GrexFragmentHost *parent;
+  GrexKey *key;
+
+  // The computed values visible to the children.
+  GrexComputedScope *computed_scope;
+} HostFrame;
+
+static void
+host_frame_free(HostFrame *frame) {
+  g_clear_object(&frame->host);
+  g_clear_object(&frame->target);
+  g_clear_object(&frame->parent);
+  g_clear_pointer(&frame->key, grex_key_unref);
+  g_clear_pointer(&frame->computed_scope, grex_computed_scope_unref);
+  g_free(frame);
+}
+
+struct _GrexInflationTask {
+  GObject parent_instance;
+
+  GrexInflator *inflator;
+  GObject *target;
+  GrexFragment *fragment;
+  GrexInflationFlags flags;
+
+  // Compiled once the task starts, and kept for its entire lifetime so the
+  // frames' instructions stay valid.
+  GrexFragmentProgram *program;
+
+  gboolean started;
+  gboolean finished;
+  gboolean cancelled;
+
+  gboolean in_step;
+  gboolean cancel_requested;
+
+  // Stack of HostFrame, innermost last.
+  GPtrArray *frames;
+  // Every host whose inflation was begun, in order. Their inflations are
+  // deferred, so nothing reaches the target tree until they're all committed
+  // once the entire tree is done.
+  GPtrArray *deferred_hosts;
+};
+
+enum {
+  PROP_INFLATOR = 1,
+  PROP_TARGET,
+  PROP_FRAGMENT,
+  PROP_FLAGS,
+  N_PROPS,
+};
+
+static GParamSpec *properties[N_PROPS] = {NULL};
+
+G_DEFINE_TYPE(GrexInflationTask, grex_inflation_task, G_TYPE_OBJECT)
+
+static void
+grex_inflation_task_dispose(GObject *object) {
+  GrexInflationTask *task = GREX_INFLATION_TASK(object);
+
+  // Don't leave any hosts stuck in the middle of an inflation.
+  grex_inflation_task_cancel(task);
+
+  g_clear_object(&task->inflator);
+  g_clear_object(&task->target);
+  g_clear_object(&task->fragment);
+}
+
+static void
+grex_inflation_task_finalize(GObject *object) {
+  GrexInflationTask *task = GREX_INFLATION_TASK(object);
+
+  g_clear_pointer(&task->frames, g_ptr_array_unref);
+  g_clear_pointer(&task->deferred_hosts, g_ptr_array_unref);
+  g_clear_pointer(&task->program, grex_fragment_program_unref);
+}
+
+static void
+grex_inflation_task_class_init(GrexInflationTaskClass *klass) {
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+  object_class->dispose = grex_inflation_task_dispose;
+  object_class->finalize = grex_inflation_task_finalize;
+
+  gpropz_class_init_property_functions(object_class);
+
+  properties[PROP_INFLATOR] = g_param_spec_object(
+      "inflator", "Inflator", "The inflator used to inflate the target.",
+      GREX_TYPE_INFLATOR, G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  gpropz_install_property(object_class, GrexInflationTask, inflator,
+                          PROP_INFLATOR, properties[PROP_INFLATOR], NULL);
+
+  properties[PROP_TARGET] = g_param_spec_object(
+      "target", "Target object", "The object to inflate the fragment into.",
+      G_TYPE_OBJECT, G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  gpropz_install_property(object_class, GrexInflationTask, target, PROP_TARGET,
+                          properties[PROP_TARGET], NULL);
+
+  properties[PROP_FRAGMENT] = g_param_spec_object(
+      "fragment", "Fragment", "The fragment to inflate.", GREX_TYPE_FRAGMENT,
+      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  gpropz_install_property(object_class, GrexInflationTask, fragment,
+                          PROP_FRAGMENT, properties[PROP_FRAGMENT], NULL);
+
+  properties[PROP_FLAGS] = g_param_spec_flags(
+      "flags", "Flags", "The flags to inflate with.",
+      GREX_TYPE_INFLATION_FLAGS, GREX_INFLATION_NONE,
+      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  gpropz_install_property(object_class, GrexInflationTask, flags, PROP_FLAGS,
+                          properties[PROP_FLAGS], NULL);
+}
+
+static void
+grex_inflation_task_init(GrexInflationTask *task) {
+  task->frames =
+      g_ptr_array_new_with_free_func((GDestroyNotify)host_frame_free);
+  task->deferred_hosts = g_ptr_array_new_with_free_func(g_object_unref);
+}
+
+/**
+ * grex_inflation_task_new:
+ * @inflator: The inflator to inflate with.
+ * @target: The object to inflate the fragment into.
+ * @fragment: The fragment to inflate.
+ * @flags: The flags to inflate with.
+ *
+ * Creates a new task that inflates the fragment into the target in multiple
+ * steps, so a large tree can be spread out over several main loop iterations
+ * via grex_inflation_task_step(). The end result is the same as that of
+ * grex_inflator_inflate_existing_target().
+ *
+ * Returns: (transfer full): The new task.
+ */
+GrexInflationTask *
+grex_inflation_task_new(GrexInflator *inflator, GObject *target,
+                        GrexFragment *fragment, GrexInflationFlags flags) {
+  return g_object_new(GREX_TYPE_INFLATION_TASK, "inflator", inflator, "target",
+                      target, "fragment", fragment, "flags", flags, NULL);
+}
+
+/**
+ * grex_inflation_task_get_inflator:
+ *
+ * Returns the task's inflator.
+ *
+ * Returns: (transfer none): The inflator.
+ */
+GPROPZ_DEFINE_RO(GrexInflator *, GrexInflationTask, grex_inflation_task,
+                 inflator, properties[PROP_INFLATOR])
+
+/**
+ * grex_inflation_task_get_target:
+ *
+ * Returns the task's target.
+ *
+ * Returns: (transfer none): The target.
+ */
+GPROPZ_DEFINE_RO(GObject *, GrexInflationTask, grex_inflation_task, target,
+                 properties[PROP_TARGET])
+
+/**
+ * grex_inflation_task_get_fragment:
+ *
+ * Returns the task's fragment.
+ *
+ * Returns: (transfer none): The fragment.
+ */
+GPROPZ_DEFINE_RO(GrexFragment *, GrexInflationTask, grex_inflation_task,
+                 fragment, properties[PROP_FRAGMENT])
+
+/**
+ * grex_inflation_task_get_flags:
+ *
+ * Returns the flags the task inflates with.
+ *
+ * Returns: The flags.
+ */
+GPROPZ_DEFINE_RO(GrexInflationFlags, GrexInflationTask, grex_inflation_task,
+                 flags, properties[PROP_FLAGS])
+
+// Begins inflating the fragment into the target, pushing a new frame for its
+// children if it needs any work at all. Otherwise, it's added to the parent
+// right away.
+static void
+push_target(GrexInflationTask *task, GrexFragmentHost *parent, GrexKey *key,
+            GObject *target, const GrexFragmentInstruction *node) {
+  g_autoptr(GrexFragmentHost) host =
+      grex_inflator_ensure_host(target, node->fragment);
+  if (host == NULL) {
+    return;
+  }
+
+  if (!grex_inflator_prepare_host(task->inflator, host, node, task->flags)) {
+    if (parent != NULL) {
+      grex_fragment_host_add_inflated_child(parent, key, target);
+    }
+
+    return;
+  }
+
+  grex_inflator_begin_host_inflation(task->inflator, host, node, task->flags);
+
+  HostFrame *frame = g_new0(HostFrame, 1);
+  frame->host = g_steal_pointer(&host);
+  frame->target = g_object_ref(target);
+  frame->node = node;
+  frame->next_child = node + node->children_offset;
+  frame->parent = parent != NULL ? g_object_ref(parent) : NULL;
+  frame->key = key != NULL ? grex_key_ref(key) : NULL;
+  frame->computed_scope = grex_inflator_ref_computed_scope(task->inflator);
+  g_ptr_array_add(task->frames, frame);
+}
+
+// Performs a single unit of work: either starting on the next child of the
+// innermost host, or finishing that host once it has no children left.
+static void
+process_next(GrexInflationTask *task) {
+  HostFrame *frame = g_ptr_array_index(task->frames, task->frames->len - 1);
+
+  if (frame->next_child->op != GREX_FRAGMENT_OP_ENTER) {
+    if (frame->parent != NULL) {
+      grex_fragment_host_add_inflated_child(frame->parent, frame->key,
+                                            frame->target);
+    }
+
+    g_ptr_array_remove_index(task->frames, task->frames->len - 1);
+    return;
+  }
+
+  const GrexFragmentInstruction *child = frame->next_child;
+  frame->next_child += child->length + 1;
+
+  grex_inflator_set_computed_scope(task->inflator, frame->computed_scope);
+
+  g_autoptr(GrexKey) key =
+      grex_key_new_int(GREX_PRIVATE_KEY_NAMESPACE, frame->next_index++);
+
+  // Structural directives inflate their children themselves, so the whole
+  // child has to be done in one go.
+  if (child->has_structural) {
+    grex_inflator_inflate_child_node(task->inflator, frame->host, key, child,
+                                     task->flags, GREX_CHILD_INFLATION_NONE);
+    return;
+  }
+
+  g_autoptr(GObject) child_object =
+      grex_inflator_create_child_target(frame->host, key, child->fragment);
+
+  push_target(task, frame->host, key, child_object, child);
+}
+
+static void
+commit_deferred_hosts(GrexInflationTask *task) {
+  // Children are begun after their parents, so going backwards commits
+  // bottom-up, same as a regular inflation.
+  for (guint i = task->deferred_hosts->len; i > 0; i--) {
+    grex_inflator_commit_deferred_host(
+        g_ptr_array_index(task->deferred_hosts, i - 1));
+  }
+
+  g_ptr_array_set_size(task->deferred_hosts, 0);
+}
+
+/**
+ * grex_inflation_task_step:
+ * @budget_us: The time in microseconds this step may take, or -1 to run the
+ *             task to completion.
+ *
+ * Continues the inflation until either it's done or the budget is used up.
+ * The budget is only checked between individual hosts, so a step may run
+ * slightly over it (and a child with a structural directive is always inflated
+ * in one go).
+ *
+ * Nothing is applied to the target tree until the last step, which commits
+ * the entire tree at once: until then, the tree keeps showing the previous
+ * inflation, with no new properties, signal handlers, or children.
+ *
+ * Returns: %TRUE if the task is finished (or was cancelled).
+ */
+gboolean
+grex_inflation_task_step(GrexInflationTask *task, gint64 budget_us) {
+  g_return_val_if_fail(!task->in_step, FALSE);
+
+  if (task->finished) {
+    return TRUE;
+  }
+
+  gint64 deadline =
+      budget_us < 0 ? G_MAXINT64 : g_get_monotonic_time() + budget_us;
+
+  task->in_step = TRUE;
+
+  // Frames switch between computed scopes as they go, so restore the caller's
+  // afterwards.
+  g_autoptr(GrexComputedScope) outer_scope =
+      grex_inflator_ref_computed_scope(task->inflator);
+  g_autoptr(GPtrArray) outer_deferred_hosts =
+      grex_inflator_ref_deferred_hosts(task->inflator);
+  grex_inflator_set_deferred_hosts(task->inflator, task->deferred_hosts);
+
+  if (!task->started) {
+    task->started = TRUE;
+    task->program =
+        grex_fragment_program_ref(grex_fragment_get_program(task->fragment));
+    push_target(task, NULL, NULL, task->target,
+                grex_fragment_program_get_root(task->program));
+  }
+
+  // Always make some progress, even if the budget is tiny.
+  while (task->frames->len > 0 && !task->cancel_requested) {
+    process_next(task);
+    if (g_get_monotonic_time() >= deadline) {
+      break;
+    }
+  }
+
+  grex_inflator_set_computed_scope(task->inflator, outer_scope);
+  grex_inflator_set_deferred_hosts(task->inflator, outer_deferred_hosts);
+  task->in_step = FALSE;
+
+  if (task->cancel_requested) {
+    grex_inflation_task_cancel(task);
+  } else if (task->frames->len == 0) {
+    commit_deferred_hosts(task);
+    task->finished = TRUE;
+  }
+
+  return task->finished;
+}
+
+/**
+ * grex_inflation_task_cancel:
+ *
+ * Cancels the task, aborting the inflations of any hosts it has started on
+ * (see grex_fragment_host_abort_inflation()). Since nothing was applied yet,
+ * the target tree is left exactly as the previous inflation left it. The
+ * aborted hosts are marked dirty, so a new task can pick up where this one left
+ * off. If called during a step (e.g. from a property notification), the task
+ * is cancelled once the current unit of work is done.
+ */
+void
+grex_inflation_task_cancel(GrexInflationTask *task) {
+  if (task->finished) {
+    return;
+  }
+
+  if (task->in_step) {
+    task->cancel_requested = TRUE;
+    return;
+  }
+
+  g_ptr_array_set_size(task->frames, 0);
+
+  // Unwind in the reverse order everything was started in.
+  for (guint i = task->deferred_hosts->len; i > 0; i--) {
+    grex_inflator_abort_host_inflation(
+        g_ptr_array_index(task->deferred_hosts, i - 1));
+  }
+  g_ptr_array_set_size(task->deferred_hosts, 0);
+
+  task->finished = TRUE;
+  task->cancelled = TRUE;
+}
+
+/**
+ * grex_inflation_task_is_finished:
+ *
+ * Checks if the task is finished, either because the inflation is complete or
+ * because it was cancelled.
+ *
+ * Returns: %TRUE if the task is finished.
+ */
+gboolean
+grex_inflation_task_is_finished(GrexInflationTask *task) {
+  return task->finished;
+}
+
+/**
+ * grex_inflation_task_is_cancelled:
+ *
+ * Checks if the task was cancelled.
+ *
+ * Returns: %TRUE if the task was cancelled.
+ */
+gboolean
+grex_inflation_task_is_cancelled(GrexInflationTask *task) {
+  return task->cancelled;
+}
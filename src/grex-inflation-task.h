@@ -0,0 +1,33 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "grex-config.h"
+#include "grex-fragment.h"
+#include "grex-inflator.h"
+
+G_BEGIN_DECLS
+
+#define GREX_TYPE_INFLATION_TASK grex_inflation_task_get_type()
+G_DECLARE_FINAL_TYPE(GrexInflationTask, grex_inflation_task, GREX,
+                     INFLATION_TASK, GObject)
+
+GrexInflationTask *grex_inflation_task_new(GrexInflator *inflator,
+                                           GObject *target,
+                                           GrexFragment *fragment,
+                                           GrexInflationFlags flags);
+
+GrexInflator *grex_inflation_task_get_inflator(GrexInflationTask *task);
+GObject *grex_inflation_task_get_target(GrexInflationTask *task);
+GrexFragment *grex_inflation_task_get_fragment(GrexInflationTask *task);
+GrexInflationFlags grex_inflation_task_get_flags(GrexInflationTask *task);
+
+gboolean grex_inflation_task_step(GrexInflationTask *task, gint64 budget_us);
+void grex_inflation_task_cancel(GrexInflationTask *task);
+
+gboolean grex_inflation_task_is_finished(GrexInflationTask *task);
+gboolean grex_inflation_task_is_cancelled(GrexInflationTask *task);
+
+G_END_DECLS
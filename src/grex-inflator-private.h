@@ -0,0 +1,48 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "grex-config.h"
+#include "grex-expression-context-private.h"
+#include "grex-fragment-private.h"
+#include "grex-inflator.h"
+
+#ifndef _GREX_INTERNAL
+#error "This is internal stuff, you shouldn't be here!"
+#endif
+
+void grex_inflator_reapply_binding(GrexInflator *inflator,
+                                   GrexDependencyOwner *owner);
+
+GObject *grex_inflator_create_child_target(GrexFragmentHost *parent,
+                                           GrexKey *key,
+                                           GrexFragment *fragment);
+GrexFragmentHost *grex_inflator_ensure_host(GObject *target,
+                                            GrexFragment *fragment);
+gboolean grex_inflator_prepare_host(GrexInflator *inflator,
+                                    GrexFragmentHost *host,
+                                    const GrexFragmentInstruction *node,
+                                    GrexInflationFlags flags);
+
+GrexComputedScope *grex_inflator_ref_computed_scope(GrexInflator *inflator);
+void grex_inflator_set_computed_scope(GrexInflator *inflator,
+                                      GrexComputedScope *scope);
+
+GPtrArray *grex_inflator_ref_deferred_hosts(GrexInflator *inflator);
+void grex_inflator_set_deferred_hosts(GrexInflator *inflator, GPtrArray *hosts);
+
+void grex_inflator_begin_host_inflation(GrexInflator *inflator,
+                                        GrexFragmentHost *host,
+                                        const GrexFragmentInstruction *node,
+                                        GrexInflationFlags flags);
+void grex_inflator_commit_host_inflation(GrexFragmentHost *host);
+void grex_inflator_commit_deferred_host(GrexFragmentHost *host);
+void grex_inflator_abort_host_inflation(GrexFragmentHost *host);
+
+void grex_inflator_inflate_child_node(GrexInflator *inflator,
+                                      GrexFragmentHost *parent, GrexKey *key,
+                                      const GrexFragmentInstruction *child,
+                                      GrexInflationFlags flags,
+                                      GrexChildInflationFlags child_flags);
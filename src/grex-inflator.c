@@ -6,10 +6,39 @@
 
 #include "gpropz.h"
 #include "grex-binding-closure-private.h"
+#include "grex-expression-context-private.h"
+#include "grex-fragment-host-private.h"
 #include "grex-fragment-host.h"
+#include "grex-fragment-private.h"
+#include "grex-inflator-private.h"
 #include "grex-key-private.h"
 #include "grex-structural-directive.h"
 
+G_DEFINE_QUARK("grex-inflator-binding-owners", grex_inflator_binding_owners)
+#define GREX_INFLATOR_BINDING_OWNERS (grex_inflator_binding_owners_quark())
+
+G_DEFINE_QUARK("grex-inflator-constant-bindings",
+               grex_inflator_constant_bindings)
+#define GREX_INFLATOR_CONSTANT_BINDINGS \
+  (grex_inflator_constant_bindings_quark())
+
+G_DEFINE_QUARK("grex-inflator-static-fragment", grex_inflator_static_fragment)
+#define GREX_INFLATOR_STATIC_FRAGMENT (grex_inflator_static_fragment_quark())
+
+G_DEFINE_QUARK("grex-inflator-let-scope", grex_inflator_let_scope)
+#define GREX_INFLATOR_LET_SCOPE (grex_inflator_let_scope_quark())
+
+G_DEFINE_QUARK("grex-inflator-computed-scope", grex_inflator_computed_scope)
+#define GREX_INFLATOR_COMPUTED_SCOPE (grex_inflator_computed_scope_quark())
+
+G_DEFINE_QUARK("grex-inflator-deferred-commit", grex_inflator_deferred_commit)
+#define GREX_INFLATOR_DEFERRED_COMMIT (grex_inflator_deferred_commit_quark())
+
+G_DEFINE_QUARK("grex-inflator-compiled-fragment",
+               grex_inflator_compiled_fragment)
+#define GREX_INFLATOR_COMPILED_FRAGMENT \
+  (grex_inflator_compiled_fragment_quark())
+
 #define g_object_ref0(obj) \
   ({                       \
     if (obj != NULL) {     \
@@ -25,6 +54,14 @@ struct _GrexInflator {
 
   GHashTable *directive_factories;
   GPtrArray *auto_directive_names;
+
+  // The computed values visible to the bindings currently being applied.
+  GrexComputedScope *computed_scope;
+
+  // If set, the hosts whose inflations are begun get deferred inflations, and
+  // are collected here in the order they were begun instead of being committed
+  // as they finish.
+  GPtrArray *deferred_hosts;
 };
 
 enum {
@@ -42,6 +79,8 @@ grex_inflator_finalize(GObject *object) {
 
   g_clear_pointer(&inflator->auto_directive_names, g_ptr_array_unref);
   g_clear_pointer(&inflator->directive_factories, g_hash_table_unref);
+  g_clear_pointer(&inflator->computed_scope, grex_computed_scope_unref);
+  g_clear_pointer(&inflator->deferred_hosts, g_ptr_array_unref);
 }
 
 static void
@@ -176,118 +215,458 @@ grex_inflator_add_directivesv(GrexInflator *inflator,
   }
 }
 
-static inline gboolean
-is_property_directive(const char *name) {
-  return g_ascii_isupper(name[0]);
-}
+static void grex_inflator_inflate_node(GrexInflator *inflator,
+                                       GObject *target,
+                                       const GrexFragmentInstruction *node,
+                                       GrexInflationFlags flags);
+
+// A function generated by grex-compile, registered via
+// grex_inflator_register_compiled_fragment().
+typedef struct {
+  GrexCompiledInflateFunc func;
+  // The serial of the fragment's program at the time it was registered. Once
+  // any fragment in its tree is modified, the function might be out of date,
+  // so it's ignored from then on.
+  gint serial;
+} CompiledFragment;
+
+// A fragment's binding target, resolved once for the code generated by
+// grex-compile.
+struct _GrexCompiledTarget {
+  grefcount rc;
+  GrexBindingTarget target;
+};
 
-static inline const char *
-parse_structural_directive_name(const char *name) {
-  if (name[0] == '_' && g_ascii_isupper(name[1])) {
-    return name + 1;
-  } else {
-    return NULL;
-  }
-}
+G_DEFINE_BOXED_TYPE(GrexCompiledTarget, grex_compiled_target,
+                    grex_compiled_target_ref, grex_compiled_target_unref)
+
+// The state needed to push a two-way binding's value back into the scope.
+typedef struct {
+  GrexValueHolder *value_holder;
+  GrexExpressionContext *context;
+} PushData;
 
 static void
 on_notify_property_changed(GObject *object, GParamSpec *pspec,
                            gpointer user_data) {
-  GrexValueHolder *value_holder = user_data;
-  g_return_if_fail(grex_value_holder_can_push(value_holder));
+  PushData *data = user_data;
+  g_return_if_fail(grex_value_holder_can_push(data->value_holder));
 
   g_auto(GValue) current_value = G_VALUE_INIT;
   g_value_init(&current_value, pspec->value_type);
   g_object_get_property(object, pspec->name, &current_value);
-  grex_value_holder_push(value_holder, &current_value);
+
+  // This is a response to user input, so it shouldn't wait behind any
+  // background updates.
+  grex_expression_context_push_change_priority(data->context,
+                                               GREX_CHANGE_PRIORITY_HIGH);
+  grex_value_holder_push(data->value_holder, &current_value);
+  grex_expression_context_pop_change_priority(data->context);
 }
 
 static void
-destroy_notify_data(gpointer value_holder, GClosure *closure) {
-  grex_value_holder_unref(value_holder);
+destroy_notify_data(gpointer user_data, GClosure *closure) {
+  PushData *data = user_data;
+  g_clear_pointer(&data->value_holder, grex_value_holder_unref);
+  g_clear_object(&data->context);
+  g_free(data);
 }
 
+// The state needed to react to a change in one of a binding's dependencies,
+// owned by the binding's GrexDependencyOwner.
+typedef struct {
+  GWeakRef host;
+  char *name;
+  GrexBinding *binding;
+  // What the binding applies to, for re-applying it without any lookups. Unset
+  // for directive inputs.
+  GrexBindingTarget target;
+  // Directive inputs can't be re-applied on their own, so instead of
+  // re-applying the binding, a change marks the host as dirty.
+  gboolean is_directive_input;
+} InflatedBinding;
+
 static void
-grex_inflator_apply_binding(GrexInflator *inflator, GrexFragmentHost *host,
-                            const char *name, GrexBinding *binding,
-                            gboolean track_dependencies) {
-  g_autoptr(GError) error = NULL;
+inflated_binding_free(InflatedBinding *data) {
+  g_weak_ref_clear(&data->host);
+  g_clear_pointer(&data->name, g_free);
+  g_clear_object(&data->binding);
+  grex_binding_target_clear(&data->target);
+  g_free(data);
+}
 
-  GObjectClass *target_class =
-      G_OBJECT_GET_CLASS(grex_fragment_host_get_target(host));
-  GParamSpec *pspec = g_object_class_find_property(target_class, name);
-  if (pspec == NULL) {
-    if (g_str_has_prefix(name, "on.")) {
-      // It might be a signal instead.
-      const char *signal_name = strchr(name, '.') + 1;
-
-      GType type = G_OBJECT_CLASS_TYPE(target_class);
-      guint signal_id = g_signal_lookup(signal_name, type);
-      if (signal_id == 0) {
-        GrexSourceLocation *location = grex_binding_get_location(binding);
-        g_autofree char *location_string =
-            grex_source_location_format(location);
-        g_warning("%s: Invalid signal '%s'", location_string, signal_name);
-      } else {
-        GClosure *closure =
-            grex_binding_closure_create(binding, inflator->context);
+static void
+release_binding_owner(GrexDependencyOwner *owner) {
+  grex_dependency_owner_reset(owner);
+  grex_dependency_owner_unref(owner);
+}
 
-        g_autoptr(GrexKey) key =
-            grex_key_new_string(GREX_PRIVATE_KEY_NAMESPACE, name);
-        grex_fragment_host_add_signal(host, key, signal_name, closure, FALSE);
-      }
-    } else {
-      GrexSourceLocation *location = grex_binding_get_location(binding);
-      g_autofree char *location_string = grex_source_location_format(location);
-      g_warning("%s: Invalid property '%s'", location_string, name);
-    }
+// The owners of the bindings applied to a host, stored on the host while
+// dependencies are being tracked per binding.
+typedef struct {
+  // The owners claimed by the most recent inflation.
+  GHashTable *current;
+  // The owners from the previous inflation that haven't been claimed again by
+  // the current one, released once it's done.
+  GHashTable *leftovers;
+} BindingOwners;
+
+static GHashTable *
+binding_owner_table_new() {
+  return g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                               (GDestroyNotify)release_binding_owner);
+}
+
+static void
+binding_owners_free(BindingOwners *owners) {
+  g_clear_pointer(&owners->current, g_hash_table_unref);
+  g_clear_pointer(&owners->leftovers, g_hash_table_unref);
+  g_free(owners);
+}
+
+static void
+begin_claiming_binding_owners(GrexFragmentHost *host,
+                              GrexInflationFlags flags) {
+  if (!(flags & GREX_INFLATION_TRACK_DEPENDENCIES) ||
+      !(flags & GREX_INFLATION_TRACK_PER_BINDING)) {
+    // Release any owners left over from older inflations.
+    g_object_set_qdata(G_OBJECT(host), GREX_INFLATOR_BINDING_OWNERS, NULL);
+    return;
+  }
+
+  BindingOwners *owners =
+      g_object_get_qdata(G_OBJECT(host), GREX_INFLATOR_BINDING_OWNERS);
+  if (owners == NULL) {
+    owners = g_new0(BindingOwners, 1);
+    owners->current = binding_owner_table_new();
+    owners->leftovers = binding_owner_table_new();
+    g_object_set_qdata_full(G_OBJECT(host), GREX_INFLATOR_BINDING_OWNERS,
+                            owners, (GDestroyNotify)binding_owners_free);
+  }
+
+  // Same as IncrementalTableDiff: the leftovers are always empty between
+  // inflations, so they can be reused as the new current table.
+  GHashTable *leftovers = owners->leftovers;
+  owners->leftovers = owners->current;
+  owners->current = leftovers;
+}
 
+static void
+finish_claiming_binding_owners(GrexFragmentHost *host) {
+  BindingOwners *owners =
+      g_object_get_qdata(G_OBJECT(host), GREX_INFLATOR_BINDING_OWNERS);
+  if (owners != NULL) {
+    g_hash_table_remove_all(owners->leftovers);
+  }
+}
+
+static void
+abort_claiming_binding_owners(GrexFragmentHost *host) {
+  BindingOwners *owners =
+      g_object_get_qdata(G_OBJECT(host), GREX_INFLATOR_BINDING_OWNERS);
+  if (owners == NULL) {
     return;
   }
 
+  // The bindings that weren't reached yet are still applied, so their owners
+  // need to stay around.
+  GHashTableIter iter;
+  gpointer name, owner;
+  g_hash_table_iter_init(&iter, owners->leftovers);
+  while (g_hash_table_iter_next(&iter, &name, &owner)) {
+    g_hash_table_iter_steal(&iter);
+    g_hash_table_insert(owners->current, name, owner);
+  }
+}
+
+// Claims the owner tracking the dependencies of the binding with the given
+// name. For bindings applied directly to the host's target, the target is
+// given, and NULL for directive inputs.
+static GrexDependencyOwner *
+claim_binding_owner(GrexFragmentHost *host, const char *name,
+                    GrexBinding *binding, const GrexBindingTarget *target) {
+  BindingOwners *owners =
+      g_object_get_qdata(G_OBJECT(host), GREX_INFLATOR_BINDING_OWNERS);
+  if (owners == NULL) {
+    return NULL;
+  }
+
+  GrexDependencyOwner *owner = g_hash_table_lookup(owners->current, name);
+  if (owner != NULL) {
+    return owner;
+  }
+
+  gpointer owner_name = NULL;
+  if (g_hash_table_steal_extended(owners->leftovers, name, &owner_name,
+                                  (gpointer *)&owner)) {
+    // Keep the same owner across inflations, so any invalidations that were
+    // already queued for it stay valid.
+    InflatedBinding *data = grex_dependency_owner_get_data(owner);
+    g_set_object(&data->binding, binding);
+  } else {
+    InflatedBinding *data = g_new0(InflatedBinding, 1);
+    g_weak_ref_init(&data->host, host);
+    data->name = g_strdup(name);
+    data->binding = g_object_ref(binding);
+    data->is_directive_input = target == NULL;
+    if (target != NULL) {
+      grex_binding_target_copy(&data->target, target);
+    }
+
+    owner_name = g_strdup(name);
+    owner =
+        grex_dependency_owner_new(data, (GDestroyNotify)inflated_binding_free);
+  }
+
+  g_hash_table_insert(owners->current, owner_name, owner);
+  return owner;
+}
+
+static GrexValueHolder *
+grex_inflator_evaluate_binding(GrexInflator *inflator, GParamSpec *pspec,
+                               GrexBinding *binding,
+                               gboolean track_dependencies,
+                               GrexDependencyOwner *owner) {
+  g_autoptr(GError) error = NULL;
+
+  if (inflator->computed_scope != NULL) {
+    grex_expression_context_push_computed_scope(inflator->context,
+                                                inflator->computed_scope);
+  }
+
+  if (owner != NULL) {
+    grex_expression_context_push_dependency_owner(inflator->context, owner);
+  }
+
   g_autoptr(GrexValueHolder) result =
       grex_binding_evaluate(binding, pspec->value_type, inflator->context,
                             track_dependencies, &error);
+
+  if (owner != NULL) {
+    grex_expression_context_pop_dependency_owner(inflator->context);
+  }
+
+  if (inflator->computed_scope != NULL) {
+    grex_expression_context_pop_computed_scope(inflator->context);
+  }
+
   if (result == NULL) {
     GrexSourceLocation *location = grex_binding_get_location(binding);
     g_autofree char *location_string = grex_source_location_format(location);
     g_warning("%s: Failed to evaluate binding: %s", location_string,
               error->message);
+    return NULL;
+  }
+
+  return g_steal_pointer(&result);
+}
+
+static GClosure *
+create_push_closure(GrexInflator *inflator, GrexValueHolder *result) {
+  PushData *data = g_new0(PushData, 1);
+  data->value_holder = grex_value_holder_ref(result);
+  data->context = g_object_ref(inflator->context);
+  return g_cclosure_new(G_CALLBACK(on_notify_property_changed), data,
+                        destroy_notify_data);
+}
+
+// Applies a binding to the target it was resolved to. If the target couldn't
+// be resolved, the binding is invalid, so only a warning is emitted.
+static void
+grex_inflator_apply_resolved_binding(GrexInflator *inflator,
+                                     GrexFragmentHost *host,
+                                     const GrexBindingTarget *target,
+                                     GrexBinding *binding,
+                                     gboolean track_dependencies,
+                                     GrexDependencyOwner *owner) {
+  if (target->pspec == NULL) {
+    if (target->signal_id != 0) {
+      GClosure *closure =
+          grex_binding_closure_create(binding, inflator->context);
+      grex_fragment_host_add_resolved_signal(host, target->key,
+                                             target->signal_id,
+                                             target->signal_detail, closure,
+                                             FALSE);
+    } else {
+      GrexSourceLocation *location = grex_binding_get_location(binding);
+      g_autofree char *location_string = grex_source_location_format(location);
+      if (g_str_has_prefix(target->name, "on.")) {
+        g_warning("%s: Invalid signal '%s'", location_string,
+                  target->name + strlen("on."));
+      } else {
+        g_warning("%s: Invalid property '%s'", location_string, target->name);
+      }
+    }
+
     return;
   }
 
-  grex_fragment_host_add_property(host, name, result);
+  g_autoptr(GrexValueHolder) result = grex_inflator_evaluate_binding(
+      inflator, target->pspec, binding, track_dependencies, owner);
+  if (result == NULL) {
+    return;
+  }
+
+  grex_fragment_host_add_resolved_property(host, target->key, target->pspec,
+                                           result);
 
   if (grex_value_holder_can_push(result)) {
-    g_autofree char *notify = g_strdup_printf("notify::%s", name);
     // NOTE: No autoptr, because GClosure is floating by default.
-    GClosure *closure =
-        g_cclosure_new(G_CALLBACK(on_notify_property_changed),
-                       grex_value_holder_ref(result), destroy_notify_data);
+    GClosure *closure = create_push_closure(inflator, result);
+    grex_fragment_host_add_resolved_signal(host, target->notify_key,
+                                           target->signal_id,
+                                           target->signal_detail, closure,
+                                           FALSE);
+  }
+}
+
+static void
+grex_inflator_apply_binding(GrexInflator *inflator, GrexFragmentHost *host,
+                            const char *name, GrexBinding *binding,
+                            gboolean track_dependencies,
+                            GrexDependencyOwner *owner) {
+  GrexBindingTarget target;
+  grex_binding_target_init(
+      &target, G_OBJECT_TYPE(grex_fragment_host_get_target(host)), name);
+  grex_inflator_apply_resolved_binding(inflator, host, &target, binding,
+                                       track_dependencies, owner);
+  grex_binding_target_clear(&target);
+}
+
+// Re-evaluates a single binding tracked via GREX_INFLATION_TRACK_PER_BINDING
+// and assigns the result to its property, without inflating anything else. If
+// the binding is a directive input, its host is marked dirty instead, to be
+// picked up by an inflation with GREX_INFLATION_ONLY_DIRTY.
+void
+grex_inflator_reapply_binding(GrexInflator *inflator,
+                              GrexDependencyOwner *owner) {
+  InflatedBinding *data = grex_dependency_owner_get_data(owner);
+
+  g_autoptr(GrexFragmentHost) host = g_weak_ref_get(&data->host);
+  if (host == NULL) {
+    return;
+  }
+
+  // If the binding was removed by a later inflation, the owner is stale.
+  BindingOwners *owners =
+      g_object_get_qdata(G_OBJECT(host), GREX_INFLATOR_BINDING_OWNERS);
+  if (owners == NULL ||
+      g_hash_table_lookup(owners->current, data->name) != owner) {
+    return;
+  }
+
+  if (data->is_directive_input) {
+    grex_fragment_host_mark_dirty(host);
+    return;
+  }
+
+  GrexBindingTarget *target = &data->target;
+  if (target->pspec == NULL) {
+    return;
+  }
+
+  // Evaluate it with the same computed values as the inflation that applied
+  // it.
+  g_autoptr(GrexComputedScope) outer_scope =
+      grex_inflator_ref_computed_scope(inflator);
+  grex_inflator_set_computed_scope(
+      inflator,
+      g_object_get_qdata(G_OBJECT(host), GREX_INFLATOR_COMPUTED_SCOPE));
+
+  g_autoptr(GrexValueHolder) result = grex_inflator_evaluate_binding(
+      inflator, target->pspec, data->binding, TRUE, owner);
+  grex_inflator_set_computed_scope(inflator, outer_scope);
+  if (result == NULL) {
+    return;
+  }
+
+  grex_fragment_host_update_resolved_property(host, target->key, result);
+
+  if (grex_value_holder_can_push(result)) {
+    GClosure *closure = create_push_closure(inflator, result);
+    grex_fragment_host_replace_resolved_signal(host, target->notify_key,
+                                               target->signal_id,
+                                               target->signal_detail, closure,
+                                               FALSE);
+  }
+}
+
+// Keeps the property set by a constant binding if the exact same binding was
+// already applied to the host by a previous inflation. Otherwise, the binding
+// is recorded as applied, and the caller needs to actually apply it.
+static gboolean
+keep_constant_binding(GrexFragmentHost *host, GrexKey *key,
+                      GrexBinding *binding) {
+  // Maps property keys to the constant binding last applied to them.
+  GHashTable *applied =
+      g_object_get_qdata(G_OBJECT(host), GREX_INFLATOR_CONSTANT_BINDINGS);
+  if (applied == NULL) {
+    applied = g_hash_table_new_full(
+        (GHashFunc)grex_key_hash, (GEqualFunc)grex_key_equals,
+        (GDestroyNotify)grex_key_unref, g_object_unref);
+    g_object_set_qdata_full(G_OBJECT(host), GREX_INFLATOR_CONSTANT_BINDINGS,
+                            applied, (GDestroyNotify)g_hash_table_unref);
+  }
 
-    g_autoptr(GrexKey) key =
-        grex_key_new_string(GREX_PRIVATE_KEY_NAMESPACE, notify);
-    grex_fragment_host_add_signal(host, key, notify, closure, FALSE);
+  if (g_hash_table_lookup(applied, key) == binding &&
+      grex_fragment_host_keep_resolved_property(host, key)) {
+    return TRUE;
   }
+
+  g_hash_table_insert(applied, grex_key_ref(key), g_object_ref(binding));
+  return FALSE;
 }
 
+// Applies a SET, BIND or CONNECT instruction's binding to the host's target.
 static void
-grex_inflator_apply_properties(GrexInflator *inflator, GrexFragmentHost *host,
-                               GrexFragment *fragment,
-                               gboolean track_dependencies) {
-  g_autoptr(GList) targets = grex_fragment_get_binding_targets(fragment);
+grex_inflator_apply_property(GrexInflator *inflator, GrexFragmentHost *host,
+                             const GrexBindingTarget *target,
+                             GrexBinding *binding,
+                             gboolean track_dependencies) {
+  // The target was resolved on the fragment's type, so if the host's target is
+  // a subclass with the property, it has to be resolved again.
+  GrexBindingTarget subclass_target;
+  gboolean is_subclass_target = FALSE;
+  if (G_UNLIKELY(!grex_binding_target_is_resolved(target))) {
+    grex_binding_target_init(
+        &subclass_target, G_OBJECT_TYPE(grex_fragment_host_get_target(host)),
+        target->name);
+    target = &subclass_target;
+    is_subclass_target = TRUE;
+  }
 
-  for (GList *target = targets; target != NULL; target = target->next) {
-    const char *name = target->data;
-    if (is_property_directive(name) ||
-        parse_structural_directive_name(name) != NULL) {
-      // Skip it, it's a directive that is handled separately.
-      continue;
+  if (grex_binding_is_constant(binding)) {
+    // Constants have no dependencies, so there's nothing to track.
+    if (!keep_constant_binding(host, target->key, binding)) {
+      grex_inflator_apply_resolved_binding(inflator, host, target, binding,
+                                           FALSE, NULL);
     }
+  } else {
+    GrexDependencyOwner *owner = NULL;
+    if (track_dependencies) {
+      owner = claim_binding_owner(host, target->name, binding, target);
+    }
+
+    grex_inflator_apply_resolved_binding(inflator, host, target, binding,
+                                         track_dependencies, owner);
+  }
+
+  if (is_subclass_target) {
+    grex_binding_target_clear(&subclass_target);
+  }
+}
 
-    grex_inflator_apply_binding(inflator, host, name,
-                                grex_fragment_get_binding(fragment, name),
-                                track_dependencies);
+static void
+grex_inflator_apply_properties(GrexInflator *inflator, GrexFragmentHost *host,
+                               const GrexFragmentInstruction *node,
+                               gboolean track_dependencies) {
+  GREX_FRAGMENT_FOREACH_INSTRUCTION(node, instruction) {
+    if (instruction->op == GREX_FRAGMENT_OP_SET ||
+        instruction->op == GREX_FRAGMENT_OP_BIND ||
+        instruction->op == GREX_FRAGMENT_OP_CONNECT) {
+      grex_inflator_apply_property(inflator, host, &instruction->target,
+                                   instruction->binding, track_dependencies);
+    }
   }
 }
 
@@ -377,16 +756,16 @@ add_property_directive(GrexFragmentHost *host,
 static void
 grex_inflator_apply_explicit_directives(GrexInflator *inflator,
                                         GrexFragmentHost *host,
-                                        GrexFragment *fragment,
+                                        const GrexFragmentInstruction *node,
                                         GHashTable *inserted_directives,
                                         gboolean track_dependencies) {
-  g_autoptr(GList) targets = grex_fragment_get_binding_targets(fragment);
-  for (GList *target = targets; target != NULL; target = target->next) {
-    const char *name = target->data;
-    if (!is_property_directive(name)) {
+  GREX_FRAGMENT_FOREACH_INSTRUCTION(node, instruction) {
+    if (instruction->op != GREX_FRAGMENT_OP_DIRECTIVE) {
       continue;
     }
 
+    const char *name = instruction->name;
+
     GrexDirectiveFactory *factory = NULL;
     const char *property = NULL;
     if (!grex_inflator_get_directive_and_property(inflator, name, &factory,
@@ -400,15 +779,23 @@ grex_inflator_apply_explicit_directives(GrexInflator *inflator,
       continue;
     }
 
-    GrexBinding *binding = grex_fragment_get_binding(fragment, name);
+    GrexBinding *binding = instruction->binding;
 
     GrexPropertyDirective *directive = add_property_directive(
         host, GREX_PROPERTY_DIRECTIVE_FACTORY(factory), inserted_directives);
     if (property != NULL) {
       GrexFragmentHost *directive_host =
           grex_fragment_host_for_target(G_OBJECT(directive));
+
+      // A directive's updates can only be applied during an inflation, so a
+      // change to one of its inputs re-inflates the host it's attached to.
+      GrexDependencyOwner *owner = NULL;
+      if (track_dependencies) {
+        owner = claim_binding_owner(host, name, binding, NULL);
+      }
+
       grex_inflator_apply_binding(inflator, directive_host, property, binding,
-                                  track_dependencies);
+                                  track_dependencies, owner);
     }
   }
 }
@@ -456,7 +843,7 @@ grex_inflator_auto_attach_directives(GrexInflator *inflator,
             binding_builder, grex_fragment_get_location(fragment));
 
         grex_inflator_apply_binding(inflator, directive_host, "value", binding,
-                                    FALSE);
+                                    FALSE, NULL);
       }
     }
   }
@@ -476,18 +863,81 @@ commit_directives(GHashTable *inserted_directives) {
 
 static void
 grex_inflator_apply_directives(GrexInflator *inflator, GrexFragmentHost *host,
-                               GrexFragment *fragment,
+                               const GrexFragmentInstruction *node,
                                gboolean track_dependencies) {
   g_autoptr(GHashTable) inserted_directives =
       g_hash_table_new(g_str_hash, g_str_equal);
 
   grex_inflator_apply_explicit_directives(
-      inflator, host, fragment, inserted_directives, track_dependencies);
-  grex_inflator_auto_attach_directives(inflator, host, fragment,
+      inflator, host, node, inserted_directives, track_dependencies);
+  grex_inflator_auto_attach_directives(inflator, host, node->fragment,
                                        inserted_directives);
   commit_directives(inserted_directives);
 }
 
+// Re-inflates the dirty descendants of a clean host, leaving the host itself
+// untouched. Returns TRUE if the host needs a full inflation anyway.
+static gboolean
+grex_inflator_inflate_dirty_children(GrexInflator *inflator,
+                                     GrexFragmentHost *host,
+                                     const GrexFragmentInstruction *node,
+                                     GrexInflationFlags flags) {
+  if (!grex_fragment_host_is_subtree_dirty(host)) {
+    return FALSE;
+  }
+
+  // Structural directives decide which children exist and under which keys,
+  // so their children can only be found by running them again.
+  GREX_FRAGMENT_FOREACH_CHILD(node, child) {
+    if (child->has_structural) {
+      grex_fragment_host_mark_dirty(host);
+      return TRUE;
+    }
+  }
+
+  // The children see the computed values from the host's last inflation.
+  g_autoptr(GrexComputedScope) outer_scope =
+      grex_inflator_ref_computed_scope(inflator);
+  grex_inflator_set_computed_scope(
+      inflator,
+      g_object_get_qdata(G_OBJECT(host), GREX_INFLATOR_COMPUTED_SCOPE));
+
+  int i = 0;
+  GREX_FRAGMENT_FOREACH_CHILD(node, child) {
+    g_autoptr(GrexKey) key = grex_key_new_int(GREX_PRIVATE_KEY_NAMESPACE, i++);
+    GObject *child_object = grex_fragment_host_get_inflated_child(host, key);
+    if (child_object != NULL) {
+      grex_inflator_inflate_node(inflator, child_object, child, flags);
+    }
+  }
+
+  grex_inflator_set_computed_scope(inflator, outer_scope);
+  grex_fragment_host_clear_subtree_dirty(host);
+  return FALSE;
+}
+
+// Creates a new, empty object for the fragment to be inflated into. Every
+// inflation path creates its targets through here.
+static GObject *
+create_target(GrexFragment *fragment) {
+  // TODO: handle construct-only properties.
+  return g_object_new(grex_fragment_get_target_type(fragment), NULL);
+}
+
+// Returns the object the child fragment at key should be inflated into: the
+// one left over from the parent's last inflation if there is one, otherwise a
+// new one.
+GObject *
+grex_inflator_create_child_target(GrexFragmentHost *parent, GrexKey *key,
+                                  GrexFragment *fragment) {
+  GObject *leftover = grex_fragment_host_get_leftover_child(parent, key);
+  if (leftover != NULL) {
+    return g_object_ref(leftover);
+  }
+
+  return create_target(fragment);
+}
+
 /**
  * grex_inflator_inflate_new_target:
  * @fragment: (transfer none): The fragment to inflate.
@@ -499,67 +949,275 @@ grex_inflator_apply_directives(GrexInflator *inflator, GrexFragmentHost *host,
 GObject *
 grex_inflator_inflate_new_target(GrexInflator *inflator, GrexFragment *fragment,
                                  GrexInflationFlags flags) {
-  GType target_type = grex_fragment_get_target_type(fragment);
-
-  // TODO: handle construct-only properties.
-  GObject *target = g_object_new(target_type, NULL);
+  GObject *target = create_target(fragment);
   grex_inflator_inflate_existing_target(inflator, target, fragment, flags);
   return target;
 }
 
+// Inflates the fragment started by the given ENTER instruction into the
+// target, walking its instructions (and then its children's) in order.
+static void
+grex_inflator_inflate_node(GrexInflator *inflator, GObject *target,
+                           const GrexFragmentInstruction *node,
+                           GrexInflationFlags flags) {
+  g_autoptr(GrexFragmentHost) host =
+      grex_inflator_ensure_host(target, node->fragment);
+  if (host == NULL ||
+      !grex_inflator_prepare_host(inflator, host, node, flags)) {
+    return;
+  }
+
+  g_autoptr(GrexComputedScope) outer_scope =
+      grex_inflator_ref_computed_scope(inflator);
+
+  grex_inflator_begin_host_inflation(inflator, host, node, flags);
+
+  int i = 0;
+  GREX_FRAGMENT_FOREACH_CHILD(node, child) {
+    g_autoptr(GrexKey) key = grex_key_new_int(GREX_PRIVATE_KEY_NAMESPACE, i++);
+    grex_inflator_inflate_child_node(inflator, host, key, child, flags,
+                                     GREX_CHILD_INFLATION_NONE);
+  }
+
+  grex_inflator_commit_host_inflation(host);
+  grex_inflator_set_computed_scope(inflator, outer_scope);
+}
+
 /**
  * grex_inflator_inflate_existing_object:
  * @fragment: (transfer none): The fragment to inflate.
  * @target: (transfer none): The object to inflate the fragent into.
  *
  * Inflates the given fragment into the given object.
+ *
+ * If @flags contains %GREX_INFLATION_ONLY_DIRTY, only fragment hosts that were
+ * marked dirty (or were never inflated) are inflated again, and any clean hosts
+ * are left untouched.
  */
 void
 grex_inflator_inflate_existing_target(GrexInflator *inflator, GObject *target,
                                       GrexFragment *fragment,
                                       GrexInflationFlags flags) {
-  g_autoptr(GrexFragmentHost) host =
-      g_object_ref0(grex_fragment_host_for_target(target));
+  // Hold onto the program in case anything modifies a fragment meanwhile.
+  g_autoptr(GrexFragmentProgram) program =
+      grex_fragment_program_ref(grex_fragment_get_program(fragment));
+
+  CompiledFragment *compiled =
+      g_object_get_qdata(G_OBJECT(fragment), GREX_INFLATOR_COMPILED_FRAGMENT);
+  if (compiled != NULL && compiled->serial == program->serial) {
+    compiled->func(inflator, target, flags);
+    return;
+  }
+
+  grex_inflator_inflate_node(inflator, target,
+                             grex_fragment_program_get_root(program), flags);
+}
+
+// Returns the (possibly new) host for the target, or NULL if it was inflated
+// from a fragment of a different type.
+GrexFragmentHost *
+grex_inflator_ensure_host(GObject *target, GrexFragment *fragment) {
+  GrexFragmentHost *host = grex_fragment_host_for_target(target);
   if (host == NULL) {
-    host = grex_fragment_host_new(target);
+    return grex_fragment_host_new(target);
+  }
+
+  g_return_val_if_fail(
+      grex_fragment_host_matches_fragment_type(host, fragment), NULL);
+  return g_object_ref(host);
+}
+
+// Checks if the host itself needs to be inflated. Static subtrees are never
+// inflated again once they're done, and with GREX_INFLATION_ONLY_DIRTY, a clean
+// host's dirty descendants are re-inflated right away instead.
+gboolean
+grex_inflator_prepare_host(GrexInflator *inflator, GrexFragmentHost *host,
+                           const GrexFragmentInstruction *node,
+                           GrexInflationFlags flags) {
+  GrexFragment *fragment = node->fragment;
+  if (node->is_static && !grex_fragment_host_is_dirty(host) &&
+      g_object_get_qdata(G_OBJECT(host), GREX_INFLATOR_STATIC_FRAGMENT) ==
+          fragment) {
+    return FALSE;
+  }
+
+  return !(flags & GREX_INFLATION_ONLY_DIRTY) ||
+         grex_fragment_host_is_dirty(host) ||
+         grex_inflator_inflate_dirty_children(inflator, host, node, flags);
+}
+
+// Returns the computed values visible to the bindings being applied, or NULL
+// if there are none.
+GrexComputedScope *
+grex_inflator_ref_computed_scope(GrexInflator *inflator) {
+  return inflator->computed_scope != NULL
+             ? grex_computed_scope_ref(inflator->computed_scope)
+             : NULL;
+}
+
+void
+grex_inflator_set_computed_scope(GrexInflator *inflator,
+                                 GrexComputedScope *scope) {
+  if (scope != NULL) {
+    grex_computed_scope_ref(scope);
+  }
+
+  g_clear_pointer(&inflator->computed_scope, grex_computed_scope_unref);
+  inflator->computed_scope = scope;
+}
+
+// Returns the array collecting the hosts whose commits are deferred, or NULL if
+// hosts are committed as soon as they finish.
+GPtrArray *
+grex_inflator_ref_deferred_hosts(GrexInflator *inflator) {
+  return inflator->deferred_hosts != NULL
+             ? g_ptr_array_ref(inflator->deferred_hosts)
+             : NULL;
+}
+
+// Makes every host whose inflation is begun from now on get a deferred
+// inflation (see grex_fragment_host_begin_deferred_inflation) and be added to
+// the given array, instead of being committed once it's done. The hosts must
+// then be committed or aborted via grex_inflator_commit_deferred_host and
+// grex_inflator_abort_host_inflation, in the reverse of the order they were
+// added in.
+void
+grex_inflator_set_deferred_hosts(GrexInflator *inflator, GPtrArray *hosts) {
+  if (hosts != NULL) {
+    g_ptr_array_ref(hosts);
+  }
+
+  g_clear_pointer(&inflator->deferred_hosts, g_ptr_array_unref);
+  inflator->deferred_hosts = hosts;
+}
+
+// Defines the values declared via Grex.let.NAME on the fragment, which are
+// visible to the host's own bindings and to everything inflated inside it.
+// The scope is kept on the host, so the cached values survive across
+// inflations as long as their bindings stay the same.
+static void
+grex_inflator_enter_computed_scope(GrexInflator *inflator,
+                                   GrexFragmentHost *host,
+                                   const GrexFragmentInstruction *node) {
+  GrexComputedScope *scope = inflator->computed_scope;
+  GrexComputedScope *let_scope = NULL;
+
+  GREX_FRAGMENT_FOREACH_INSTRUCTION(node, instruction) {
+    if (instruction->op != GREX_FRAGMENT_OP_LET) {
+      continue;
+    }
+
+    if (let_scope == NULL) {
+      let_scope = g_object_get_qdata(G_OBJECT(host), GREX_INFLATOR_LET_SCOPE);
+      if (let_scope == NULL) {
+        let_scope = grex_computed_scope_new();
+        g_object_set_qdata_full(G_OBJECT(host), GREX_INFLATOR_LET_SCOPE,
+                                let_scope,
+                                (GDestroyNotify)grex_computed_scope_unref);
+      }
+
+      grex_computed_scope_set_parent(let_scope, scope);
+      grex_computed_scope_begin_update(let_scope);
+    }
+
+    grex_computed_scope_define(let_scope, instruction->arg,
+                               instruction->binding);
+  }
+
+  if (let_scope != NULL) {
+    grex_computed_scope_end_update(let_scope);
+    scope = let_scope;
   } else {
-    g_return_if_fail(grex_fragment_host_matches_fragment_type(host, fragment));
+    g_object_set_qdata(G_OBJECT(host), GREX_INFLATOR_LET_SCOPE, NULL);
   }
 
-  grex_fragment_host_begin_inflation(host);
+  g_object_set_qdata_full(
+      G_OBJECT(host), GREX_INFLATOR_COMPUTED_SCOPE,
+      scope != NULL ? grex_computed_scope_ref(scope) : NULL,
+      (GDestroyNotify)grex_computed_scope_unref);
+  grex_inflator_set_computed_scope(inflator, scope);
+}
+
+// Begins the host's inflation and enters its computed values, without
+// applying any bindings yet.
+static void
+grex_inflator_enter_host(GrexInflator *inflator, GrexFragmentHost *host,
+                         const GrexFragmentInstruction *node,
+                         GrexInflationFlags flags) {
+  GrexFragment *fragment = node->fragment;
+
+  // If this inflation is aborted, the host is marked dirty, so it's not
+  // skipped by mistake.
+  g_object_set_qdata_full(
+      G_OBJECT(host), GREX_INFLATOR_STATIC_FRAGMENT,
+      node->is_static ? g_object_ref(fragment) : NULL, g_object_unref);
+
+  begin_claiming_binding_owners(host, flags);
+  if (inflator->deferred_hosts != NULL) {
+    g_object_set_qdata(G_OBJECT(host), GREX_INFLATOR_DEFERRED_COMMIT,
+                       GINT_TO_POINTER(TRUE));
+    g_ptr_array_add(inflator->deferred_hosts, g_object_ref(host));
+    grex_fragment_host_begin_deferred_inflation(host);
+  } else {
+    grex_fragment_host_begin_inflation(host);
+  }
+  grex_inflator_enter_computed_scope(inflator, host, node);
+}
+
+// Begins the host's inflation and applies everything but its children, which
+// are left to the caller. The host's computed values stay current afterwards,
+// so the caller should restore the previous ones once the children are done.
+void
+grex_inflator_begin_host_inflation(GrexInflator *inflator,
+                                   GrexFragmentHost *host,
+                                   const GrexFragmentInstruction *node,
+                                   GrexInflationFlags flags) {
+  grex_inflator_enter_host(inflator, host, node, flags);
 
   gboolean track_dependencies = flags & GREX_INFLATION_TRACK_DEPENDENCIES;
-  grex_inflator_apply_properties(inflator, host, fragment, track_dependencies);
-  grex_inflator_apply_directives(inflator, host, fragment, track_dependencies);
+  grex_inflator_apply_properties(inflator, host, node, track_dependencies);
+  grex_inflator_apply_directives(inflator, host, node, track_dependencies);
+}
 
-  g_autoptr(GList) children = grex_fragment_get_children(fragment);
-  int i = 0;
-  for (GList *child = children; child != NULL; child = child->next) {
-    g_autoptr(GrexKey) key = grex_key_new_int(GREX_PRIVATE_KEY_NAMESPACE, i++);
-    grex_inflator_inflate_child(inflator, host, key, child->data, flags,
-                                GREX_CHILD_INFLATION_NONE);
+void
+grex_inflator_commit_host_inflation(GrexFragmentHost *host) {
+  // Deferred hosts are committed all at once by whoever collected them.
+  if (g_object_get_qdata(G_OBJECT(host), GREX_INFLATOR_DEFERRED_COMMIT)) {
+    return;
   }
 
   grex_fragment_host_commit_inflation(host);
+  finish_claiming_binding_owners(host);
+}
+
+void
+grex_inflator_commit_deferred_host(GrexFragmentHost *host) {
+  g_object_set_qdata(G_OBJECT(host), GREX_INFLATOR_DEFERRED_COMMIT, NULL);
+  grex_inflator_commit_host_inflation(host);
+}
+
+void
+grex_inflator_abort_host_inflation(GrexFragmentHost *host) {
+  g_object_set_qdata(G_OBJECT(host), GREX_INFLATOR_DEFERRED_COMMIT, NULL);
+  grex_fragment_host_abort_inflation(host);
+  abort_claiming_binding_owners(host);
 }
 
 static GrexStructuralDirective *
-grex_inflator_find_structural_directive_in_child(GrexInflator *inflator,
-                                                 GrexFragmentHost *parent,
-                                                 GrexKey *child_key,
-                                                 GrexFragment *child,
-                                                 gboolean track_dependencies) {
-  g_autoptr(GList) targets = grex_fragment_get_binding_targets(child);
+grex_inflator_find_structural_directive_in_child(
+    GrexInflator *inflator, GrexFragmentHost *parent, GrexKey *child_key,
+    const GrexFragmentInstruction *child, gboolean track_dependencies) {
   GrexDirectiveFactory *current_factory = NULL;
   g_autoptr(GrexStructuralDirective) directive = NULL;
 
-  for (GList *target = targets; target != NULL; target = target->next) {
-    const char *name = target->data;
-    const char *unprefixed_name = parse_structural_directive_name(name);
-    if (unprefixed_name == NULL) {
+  GREX_FRAGMENT_FOREACH_INSTRUCTION(child, instruction) {
+    if (instruction->op != GREX_FRAGMENT_OP_STRUCTURAL) {
       continue;
     }
 
+    const char *name = instruction->name;
+    const char *unprefixed_name = instruction->arg;
+
     GrexDirectiveFactory *factory = NULL;
     const char *property = NULL;
     if (!grex_inflator_get_directive_and_property(inflator, unprefixed_name,
@@ -607,9 +1265,19 @@ grex_inflator_find_structural_directive_in_child(GrexInflator *inflator,
     if (property != NULL) {
       GrexFragmentHost *directive_host =
           grex_fragment_host_for_target(G_OBJECT(directive));
-      GrexBinding *binding = grex_fragment_get_binding(child, name);
+      GrexBinding *binding = instruction->binding;
+
+      // The directive decides what gets added to the parent, so that's what
+      // needs to be re-inflated if its inputs change.
+      GrexDependencyOwner *owner = NULL;
+      if (track_dependencies) {
+        g_autofree char *key_desc = grex_key_describe(child_key);
+        g_autofree char *owner_name = g_strdup_printf("%s/%s", key_desc, name);
+        owner = claim_binding_owner(parent, owner_name, binding, NULL);
+      }
+
       grex_inflator_apply_binding(inflator, directive_host, property, binding,
-                                  track_dependencies);
+                                  track_dependencies, owner);
     }
   }
 
@@ -627,25 +1295,276 @@ grex_inflator_inflate_child(GrexInflator *inflator, GrexFragmentHost *parent,
                             GrexKey *key, GrexFragment *child,
                             GrexInflationFlags flags,
                             GrexChildInflationFlags child_flags) {
-  GObject *child_object = grex_fragment_host_get_leftover_child(parent, key);
-  if (child_object == NULL) {
-    child_object = grex_inflator_inflate_new_target(inflator, child, flags);
-  } else {
-    grex_inflator_inflate_existing_target(inflator, child_object, child, flags);
-  }
+  g_autoptr(GrexFragmentProgram) program =
+      grex_fragment_program_ref(grex_fragment_get_program(child));
+  grex_inflator_inflate_child_node(inflator, parent, key,
+                                   grex_fragment_program_get_root(program),
+                                   flags, child_flags);
+}
+
+// Same as grex_inflator_inflate_child, but for a child that's part of an
+// already compiled program.
+void
+grex_inflator_inflate_child_node(GrexInflator *inflator,
+                                 GrexFragmentHost *parent, GrexKey *key,
+                                 const GrexFragmentInstruction *child,
+                                 GrexInflationFlags flags,
+                                 GrexChildInflationFlags child_flags) {
+  g_autoptr(GObject) child_object =
+      grex_inflator_create_child_target(parent, key, child->fragment);
+
+  grex_inflator_inflate_node(inflator, child_object, child, flags);
 
   GrexStructuralDirective *directive = NULL;
   if (!(child_flags & GREX_CHILD_INFLATION_IGNORE_STRUCTURAL_DIRECTIVES) &&
+      child->has_structural &&
       (directive = grex_inflator_find_structural_directive_in_child(
            inflator, parent, key, child,
            flags & GREX_INFLATION_TRACK_DEPENDENCIES))) {
     GrexStructuralDirectiveClass *directive_class =
         GREX_STRUCTURAL_DIRECTIVE_GET_CLASS(directive);
     directive_class->apply(
-        directive, inflator, parent, key, child, flags,
+        directive, inflator, parent, key, child->fragment, flags,
         // Ignore this directive next time to avoid infinite recursion.
         child_flags | GREX_CHILD_INFLATION_IGNORE_STRUCTURAL_DIRECTIVES);
   } else {
     grex_fragment_host_add_inflated_child(parent, key, child_object);
   }
 }
+
+/**
+ * GrexCompiledInflateFunc:
+ * @inflator: The inflator.
+ * @target: The object to inflate the fragment into.
+ * @flags: The inflation flags.
+ *
+ * Inflates a specific fragment into @target, as generated by grex-compile's
+ * --c-source option.
+ */
+
+/**
+ * grex_inflator_register_compiled_fragment: (skip)
+ * @fragment: (transfer none): A root fragment.
+ * @func: The function inflating it.
+ *
+ * Makes grex_inflator_inflate_existing_target() and
+ * grex_inflator_inflate_new_target() call @func for @fragment, instead of
+ * interpreting its bindings and children one by one.
+ *
+ * This is called by the code generated by grex-compile, which was specialized
+ * for this exact fragment. If @fragment or any of its descendants are modified
+ * afterwards, @func is ignored again, since it might no longer match. Other
+ * fragment trees don't affect it.
+ */
+void
+grex_inflator_register_compiled_fragment(GrexFragment *fragment,
+                                         GrexCompiledInflateFunc func) {
+  CompiledFragment *compiled = g_new0(CompiledFragment, 1);
+  compiled->func = func;
+  compiled->serial = grex_fragment_get_program(fragment)->serial;
+  g_object_set_qdata_full(G_OBJECT(fragment), GREX_INFLATOR_COMPILED_FRAGMENT,
+                          compiled, g_free);
+}
+
+/**
+ * grex_inflator_begin_compiled_host:
+ * @target: (transfer none): The object to inflate the fragment into.
+ * @fragment: (transfer none): The fragment being inflated.
+ *
+ * Begins inflating @fragment into @target on behalf of a
+ * #GrexCompiledInflateFunc, which then applies the fragment's properties
+ * itself (via grex_inflator_add_compiled_property() and
+ * grex_inflator_apply_compiled_binding(), with targets resolved once by
+ * grex_compiled_target_new()), followed by
+ * grex_inflator_apply_compiled_directives(), any children
+ * via grex_inflator_inflate_compiled_child(), and finally
+ * grex_inflator_commit_compiled_host().
+ *
+ * The fragment must not define any computed values via Grex.let.
+ *
+ * Returns: (transfer full) (nullable): The target's host, or %NULL if it
+ *          doesn't need to be inflated.
+ */
+GrexFragmentHost *
+grex_inflator_begin_compiled_host(GrexInflator *inflator, GObject *target,
+                                  GrexFragment *fragment,
+                                  GrexInflationFlags flags) {
+  g_autoptr(GrexFragmentProgram) program =
+      grex_fragment_program_ref(grex_fragment_get_program(fragment));
+  const GrexFragmentInstruction *node = grex_fragment_program_get_root(program);
+
+  g_autoptr(GrexFragmentHost) host =
+      grex_inflator_ensure_host(target, fragment);
+  if (host == NULL ||
+      !grex_inflator_prepare_host(inflator, host, node, flags)) {
+    return NULL;
+  }
+
+  grex_inflator_enter_host(inflator, host, node, flags);
+  return g_steal_pointer(&host);
+}
+
+/**
+ * grex_compiled_target_new:
+ * @fragment: (transfer none): The fragment the binding belongs to.
+ * @name: The binding's target property or signal.
+ *
+ * Resolves the target of one of @fragment's bindings, so code generated by
+ * grex-compile can apply it on every inflation without looking it up again.
+ *
+ * Returns: (transfer full): The resolved target.
+ */
+GrexCompiledTarget *
+grex_compiled_target_new(GrexFragment *fragment, const char *name) {
+  GrexCompiledTarget *target = g_new0(GrexCompiledTarget, 1);
+  g_ref_count_init(&target->rc);
+  grex_binding_target_init(&target->target,
+                           grex_fragment_get_target_type(fragment), name);
+  return target;
+}
+
+/**
+ * grex_compiled_target_ref:
+ *
+ * Increments the target's reference count.
+ *
+ * Returns: (transfer full): The target.
+ */
+GrexCompiledTarget *
+grex_compiled_target_ref(GrexCompiledTarget *target) {
+  g_ref_count_inc(&target->rc);
+  return target;
+}
+
+/**
+ * grex_compiled_target_unref:
+ *
+ * Decrements the target's reference count, freeing it once it reaches zero.
+ */
+void
+grex_compiled_target_unref(GrexCompiledTarget *target) {
+  if (g_ref_count_dec(&target->rc)) {
+    grex_binding_target_clear(&target->target);
+    g_free(target);
+  }
+}
+
+/**
+ * grex_inflator_keep_compiled_constant:
+ * @host: The host being inflated.
+ * @target: The property the constant is assigned to.
+ * @binding: (transfer none): The constant binding that sets the property.
+ *
+ * Keeps the property set by @binding if the previous inflation already
+ * applied it, same as for any other constant binding.
+ *
+ * Returns: %TRUE if the property was kept, or %FALSE if the caller needs to
+ *          add it via grex_inflator_add_compiled_property().
+ */
+gboolean
+grex_inflator_keep_compiled_constant(GrexFragmentHost *host,
+                                     GrexCompiledTarget *target,
+                                     GrexBinding *binding) {
+  return keep_constant_binding(host, target->target.key, binding);
+}
+
+/**
+ * grex_inflator_add_compiled_property:
+ * @host: The host being inflated.
+ * @target: The property to set.
+ * @value: The property's new value.
+ *
+ * Adds a property assignment to @host, same as
+ * grex_fragment_host_add_property(), but without looking the property up by
+ * name.
+ */
+void
+grex_inflator_add_compiled_property(GrexFragmentHost *host,
+                                    GrexCompiledTarget *target,
+                                    const GValue *value) {
+  g_return_if_fail(target->target.pspec != NULL);
+
+  g_autoptr(GrexValueHolder) holder = grex_value_holder_new(value);
+  grex_fragment_host_add_resolved_property(host, target->target.key,
+                                           target->target.pspec, holder);
+}
+
+/**
+ * grex_inflator_apply_compiled_binding:
+ * @host: The host being inflated.
+ * @target: The binding's target property or signal.
+ * @binding: (transfer none): The binding to apply.
+ *
+ * Applies a binding to @host's target the same way an interpreted inflation
+ * would, including tracking its dependencies.
+ */
+void
+grex_inflator_apply_compiled_binding(GrexInflator *inflator,
+                                     GrexFragmentHost *host,
+                                     GrexCompiledTarget *target,
+                                     GrexBinding *binding,
+                                     GrexInflationFlags flags) {
+  grex_inflator_apply_property(inflator, host, &target->target, binding,
+                               flags & GREX_INFLATION_TRACK_DEPENDENCIES);
+}
+
+/**
+ * grex_inflator_apply_compiled_directives:
+ * @host: The host being inflated.
+ * @fragment: (transfer none): The fragment being inflated.
+ *
+ * Applies the property directives of @fragment, including any that are
+ * attached automatically.
+ */
+void
+grex_inflator_apply_compiled_directives(GrexInflator *inflator,
+                                        GrexFragmentHost *host,
+                                        GrexFragment *fragment,
+                                        GrexInflationFlags flags) {
+  g_autoptr(GrexFragmentProgram) program =
+      grex_fragment_program_ref(grex_fragment_get_program(fragment));
+  grex_inflator_apply_directives(inflator, host,
+                                 grex_fragment_program_get_root(program),
+                                 flags & GREX_INFLATION_TRACK_DEPENDENCIES);
+}
+
+/**
+ * grex_inflator_inflate_compiled_child:
+ * @parent: The host being inflated.
+ * @index: The child's index in its parent fragment.
+ * @child: (transfer none): The child fragment.
+ * @func: (nullable) (scope call): The function inflating the child.
+ *
+ * Inflates a child of a compiled fragment, via @func if given, or otherwise
+ * by interpreting it (e.g. for children with structural directives).
+ */
+void
+grex_inflator_inflate_compiled_child(GrexInflator *inflator,
+                                     GrexFragmentHost *parent, int index,
+                                     GrexFragment *child,
+                                     GrexCompiledInflateFunc func,
+                                     GrexInflationFlags flags) {
+  g_autoptr(GrexKey) key = grex_key_new_int(GREX_PRIVATE_KEY_NAMESPACE, index);
+  if (func == NULL) {
+    grex_inflator_inflate_child(inflator, parent, key, child, flags,
+                                GREX_CHILD_INFLATION_NONE);
+    return;
+  }
+
+  g_autoptr(GObject) child_object =
+      grex_inflator_create_child_target(parent, key, child);
+
+  func(inflator, child_object, flags);
+  grex_fragment_host_add_inflated_child(parent, key, child_object);
+}
+
+/**
+ * grex_inflator_commit_compiled_host:
+ * @host: The host being inflated.
+ *
+ * Finishes an inflation started by grex_inflator_begin_compiled_host().
+ */
+void
+grex_inflator_commit_compiled_host(GrexFragmentHost *host) {
+  grex_inflator_commit_host_inflation(host);
+}
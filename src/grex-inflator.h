@@ -19,6 +19,8 @@ typedef enum {
 typedef enum _GrexInflationFlags {
   GREX_INFLATION_NONE = 0,
   GREX_INFLATION_TRACK_DEPENDENCIES = 1 << 0,
+  GREX_INFLATION_TRACK_PER_BINDING = 1 << 1,
+  GREX_INFLATION_ONLY_DIRTY = 1 << 2,
 } GrexInflationFlags;
 
 typedef enum _GrexChildInflationFlags {
@@ -58,4 +60,49 @@ void grex_inflator_inflate_child(GrexInflator *inflator,
                                  GrexFragment *child, GrexInflationFlags flags,
                                  GrexChildInflationFlags child_flags);
 
+#define GREX_TYPE_COMPILED_TARGET grex_compiled_target_get_type()
+
+typedef struct _GrexCompiledTarget GrexCompiledTarget;
+GType grex_compiled_target_get_type();
+
+GrexCompiledTarget *grex_compiled_target_new(GrexFragment *fragment,
+                                             const char *name);
+GrexCompiledTarget *grex_compiled_target_ref(GrexCompiledTarget *target);
+void grex_compiled_target_unref(GrexCompiledTarget *target);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GrexCompiledTarget, grex_compiled_target_unref)
+
+typedef void (*GrexCompiledInflateFunc)(GrexInflator *inflator,
+                                        GObject *target,
+                                        GrexInflationFlags flags);
+
+void grex_inflator_register_compiled_fragment(GrexFragment *fragment,
+                                              GrexCompiledInflateFunc func);
+
+GrexFragmentHost *grex_inflator_begin_compiled_host(GrexInflator *inflator,
+                                                    GObject *target,
+                                                    GrexFragment *fragment,
+                                                    GrexInflationFlags flags);
+gboolean grex_inflator_keep_compiled_constant(GrexFragmentHost *host,
+                                              GrexCompiledTarget *target,
+                                              GrexBinding *binding);
+void grex_inflator_add_compiled_property(GrexFragmentHost *host,
+                                         GrexCompiledTarget *target,
+                                         const GValue *value);
+void grex_inflator_apply_compiled_binding(GrexInflator *inflator,
+                                          GrexFragmentHost *host,
+                                          GrexCompiledTarget *target,
+                                          GrexBinding *binding,
+                                          GrexInflationFlags flags);
+void grex_inflator_apply_compiled_directives(GrexInflator *inflator,
+                                             GrexFragmentHost *host,
+                                             GrexFragment *fragment,
+                                             GrexInflationFlags flags);
+void grex_inflator_inflate_compiled_child(GrexInflator *inflator,
+                                          GrexFragmentHost *parent, int index,
+                                          GrexFragment *child,
+                                          GrexCompiledInflateFunc func,
+                                          GrexInflationFlags flags);
+void grex_inflator_commit_compiled_host(GrexFragmentHost *host);
+
 G_END_DECLS
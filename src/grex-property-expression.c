@@ -42,145 +42,70 @@ grex_property_expression_finalize(GObject *object) {
   g_clear_pointer(&expression->name, g_free);
 }
 
-static void
-on_notify_property_changed(GObject *object, GParamSpec *pspec,
-                           gpointer user_data) {
-  GrexExpressionContext *context = GREX_EXPRESSION_CONTEXT(user_data);
-  grex_expression_context_emit_changed(context);
-}
-
-typedef struct {
-  GWeakRef object;
-  gulong notify_handler_id;
-  gulong reset_handler_id;
-} ContextResetData;
-
-static void
-reset_signal_handlers(GrexExpressionContext *context, ContextResetData *data) {
-  if (data->notify_handler_id != 0) {
-    g_autoptr(GObject) object = g_weak_ref_get(&data->object);
-    if (object != NULL) {
-      g_signal_handler_disconnect(object, data->notify_handler_id);
-      data->notify_handler_id = 0;
+static gboolean
+is_property_path(GrexExpression *expression) {
+  while (expression != NULL) {
+    if (!G_TYPE_CHECK_INSTANCE_TYPE(expression,
+                                    grex_property_expression_get_type())) {
+      return FALSE;
     }
-  }
 
-  if (data->reset_handler_id != 0 && context != NULL) {
-    g_signal_handler_disconnect(context, data->reset_handler_id);
-    data->reset_handler_id = 0;
+    expression = GREX_PROPERTY_EXPRESSION(expression)->object;
   }
-}
 
-static void
-on_context_reset(GrexExpressionContext *context, gpointer user_data) {
-  ContextResetData *data = user_data;
-  reset_signal_handlers(context, data);
+  return TRUE;
 }
 
 static void
-context_reset_data_free(gpointer user_data, GClosure *closure) {
-  ContextResetData *data = user_data;
-
-  reset_signal_handlers(NULL, data);
-  g_weak_ref_clear(&data->object);
-}
-
-typedef struct {
-  GObject *object;
-  char *property;
-} PushValueData;
-
-static void
-push_value_data_free(gpointer user_data) {
-  PushValueData *data = user_data;
-  g_object_unref(data->object);
-  g_free(data->property);
-}
-
-static void
-on_push_value(const GValue *value, gpointer user_data) {
-  PushValueData *data = user_data;
-  g_object_set_property(data->object, data->property, value);
-}
-
-static GrexValueHolder *
-grex_property_expression_evaluate(GrexExpression *expression,
-                                  GrexExpressionContext *context,
-                                  GrexExpressionEvaluationFlags flags,
-                                  GError **error) {
+grex_property_expression_compile(GrexExpression *expression,
+                                 GrexExpressionCompiler *compiler,
+                                 guint dest) {
   GrexPropertyExpression *property_expression =
       GREX_PROPERTY_EXPRESSION(expression);
+  const char *name = g_intern_string(property_expression->name);
 
-  g_autoptr(GObject) originating_object = NULL;
-  g_auto(GValue) value = G_VALUE_INIT;
-
-  if (property_expression->object != NULL) {
-    g_autoptr(GrexValueHolder) lookup_target_holder = grex_expression_evaluate(
-        property_expression->object, context,
-        GREX_EXPRESSION_EVALUATION_PROPAGATE_FLAGS(flags), error);
-    if (lookup_target_holder == NULL) {
-      return NULL;
-    }
+  if (property_expression->object == NULL) {
+    guint index = grex_expression_compiler_emit(
+        compiler, GREX_EXPRESSION_OP_LOOKUP_NAME, expression, dest);
+    grex_expression_compiler_get_instruction(compiler, index)->name = name;
+    return;
+  }
 
-    const GValue *lookup_target =
-        grex_value_holder_get_value(lookup_target_holder);
-    GType type = G_VALUE_TYPE(lookup_target);
-    if (!g_type_is_a(type, G_TYPE_OBJECT)) {
-      grex_set_expression_evaluation_error(
-          error, property_expression->object,
-          GREX_EXPRESSION_EVALUATION_ERROR_INVALID_TYPE,
-          "Cannot get property on type '%s'", g_type_name(type));
-      return NULL;
-    }
+  GrexExpression *object_expression = property_expression->object;
+  guint object = grex_expression_compiler_add_registers(compiler, 1);
+
+  // A path (e.g. the "a.b" of "a.b.c") only depends on the properties read
+  // along the way, so when tracking dependencies, it's only resolved again once
+  // one of those changes, and a change to just the final property re-reads
+  // only that property.
+  gboolean is_path = is_property_path(object_expression);
+  guint begin_path = 0;
+  if (is_path) {
+    begin_path = grex_expression_compiler_emit(
+        compiler, GREX_EXPRESSION_OP_BEGIN_PATH, object_expression, object);
+  }
 
-    originating_object = g_object_ref(g_value_get_object(lookup_target));
+  grex_expression_compile(object_expression, compiler, object);
 
-    if (g_object_class_find_property(G_OBJECT_GET_CLASS(originating_object),
-                                     property_expression->name) == NULL) {
-      grex_set_expression_evaluation_error(
-          error, expression,
-          GREX_EXPRESSION_EVALUATION_ERROR_UNDEFINED_PROPERTY,
-          "Undefined property '%s'", property_expression->name);
-      return NULL;
-    }
+  guint index = grex_expression_compiler_emit(
+      compiler, GREX_EXPRESSION_OP_CHECK_OBJECT, object_expression, 0);
+  grex_expression_compiler_get_instruction(compiler, index)->src = object;
 
-    g_object_get_property(originating_object, property_expression->name,
-                          &value);
-  } else {
-    if (!grex_expression_context_find_name(context, property_expression->name,
-                                           &value, &originating_object)) {
-      grex_set_expression_evaluation_error(
-          error, expression, GREX_EXPRESSION_EVALUATION_ERROR_UNDEFINED_NAME,
-          "Undefined name '%s'", property_expression->name);
-      return NULL;
-    }
-  }
+  if (is_path) {
+    index = grex_expression_compiler_emit(
+        compiler, GREX_EXPRESSION_OP_END_PATH, object_expression, 0);
+    grex_expression_compiler_get_instruction(compiler, index)->src = object;
 
-  if (flags & GREX_EXPRESSION_EVALUATION_TRACK_DEPENDENCIES &&
-      originating_object != NULL) {
-    g_autofree char *signal =
-        g_strdup_printf("notify::%s", property_expression->name);
-    gulong handler_id = g_signal_connect_object(
-        originating_object, signal, G_CALLBACK(on_notify_property_changed),
-        context, 0);
-
-    ContextResetData *reset_data = g_new0(ContextResetData, 1);
-    g_weak_ref_init(&reset_data->object, originating_object);
-    reset_data->notify_handler_id = handler_id;
-    g_signal_connect_data(context, "reset", G_CALLBACK(on_context_reset),
-                          reset_data, context_reset_data_free, 0);
+    grex_expression_compiler_get_instruction(compiler, begin_path)->jump =
+        grex_expression_compiler_get_position(compiler);
   }
 
-  if (flags & GREX_EXPRESSION_EVALUATION_ENABLE_PUSH &&
-      originating_object != NULL) {
-    PushValueData *data = g_new0(PushValueData, 1);
-    data->object = g_object_ref(originating_object);
-    data->property = g_strdup(property_expression->name);
-    return grex_value_holder_new_with_push_handler(&value, on_push_value, data,
-                                                   push_value_data_free);
-  } else {
-    return grex_value_holder_new(&value);
-  }
+  index = grex_expression_compiler_emit(
+      compiler, GREX_EXPRESSION_OP_GET_PROPERTY, expression, dest);
+  GrexExpressionInstruction *instruction =
+      grex_expression_compiler_get_instruction(compiler, index);
+  instruction->src = object;
+  instruction->name = name;
 }
 
 static void
@@ -194,7 +119,7 @@ grex_property_expression_class_init(GrexPropertyExpressionClass *klass) {
 
   GrexExpressionClass *expression_class = GREX_EXPRESSION_CLASS(klass);
 
-  expression_class->evaluate = grex_property_expression_evaluate;
+  expression_class->compile = grex_property_expression_compile;
 
   properties[PROP_OBJECT] = g_param_spec_object(
       "object", "Object",
@@ -4,7 +4,56 @@
 
 #include "grex-reactive-inflator.h"
 
+#include <gtk/gtk.h>
+
 #include "gpropz.h"
+#include "grex-enums.h"
+#include "grex-expression-context-private.h"
+#include "grex-inflation-task.h"
+#include "grex-inflator-private.h"
+#include "grex-reactive-inflator-private.h"
+#include "grex-reactive-scheduler-private.h"
+
+typedef struct {
+  GPtrArray *owners;
+  gboolean unowned_changed;
+} UpdateLane;
+
+#define N_LANES (GREX_CHANGE_PRIORITY_HIGH + 1)
+
+static void
+update_lane_clear(UpdateLane *lane) {
+  g_ptr_array_set_size(lane->owners, 0);
+  lane->unowned_changed = FALSE;
+}
+
+static gboolean
+update_lane_is_empty(UpdateLane *lane) {
+  return lane->owners->len == 0 && !lane->unowned_changed;
+}
+
+static void
+copy_owners(GPtrArray *dest, GPtrArray *src) {
+  for (guint i = 0; i < src->len; i++) {
+    g_ptr_array_add(dest,
+                    grex_dependency_owner_ref(g_ptr_array_index(src, i)));
+  }
+}
+
+static void
+move_owners(GPtrArray *dest, GPtrArray *src) {
+  copy_owners(dest, src);
+  g_ptr_array_set_size(src, 0);
+}
+
+// Moves everything from the lane into the given owners.
+static void
+update_lane_drain(UpdateLane *lane, GPtrArray *owners,
+                  gboolean *unowned_changed) {
+  move_owners(owners, lane->owners);
+  *unowned_changed |= lane->unowned_changed;
+  lane->unowned_changed = FALSE;
+}
 
 struct _GrexReactiveInflator {
   GObject parent_instance;
@@ -12,32 +61,351 @@ struct _GrexReactiveInflator {
   GrexInflator *base_inflator;
   GrexFragment *fragment;
   GObject *target;
+  GrexReactiveInflatorFlags flags;
+
+  guint max_passes;
+  guint last_pass_count;
+  guint slice_budget;
+
+  gboolean inflated;
+  gboolean dirty;
+  gboolean in_inflation;
+  gboolean needs_full_inflation;
+  // The number of grex_reactive_inflator_suspend() calls that haven't been
+  // resumed yet.
+  guint suspend_count;
+  GtkWidget *tick_widget;
+  guint tick_id;
+  guint idle_id;
+
+  // If set, deferred inflations are queued on this instead of scheduling their
+  // own tick callback or idle.
+  GrexReactiveScheduler *scheduler;
+  // The scheduler this inflator is currently queued on, if any.
+  GrexReactiveScheduler *scheduled_on;
+
+  // The time-sliced full inflation in progress, if any.
+  GrexInflationTask *task;
+  guint slice_id;
+
+  // Bindings invalidated by changes of each GrexChangePriority, waiting to be
+  // re-applied.
+  UpdateLane lanes[N_LANES];
+  // Set while the low priority lane is being flushed as well.
+  gboolean low_priority_due;
+  guint low_priority_idle_id;
 };
 
 enum {
   PROP_BASE_INFLATOR = 1,
   PROP_FRAGMENT,
   PROP_TARGET,
+  PROP_FLAGS,
+  PROP_MAX_PASSES,
+  PROP_LAST_PASS_COUNT,
+  PROP_SLICE_BUDGET,
+  PROP_SCHEDULER,
   N_PROPS,
 };
 
+#define DEFAULT_MAX_PASSES 4
+// Leaves most of a 60 Hz frame for everything else.
+#define DEFAULT_SLICE_BUDGET 4000
+
 static GParamSpec *properties[N_PROPS] = {NULL};
 
 G_DEFINE_TYPE(GrexReactiveInflator, grex_reactive_inflator, G_TYPE_OBJECT)
 
+static void grex_reactive_inflator_run_passes(GrexReactiveInflator *inflator,
+                                              gboolean full);
+static void grex_reactive_inflator_run_slice(GrexReactiveInflator *inflator,
+                                             gint64 budget_us);
+static void grex_reactive_inflator_run_pending(GrexReactiveInflator *inflator);
+
+// While suspended, changes only mark the inflator as dirty and nothing gets
+// scheduled, until it's resumed and catches up with a single inflation.
+static gboolean
+is_suspended(GrexReactiveInflator *inflator) {
+  if (inflator->suspend_count > 0) {
+    return TRUE;
+  }
+
+  return inflator->flags & GREX_REACTIVE_INFLATOR_SUSPEND_WHEN_UNMAPPED &&
+         GTK_IS_WIDGET(inflator->target) &&
+         !gtk_widget_get_mapped(GTK_WIDGET(inflator->target));
+}
+
+static void
+cancel_scheduled_inflation(GrexReactiveInflator *inflator) {
+  if (inflator->tick_id != 0) {
+    gtk_widget_remove_tick_callback(inflator->tick_widget, inflator->tick_id);
+    inflator->tick_id = 0;
+  }
+  g_clear_object(&inflator->tick_widget);
+
+  if (inflator->idle_id != 0) {
+    g_source_remove(inflator->idle_id);
+    inflator->idle_id = 0;
+  }
+
+  if (inflator->scheduled_on != NULL) {
+    grex_reactive_scheduler_unschedule(inflator->scheduled_on, inflator);
+    g_clear_object(&inflator->scheduled_on);
+  }
+}
+
+static gboolean
+on_tick(GtkWidget *widget, GdkFrameClock *clock, gpointer user_data) {
+  GrexReactiveInflator *inflator = GREX_REACTIVE_INFLATOR(user_data);
+
+  // Returning G_SOURCE_REMOVE removes the callback for us.
+  inflator->tick_id = 0;
+  g_clear_object(&inflator->tick_widget);
+
+  grex_reactive_inflator_run_pending(inflator);
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+on_idle(gpointer user_data) {
+  GrexReactiveInflator *inflator = GREX_REACTIVE_INFLATOR(user_data);
+
+  inflator->idle_id = 0;
+
+  grex_reactive_inflator_run_pending(inflator);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+cancel_next_slice(GrexReactiveInflator *inflator) {
+  if (inflator->slice_id != 0) {
+    g_source_remove(inflator->slice_id);
+    inflator->slice_id = 0;
+  }
+}
+
+static void
+cancel_sliced_inflation(GrexReactiveInflator *inflator) {
+  cancel_next_slice(inflator);
+
+  if (inflator->task != NULL) {
+    grex_inflation_task_cancel(inflator->task);
+    g_clear_object(&inflator->task);
+  }
+}
+
+static gboolean
+on_slice(gpointer user_data) {
+  GrexReactiveInflator *inflator = GREX_REACTIVE_INFLATOR(user_data);
+
+  guint slice_id = inflator->slice_id;
+
+  grex_reactive_inflator_run_slice(inflator, inflator->slice_budget);
+
+  // The slice may have suspended the inflator or restarted the inflation,
+  // which replaces this source.
+  if (inflator->slice_id != slice_id) {
+    return G_SOURCE_REMOVE;
+  }
+
+  if (inflator->task != NULL) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  inflator->slice_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_next_slice(GrexReactiveInflator *inflator) {
+  if (inflator->task != NULL && inflator->slice_id == 0 &&
+      !is_suspended(inflator)) {
+    inflator->slice_id =
+        g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, on_slice, inflator, NULL);
+  }
+}
+
+static void
+schedule_inflation(GrexReactiveInflator *inflator) {
+  if (inflator->tick_id != 0 || inflator->idle_id != 0 ||
+      inflator->scheduled_on != NULL || is_suspended(inflator)) {
+    return;
+  }
+
+  if (inflator->scheduler != NULL) {
+    inflator->scheduled_on = g_object_ref(inflator->scheduler);
+    grex_reactive_scheduler_schedule(inflator->scheduled_on, inflator);
+    return;
+  }
+
+  // Widgets that are being drawn get at most one inflation per frame, right
+  // before layout; anything else falls back to coalescing in an idle. (An
+  // unmapped widget's frame clock may never tick, e.g. if its window is
+  // hidden.)
+  if (GTK_IS_WIDGET(inflator->target) &&
+      gtk_widget_get_mapped(GTK_WIDGET(inflator->target))) {
+    inflator->tick_widget = g_object_ref(GTK_WIDGET(inflator->target));
+    inflator->tick_id = gtk_widget_add_tick_callback(inflator->tick_widget,
+                                                     on_tick, inflator, NULL);
+  } else {
+    inflator->idle_id = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, on_idle,
+                                        inflator, NULL);
+  }
+}
+
+static gboolean
+on_low_priority_idle(gpointer user_data) {
+  GrexReactiveInflator *inflator = GREX_REACTIVE_INFLATOR(user_data);
+
+  inflator->low_priority_idle_id = 0;
+
+  // Rescheduled once the time-sliced inflation is done, instead of restarting
+  // it for a background change.
+  if (inflator->task == NULL && !inflator->in_inflation) {
+    inflator->low_priority_due = TRUE;
+    grex_reactive_inflator_run_passes(inflator, FALSE);
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+cancel_low_priority_update(GrexReactiveInflator *inflator) {
+  if (inflator->low_priority_idle_id != 0) {
+    g_source_remove(inflator->low_priority_idle_id);
+    inflator->low_priority_idle_id = 0;
+  }
+}
+
+static void
+schedule_low_priority_update(GrexReactiveInflator *inflator) {
+  if (inflator->low_priority_idle_id == 0 && !is_suspended(inflator) &&
+      !update_lane_is_empty(&inflator->lanes[GREX_CHANGE_PRIORITY_LOW])) {
+    inflator->low_priority_idle_id =
+        g_idle_add_full(G_PRIORITY_LOW, on_low_priority_idle, inflator, NULL);
+  }
+}
+
 static void
 on_context_changed(GrexExpressionContext *context, gpointer user_data) {
   GrexReactiveInflator *inflator = GREX_REACTIVE_INFLATOR(user_data);
-  grex_reactive_inflator_inflate(inflator);
+
+  // The context may be shared with other inflators, so the owners are only
+  // copied, leaving them for the other handlers as well.
+  gboolean unowned_changed = FALSE;
+  GPtrArray *owners =
+      grex_expression_context_get_invalidated_owners(context, &unowned_changed);
+
+  // The change didn't affect anything that was read.
+  if (owners->len == 0 && !unowned_changed) {
+    return;
+  }
+
+  // Sort the invalidated bindings into their lane right away, so that they
+  // don't get mixed up with the ones from later changes.
+  GrexChangePriority priority = grex_change_set_get_priority(
+      grex_expression_context_get_changes(context));
+  UpdateLane *lane = &inflator->lanes[priority];
+  copy_owners(lane->owners, owners);
+  lane->unowned_changed |= unowned_changed;
+
+  if (priority == GREX_CHANGE_PRIORITY_LOW) {
+    // Background changes are coalesced until the main loop is idle.
+    schedule_low_priority_update(inflator);
+    return;
+  }
+
+  if (inflator->in_inflation) {
+    // Picked up by a follow-up pass once the current one is done.
+    inflator->dirty = TRUE;
+  } else if (inflator->flags & GREX_REACTIVE_INFLATOR_DEFERRED ||
+             inflator->scheduler != NULL || is_suspended(inflator)) {
+    inflator->dirty = TRUE;
+    schedule_inflation(inflator);
+  } else {
+    grex_reactive_inflator_run_passes(inflator, FALSE);
+  }
+}
+
+// Holds back everything that's scheduled, leaving it pending until the
+// inflator is resumed.
+static void
+pause_updates(GrexReactiveInflator *inflator) {
+  cancel_scheduled_inflation(inflator);
+  cancel_next_slice(inflator);
+  cancel_low_priority_update(inflator);
+}
+
+// Catches up on everything that was held back while suspended.
+static void
+resume_updates(GrexReactiveInflator *inflator) {
+  if (inflator->dirty && !inflator->in_inflation) {
+    if (inflator->flags & GREX_REACTIVE_INFLATOR_DEFERRED ||
+        inflator->scheduler != NULL) {
+      schedule_inflation(inflator);
+    } else {
+      grex_reactive_inflator_run_passes(inflator, FALSE);
+    }
+  }
+
+  schedule_next_slice(inflator);
+  schedule_low_priority_update(inflator);
+}
+
+static void
+update_suspension(GrexReactiveInflator *inflator) {
+  if (is_suspended(inflator)) {
+    pause_updates(inflator);
+  } else {
+    resume_updates(inflator);
+  }
+}
+
+static void
+on_target_map_changed(GtkWidget *widget, gpointer user_data) {
+  GrexReactiveInflator *inflator = GREX_REACTIVE_INFLATOR(user_data);
+
+  if (inflator->flags & GREX_REACTIVE_INFLATOR_SUSPEND_WHEN_UNMAPPED) {
+    update_suspension(inflator);
+  }
+
+  // A tick callback won't run on an unmapped widget, and an idle would run
+  // between frames on a mapped one, so move whatever is waiting over to the
+  // right one.
+  if ((inflator->tick_id != 0 && !gtk_widget_get_mapped(widget)) ||
+      (inflator->idle_id != 0 && gtk_widget_get_mapped(widget))) {
+    cancel_scheduled_inflation(inflator);
+    schedule_inflation(inflator);
+  }
+
+  // Same for a scheduler, which may be waiting on this target's frame clock.
+  if (inflator->scheduled_on != NULL) {
+    grex_reactive_scheduler_target_map_changed(inflator->scheduled_on,
+                                               inflator);
+  }
 }
 
 static void
 grex_reactive_inflator_dispose(GObject *object) {
   GrexReactiveInflator *inflator = GREX_REACTIVE_INFLATOR(object);
 
+  cancel_scheduled_inflation(inflator);
+  cancel_sliced_inflation(inflator);
+  cancel_low_priority_update(inflator);
+
   g_clear_object(&inflator->base_inflator);
   g_clear_object(&inflator->fragment);
   g_clear_object(&inflator->target);
+  g_clear_object(&inflator->scheduler);
+}
+
+static void
+grex_reactive_inflator_finalize(GObject *object) {
+  GrexReactiveInflator *inflator = GREX_REACTIVE_INFLATOR(object);
+
+  for (guint i = 0; i < N_LANES; i++) {
+    g_clear_pointer(&inflator->lanes[i].owners, g_ptr_array_unref);
+  }
 }
 
 static void
@@ -48,6 +416,13 @@ grex_reactive_inflator_constructed(GObject *object) {
       grex_inflator_get_context(inflator->base_inflator);
   g_signal_connect_object(context, "changed", G_CALLBACK(on_context_changed),
                           inflator, 0);
+
+  if (GTK_IS_WIDGET(inflator->target)) {
+    g_signal_connect_object(inflator->target, "map",
+                            G_CALLBACK(on_target_map_changed), inflator, 0);
+    g_signal_connect_object(inflator->target, "unmap",
+                            G_CALLBACK(on_target_map_changed), inflator, 0);
+  }
 }
 
 static void
@@ -56,6 +431,7 @@ grex_reactive_inflator_class_init(GrexReactiveInflatorClass *klass) {
 
   object_class->constructed = grex_reactive_inflator_constructed;
   object_class->dispose = grex_reactive_inflator_dispose;
+  object_class->finalize = grex_reactive_inflator_finalize;
 
   gpropz_class_init_property_functions(object_class);
 
@@ -78,10 +454,56 @@ grex_reactive_inflator_class_init(GrexReactiveInflatorClass *klass) {
       G_TYPE_OBJECT, G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
   gpropz_install_property(object_class, GrexReactiveInflator, target,
                           PROP_TARGET, properties[PROP_TARGET], NULL);
+
+  properties[PROP_FLAGS] = g_param_spec_flags(
+      "flags", "Flags", "Flags controlling when re-inflation happens.",
+      GREX_TYPE_REACTIVE_INFLATOR_FLAGS, GREX_REACTIVE_INFLATOR_NONE,
+      G_PARAM_READWRITE);
+  gpropz_install_property(object_class, GrexReactiveInflator, flags,
+                          PROP_FLAGS, properties[PROP_FLAGS], NULL);
+
+  properties[PROP_MAX_PASSES] = g_param_spec_uint(
+      "max-passes", "Maximum passes",
+      "The maximum number of inflation passes performed for a single update.",
+      1, G_MAXUINT, DEFAULT_MAX_PASSES, G_PARAM_READWRITE);
+  gpropz_install_property(object_class, GrexReactiveInflator, max_passes,
+                          PROP_MAX_PASSES, properties[PROP_MAX_PASSES], NULL);
+
+  properties[PROP_LAST_PASS_COUNT] = g_param_spec_uint(
+      "last-pass-count", "Last pass count",
+      "The number of inflation passes performed by the last update.", 0,
+      G_MAXUINT, 0, G_PARAM_READABLE);
+  gpropz_install_property(object_class, GrexReactiveInflator, last_pass_count,
+                          PROP_LAST_PASS_COUNT,
+                          properties[PROP_LAST_PASS_COUNT], NULL);
+
+  properties[PROP_SLICE_BUDGET] = g_param_spec_uint(
+      "slice-budget", "Slice budget",
+      "The time in microseconds a single slice of a time-sliced inflation "
+      "may take.",
+      1, G_MAXUINT, DEFAULT_SLICE_BUDGET, G_PARAM_READWRITE);
+  gpropz_install_property(object_class, GrexReactiveInflator, slice_budget,
+                          PROP_SLICE_BUDGET, properties[PROP_SLICE_BUDGET],
+                          NULL);
+
+  properties[PROP_SCHEDULER] = g_param_spec_object(
+      "scheduler", "Scheduler",
+      "The scheduler deferred inflations are queued on.",
+      GREX_TYPE_REACTIVE_SCHEDULER, G_PARAM_READWRITE);
+  gpropz_install_property(object_class, GrexReactiveInflator, scheduler,
+                          PROP_SCHEDULER, properties[PROP_SCHEDULER], NULL);
 }
 
 static void
-grex_reactive_inflator_init(GrexReactiveInflator *inflator) {}
+grex_reactive_inflator_init(GrexReactiveInflator *inflator) {
+  inflator->max_passes = DEFAULT_MAX_PASSES;
+  inflator->slice_budget = DEFAULT_SLICE_BUDGET;
+
+  for (guint i = 0; i < N_LANES; i++) {
+    inflator->lanes[i].owners = g_ptr_array_new_with_free_func(
+        (GDestroyNotify)grex_dependency_owner_unref);
+  }
+}
 
 /**
  * grex_reactive_inflator_new:
@@ -148,6 +570,124 @@ GPROPZ_DEFINE_RO(GrexFragment *, GrexReactiveInflator, grex_reactive_inflator,
 GPROPZ_DEFINE_RO(GObject *, GrexReactiveInflator, grex_reactive_inflator,
                  target, properties[PROP_TARGET])
 
+/**
+ * grex_reactive_inflator_get_flags:
+ *
+ * Returns the flags controlling when this inflator re-inflates its target.
+ *
+ * Returns: The flags.
+ */
+
+/**
+ * grex_reactive_inflator_set_flags:
+ * @flags: The new flags.
+ *
+ * Sets the flags controlling when this inflator re-inflates its target. If
+ * %GREX_REACTIVE_INFLATOR_DEFERRED is set, changes to the expression context
+ * only mark the inflator as dirty, and a single inflation is performed on the
+ * target's next frame clock tick (or in an idle callback if the target is not
+ * a mapped widget).
+ *
+ * If %GREX_REACTIVE_INFLATOR_FINE_GRAINED is set, dependencies are tracked per
+ * binding, and a change only re-evaluates the bindings that read it. If the
+ * inputs of a directive change, only the subtree it affects is re-inflated.
+ * The new flag takes effect on the next full inflation.
+ *
+ * If %GREX_REACTIVE_INFLATOR_TIME_SLICED is set, full inflations are spread
+ * out over multiple main loop iterations using a #GrexInflationTask, each
+ * taking up to #GrexReactiveInflator:slice-budget. If the context changes
+ * before the task is done, it's cancelled and a new one is started.
+ *
+ * If %GREX_REACTIVE_INFLATOR_SUSPEND_WHEN_UNMAPPED is set and the target is a
+ * widget, the inflator is suspended (see grex_reactive_inflator_suspend())
+ * for as long as the target isn't mapped, e.g. because its window is hidden or
+ * it's on a #GtkStack page that isn't visible. If the flag is cleared while
+ * the target is unmapped, any changes that were held back stay pending until
+ * the next change or grex_reactive_inflator_flush().
+ *
+ * If #GrexReactiveInflator:scheduler is set, changes are always deferred as
+ * if %GREX_REACTIVE_INFLATOR_DEFERRED was set, but the inflation is performed
+ * by the scheduler's next flush instead.
+ */
+GPROPZ_DEFINE_RW(GrexReactiveInflatorFlags, GrexReactiveInflator,
+                 grex_reactive_inflator, flags, properties[PROP_FLAGS])
+
+/**
+ * grex_reactive_inflator_get_max_passes:
+ *
+ * Returns the maximum number of passes performed for a single update.
+ *
+ * Returns: The maximum number of passes.
+ */
+
+/**
+ * grex_reactive_inflator_set_max_passes:
+ * @max_passes: The new maximum number of passes.
+ *
+ * Sets the maximum number of passes performed for a single update. If the
+ * context changes while an inflation is in progress (e.g. because setting a
+ * property has side effects on the scope), another pass is performed once it
+ * is done, until either nothing changes anymore or this limit is reached.
+ */
+GPROPZ_DEFINE_RW(guint, GrexReactiveInflator, grex_reactive_inflator,
+                 max_passes, properties[PROP_MAX_PASSES])
+
+/**
+ * grex_reactive_inflator_get_slice_budget:
+ *
+ * Returns the time in microseconds a single slice of a time-sliced inflation
+ * may take.
+ *
+ * Returns: The slice budget.
+ */
+
+/**
+ * grex_reactive_inflator_set_slice_budget:
+ * @slice_budget: The new slice budget.
+ *
+ * Sets the time in microseconds a single slice of a time-sliced inflation may
+ * take. This is only checked in between individual hosts, so a slice may run
+ * slightly over it.
+ */
+GPROPZ_DEFINE_RW(guint, GrexReactiveInflator, grex_reactive_inflator,
+                 slice_budget, properties[PROP_SLICE_BUDGET])
+
+/**
+ * grex_reactive_inflator_get_last_pass_count:
+ *
+ * Returns the number of passes the last update took. Anything above 1 means
+ * that the context was changed by the inflation itself, and reaching
+ * #GrexReactiveInflator:max-passes likely means there is a feedback cycle.
+ *
+ * Returns: The number of passes.
+ */
+GPROPZ_DEFINE_RO(guint, GrexReactiveInflator, grex_reactive_inflator,
+                 last_pass_count, properties[PROP_LAST_PASS_COUNT])
+
+/**
+ * grex_reactive_inflator_get_scheduler:
+ *
+ * Returns the scheduler this inflator's deferred inflations are queued on.
+ *
+ * Returns: (transfer none) (nullable): The scheduler.
+ */
+
+/**
+ * grex_reactive_inflator_set_scheduler:
+ * @scheduler: (nullable): The new scheduler.
+ *
+ * Sets the scheduler this inflator's deferred inflations are queued on. Many
+ * inflators sharing a single scheduler (usually the one from
+ * grex_reactive_scheduler_default()) are all updated in one flush per frame,
+ * ordered so that inflators higher up in the widget tree go first, instead of
+ * each scheduling its own tick callback.
+ *
+ * If an inflation is already waiting, it stays with the scheduler it was
+ * queued on.
+ */
+GPROPZ_DEFINE_RW(GrexReactiveScheduler *, GrexReactiveInflator,
+                 grex_reactive_inflator, scheduler, properties[PROP_SCHEDULER])
+
 void
 grex_reactive_inflator_change_fragment_and_inflate(
     GrexReactiveInflator *inflator, GrexFragment *new_fragment) {
@@ -161,15 +701,287 @@ grex_reactive_inflator_change_fragment_and_inflate(
  * grex_reactive_inflator_inflate:
  *
  * Performs a new inflation of this inflator's fragment into its target object,
- * tracking new dependencies in the process.
+ * tracking new dependencies in the process. If this is called while an
+ * inflation is already in progress, the new inflation is performed once the
+ * current one is done.
  */
 void
 grex_reactive_inflator_inflate(GrexReactiveInflator *inflator) {
+  grex_reactive_inflator_run_passes(inflator, TRUE);
+}
+
+static void
+grex_reactive_inflator_perform_full_inflation(GrexReactiveInflator *inflator) {
   GrexExpressionContext *context =
       grex_inflator_get_context(inflator->base_inflator);
-  grex_expression_context_reset_dependencies(context);
 
-  grex_inflator_inflate_existing_target(inflator->base_inflator,
-                                        inflator->target, inflator->fragment,
-                                        GREX_INFLATION_TRACK_DEPENDENCIES);
+  // A full inflation re-evaluates everything anyway, so any bindings waiting to
+  // be re-applied can be dropped.
+  for (guint i = 0; i < N_LANES; i++) {
+    update_lane_clear(&inflator->lanes[i]);
+  }
+  inflator->low_priority_due = FALSE;
+  cancel_low_priority_update(inflator);
+
+  GrexInflationFlags flags = GREX_INFLATION_TRACK_DEPENDENCIES;
+  if (inflator->flags & GREX_REACTIVE_INFLATOR_FINE_GRAINED) {
+    flags |= GREX_INFLATION_TRACK_PER_BINDING;
+  }
+
+  // Whatever the current task did is superseded by this inflation.
+  cancel_sliced_inflation(inflator);
+
+  // Only the dependencies that are no longer read get disconnected, the rest
+  // keep their existing connections.
+  grex_expression_context_begin_tracking(context);
+
+  if (inflator->flags & GREX_REACTIVE_INFLATOR_TIME_SLICED) {
+    // Tracking ends once the last slice is done.
+    inflator->task =
+        grex_inflation_task_new(inflator->base_inflator, inflator->target,
+                                inflator->fragment, flags);
+    schedule_next_slice(inflator);
+    return;
+  }
+
+  grex_inflator_inflate_existing_target(
+      inflator->base_inflator, inflator->target, inflator->fragment, flags);
+  grex_expression_context_end_tracking(context);
+  inflator->inflated = TRUE;
+}
+
+static void
+grex_reactive_inflator_perform_update(GrexReactiveInflator *inflator) {
+  // Anything invalidated in a batch that hasn't ended yet is left for the
+  // batch's own emission of "changed".
+  gboolean unowned_changed = FALSE;
+  g_autoptr(GPtrArray) invalidated_owners = g_ptr_array_new_with_free_func(
+      (GDestroyNotify)grex_dependency_owner_unref);
+  update_lane_drain(&inflator->lanes[GREX_CHANGE_PRIORITY_HIGH],
+                    invalidated_owners, &unowned_changed);
+  if (inflator->low_priority_due) {
+    inflator->low_priority_due = FALSE;
+    update_lane_drain(&inflator->lanes[GREX_CHANGE_PRIORITY_LOW],
+                      invalidated_owners, &unowned_changed);
+  }
+
+  // The hosts of a time-sliced inflation in progress can't be updated in
+  // place, so that restarts instead.
+  if (!inflator->inflated || unowned_changed || inflator->task != NULL ||
+      !(inflator->flags & GREX_REACTIVE_INFLATOR_FINE_GRAINED)) {
+    grex_reactive_inflator_perform_full_inflation(inflator);
+    return;
+  }
+
+  for (guint i = 0; i < invalidated_owners->len; i++) {
+    grex_inflator_reapply_binding(inflator->base_inflator,
+                                  g_ptr_array_index(invalidated_owners, i));
+  }
+
+  // Changes to directive inputs mark their hosts as dirty instead, so only
+  // those subtrees need to be inflated again.
+  GrexFragmentHost *host = grex_fragment_host_for_target(inflator->target);
+  if (host != NULL && grex_fragment_host_is_subtree_dirty(host)) {
+    grex_inflator_inflate_existing_target(
+        inflator->base_inflator, inflator->target, inflator->fragment,
+        GREX_INFLATION_TRACK_DEPENDENCIES | GREX_INFLATION_TRACK_PER_BINDING |
+            GREX_INFLATION_ONLY_DIRTY);
+  }
+}
+
+// Performs a full inflation or an update, followed by further updates for as
+// long as the inflation itself keeps changing the context (up to max-passes).
+// If called while already inflating, the request is queued for a follow-up
+// pass instead of nesting inflations.
+static void
+grex_reactive_inflator_run_passes(GrexReactiveInflator *inflator,
+                                  gboolean full) {
+  if (inflator->in_inflation) {
+    inflator->dirty = TRUE;
+    inflator->needs_full_inflation |= full;
+    return;
+  }
+
+  inflator->in_inflation = TRUE;
+
+  guint passes = 0;
+  do {
+    passes++;
+
+    inflator->dirty = FALSE;
+    cancel_scheduled_inflation(inflator);
+
+    if (full) {
+      grex_reactive_inflator_perform_full_inflation(inflator);
+    } else {
+      grex_reactive_inflator_perform_update(inflator);
+    }
+
+    full = inflator->needs_full_inflation;
+    inflator->needs_full_inflation = FALSE;
+  } while (inflator->dirty && passes < inflator->max_passes);
+
+  inflator->in_inflation = FALSE;
+
+  if (inflator->dirty) {
+    g_warning("Inflation did not settle after %u passes, the bindings may "
+              "form a feedback cycle",
+              passes);
+
+    // Leave the remaining changes pending, rather than spinning on them.
+    if (inflator->flags & GREX_REACTIVE_INFLATOR_DEFERRED ||
+        inflator->scheduler != NULL) {
+      schedule_inflation(inflator);
+    }
+  }
+
+  if (inflator->last_pass_count != passes) {
+    inflator->last_pass_count = passes;
+    g_object_notify_by_pspec(G_OBJECT(inflator),
+                             properties[PROP_LAST_PASS_COUNT]);
+  }
+}
+
+// Continues the time-sliced inflation in progress. Any changes that arrive
+// during the slice supersede it, restarting the inflation from scratch.
+static void
+grex_reactive_inflator_run_slice(GrexReactiveInflator *inflator,
+                                 gint64 budget_us) {
+  g_return_if_fail(inflator->task != NULL && !inflator->in_inflation);
+
+  inflator->in_inflation = TRUE;
+  gboolean finished = grex_inflation_task_step(inflator->task, budget_us);
+  inflator->in_inflation = FALSE;
+
+  if (finished) {
+    g_clear_object(&inflator->task);
+    grex_expression_context_end_tracking(
+        grex_inflator_get_context(inflator->base_inflator));
+    inflator->inflated = TRUE;
+
+    schedule_low_priority_update(inflator);
+  }
+
+  if (inflator->dirty) {
+    gboolean full = inflator->needs_full_inflation || !finished;
+    inflator->needs_full_inflation = FALSE;
+    grex_reactive_inflator_run_passes(inflator, full);
+  }
+}
+
+// Performs any inflation the last changes are waiting on.
+static void
+grex_reactive_inflator_run_pending(GrexReactiveInflator *inflator) {
+  if (inflator->dirty && !inflator->in_inflation) {
+    grex_reactive_inflator_run_passes(inflator, FALSE);
+  }
+}
+
+// Called by the scheduler this inflator was queued on once it's flushed.
+void
+grex_reactive_inflator_run_scheduled(GrexReactiveInflator *inflator) {
+  // Already unscheduled by an inflation that ran in the meantime.
+  if (inflator->scheduled_on == NULL) {
+    return;
+  }
+
+  g_clear_object(&inflator->scheduled_on);
+  grex_reactive_inflator_run_pending(inflator);
+}
+
+/**
+ * grex_reactive_inflator_flush:
+ *
+ * If any changes are waiting on a deferred inflation (including low priority
+ * ones), performs that inflation immediately instead. If a time-sliced
+ * inflation is in progress, the rest of it is performed immediately.
+ * Otherwise, this does nothing.
+ */
+void
+grex_reactive_inflator_flush(GrexReactiveInflator *inflator) {
+  if (inflator->in_inflation) {
+    return;
+  }
+
+  // Low priority changes can't wait any longer either.
+  if (!update_lane_is_empty(&inflator->lanes[GREX_CHANGE_PRIORITY_LOW])) {
+    cancel_low_priority_update(inflator);
+    inflator->low_priority_due = TRUE;
+    inflator->dirty = TRUE;
+  }
+
+  // Restart any task that's out of date before finishing it.
+  grex_reactive_inflator_run_pending(inflator);
+
+  // Changes made by the task itself restart it again, so this needs the same
+  // limit as the passes.
+  for (guint i = 0; inflator->task != NULL && i < inflator->max_passes; i++) {
+    grex_reactive_inflator_run_slice(inflator, -1);
+  }
+
+  if (inflator->task == NULL) {
+    cancel_next_slice(inflator);
+  }
+}
+
+/**
+ * grex_reactive_inflator_suspend:
+ *
+ * Suspends this inflator: until it's resumed again via
+ * grex_reactive_inflator_resume(), changes to the expression context only mark
+ * it as dirty, and no inflations are scheduled (including the slices of a
+ * time-sliced inflation in progress). Once resumed, it catches up on all the
+ * changes it missed with a single update.
+ *
+ * Explicit calls to grex_reactive_inflator_inflate() and
+ * grex_reactive_inflator_flush() are still performed while suspended.
+ *
+ * Calls to this function nest, so the inflator is only resumed once every call
+ * has been matched by a call to grex_reactive_inflator_resume().
+ */
+void
+grex_reactive_inflator_suspend(GrexReactiveInflator *inflator) {
+  inflator->suspend_count++;
+  update_suspension(inflator);
+}
+
+/**
+ * grex_reactive_inflator_resume:
+ *
+ * Reverts a previous call to grex_reactive_inflator_suspend().
+ */
+void
+grex_reactive_inflator_resume(GrexReactiveInflator *inflator) {
+  g_return_if_fail(inflator->suspend_count > 0);
+
+  inflator->suspend_count--;
+  update_suspension(inflator);
+}
+
+/**
+ * grex_reactive_inflator_is_suspended:
+ *
+ * Checks if this inflator is currently suspended, either explicitly via
+ * grex_reactive_inflator_suspend() or because its target is unmapped and
+ * %GREX_REACTIVE_INFLATOR_SUSPEND_WHEN_UNMAPPED is set.
+ *
+ * Returns: %TRUE if the inflator is suspended.
+ */
+gboolean
+grex_reactive_inflator_is_suspended(GrexReactiveInflator *inflator) {
+  return is_suspended(inflator);
+}
+
+/**
+ * grex_reactive_inflator_is_pending:
+ *
+ * Checks if this inflator has changes waiting on a deferred inflation
+ * (including low priority ones), or a time-sliced inflation in progress.
+ *
+ * Returns: %TRUE if an inflation is pending.
+ */
+gboolean
+grex_reactive_inflator_is_pending(GrexReactiveInflator *inflator) {
+  return inflator->dirty || inflator->task != NULL ||
+         !update_lane_is_empty(&inflator->lanes[GREX_CHANGE_PRIORITY_LOW]);
 }
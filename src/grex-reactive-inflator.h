@@ -7,9 +7,18 @@
 #include "grex-config.h"
 #include "grex-fragment.h"
 #include "grex-inflator.h"
+#include "grex-reactive-scheduler.h"
 
 G_BEGIN_DECLS
 
+typedef enum {
+  GREX_REACTIVE_INFLATOR_NONE = 0,
+  GREX_REACTIVE_INFLATOR_DEFERRED = 1 << 0,
+  GREX_REACTIVE_INFLATOR_FINE_GRAINED = 1 << 1,
+  GREX_REACTIVE_INFLATOR_TIME_SLICED = 1 << 2,
+  GREX_REACTIVE_INFLATOR_SUSPEND_WHEN_UNMAPPED = 1 << 3,
+} GrexReactiveInflatorFlags;
+
 #define GREX_TYPE_REACTIVE_INFLATOR grex_reactive_inflator_get_type()
 G_DECLARE_FINAL_TYPE(GrexReactiveInflator, grex_reactive_inflator, GREX,
                      REACTIVE_INFLATOR, GObject)
@@ -25,9 +34,37 @@ GrexFragment *
 grex_reactive_inflator_get_fragment(GrexReactiveInflator *inflator);
 GObject *grex_reactive_inflator_get_target(GrexReactiveInflator *inflator);
 
+GrexReactiveInflatorFlags
+grex_reactive_inflator_get_flags(GrexReactiveInflator *inflator);
+void grex_reactive_inflator_set_flags(GrexReactiveInflator *inflator,
+                                      GrexReactiveInflatorFlags flags);
+
+guint grex_reactive_inflator_get_max_passes(GrexReactiveInflator *inflator);
+void grex_reactive_inflator_set_max_passes(GrexReactiveInflator *inflator,
+                                           guint max_passes);
+
+guint
+grex_reactive_inflator_get_slice_budget(GrexReactiveInflator *inflator);
+void grex_reactive_inflator_set_slice_budget(GrexReactiveInflator *inflator,
+                                             guint slice_budget);
+
+guint
+grex_reactive_inflator_get_last_pass_count(GrexReactiveInflator *inflator);
+
+GrexReactiveScheduler *
+grex_reactive_inflator_get_scheduler(GrexReactiveInflator *inflator);
+void grex_reactive_inflator_set_scheduler(GrexReactiveInflator *inflator,
+                                          GrexReactiveScheduler *scheduler);
+
 void grex_reactive_inflator_change_fragment_and_inflate(
     GrexReactiveInflator *inflator, GrexFragment *new_fragment);
 
 void grex_reactive_inflator_inflate(GrexReactiveInflator *inflator);
+void grex_reactive_inflator_flush(GrexReactiveInflator *inflator);
+void grex_reactive_inflator_suspend(GrexReactiveInflator *inflator);
+void grex_reactive_inflator_resume(GrexReactiveInflator *inflator);
+gboolean grex_reactive_inflator_is_suspended(GrexReactiveInflator *inflator);
+
+gboolean grex_reactive_inflator_is_pending(GrexReactiveInflator *inflator);
 
 G_END_DECLS
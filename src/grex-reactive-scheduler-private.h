@@ -0,0 +1,20 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "grex-config.h"
+#include "grex-reactive-inflator.h"
+#include "grex-reactive-scheduler.h"
+
+#ifndef _GREX_INTERNAL
+#error "This is internal stuff, you shouldn't be here!"
+#endif
+
+void grex_reactive_scheduler_schedule(GrexReactiveScheduler *scheduler,
+                                      GrexReactiveInflator *inflator);
+void grex_reactive_scheduler_unschedule(GrexReactiveScheduler *scheduler,
+                                        GrexReactiveInflator *inflator);
+void grex_reactive_scheduler_target_map_changed(
+    GrexReactiveScheduler *scheduler, GrexReactiveInflator *inflator);
@@ -0,0 +1,444 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "grex-reactive-scheduler.h"
+
+#include <gtk/gtk.h>
+
+#include "gpropz.h"
+#include "grex-reactive-inflator-private.h"
+#include "grex-reactive-scheduler-private.h"
+
+struct _GrexReactiveScheduler {
+  GObject parent_instance;
+
+  // The inflators waiting for the next flush, in the order they were
+  // scheduled. Inflators unschedule themselves before they're disposed, so
+  // these aren't referenced.
+  GPtrArray *queue;
+  // The next flush is either run by the frame clock of one of the queued
+  // targets, or by an idle if none of them are mapped.
+  GdkFrameClock *clock;
+  gulong clock_update_id;
+  guint flush_id;
+  gboolean in_flush;
+
+  guint flush_count;
+  guint last_flush_size;
+  guint last_flush_duration;
+};
+
+enum {
+  PROP_FLUSH_COUNT = 1,
+  PROP_LAST_FLUSH_SIZE,
+  PROP_LAST_FLUSH_DURATION,
+  N_PROPS,
+};
+
+static GParamSpec *properties[N_PROPS] = {NULL};
+
+// Inflators that are scheduled again by a flush get another round in the same
+// flush, up to this many rounds.
+#define MAX_FLUSH_ROUNDS 4
+
+G_DEFINE_TYPE(GrexReactiveScheduler, grex_reactive_scheduler, G_TYPE_OBJECT)
+
+static void
+cancel_flush(GrexReactiveScheduler *scheduler) {
+  if (scheduler->clock_update_id != 0) {
+    g_signal_handler_disconnect(scheduler->clock, scheduler->clock_update_id);
+    scheduler->clock_update_id = 0;
+  }
+  g_clear_object(&scheduler->clock);
+
+  if (scheduler->flush_id != 0) {
+    g_source_remove(scheduler->flush_id);
+    scheduler->flush_id = 0;
+  }
+}
+
+static void
+grex_reactive_scheduler_dispose(GObject *object) {
+  GrexReactiveScheduler *scheduler = GREX_REACTIVE_SCHEDULER(object);
+
+  cancel_flush(scheduler);
+}
+
+static void
+grex_reactive_scheduler_finalize(GObject *object) {
+  GrexReactiveScheduler *scheduler = GREX_REACTIVE_SCHEDULER(object);
+
+  g_clear_pointer(&scheduler->queue, g_ptr_array_unref);
+}
+
+static void
+grex_reactive_scheduler_class_init(GrexReactiveSchedulerClass *klass) {
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+  object_class->dispose = grex_reactive_scheduler_dispose;
+  object_class->finalize = grex_reactive_scheduler_finalize;
+
+  gpropz_class_init_property_functions(object_class);
+
+  properties[PROP_FLUSH_COUNT] = g_param_spec_uint(
+      "flush-count", "Flush count", "The number of flushes performed so far.",
+      0, G_MAXUINT, 0, G_PARAM_READABLE);
+  gpropz_install_property(object_class, GrexReactiveScheduler, flush_count,
+                          PROP_FLUSH_COUNT, properties[PROP_FLUSH_COUNT],
+                          NULL);
+
+  properties[PROP_LAST_FLUSH_SIZE] = g_param_spec_uint(
+      "last-flush-size", "Last flush size",
+      "The number of inflators updated by the last flush.", 0, G_MAXUINT, 0,
+      G_PARAM_READABLE);
+  gpropz_install_property(object_class, GrexReactiveScheduler,
+                          last_flush_size, PROP_LAST_FLUSH_SIZE,
+                          properties[PROP_LAST_FLUSH_SIZE], NULL);
+
+  properties[PROP_LAST_FLUSH_DURATION] = g_param_spec_uint(
+      "last-flush-duration", "Last flush duration",
+      "The time in microseconds the last flush took.", 0, G_MAXUINT, 0,
+      G_PARAM_READABLE);
+  gpropz_install_property(object_class, GrexReactiveScheduler,
+                          last_flush_duration, PROP_LAST_FLUSH_DURATION,
+                          properties[PROP_LAST_FLUSH_DURATION], NULL);
+}
+
+static void
+grex_reactive_scheduler_init(GrexReactiveScheduler *scheduler) {
+  scheduler->queue = g_ptr_array_new();
+}
+
+/**
+ * grex_reactive_scheduler_new:
+ *
+ * Creates a new scheduler. Most applications should just use
+ * grex_reactive_scheduler_default() instead.
+ *
+ * Returns: (transfer full): The new scheduler.
+ */
+GrexReactiveScheduler *
+grex_reactive_scheduler_new() {
+  return g_object_new(GREX_TYPE_REACTIVE_SCHEDULER, NULL);
+}
+
+/**
+ * grex_reactive_scheduler_default:
+ *
+ * Retrieves the process-wide scheduler.
+ *
+ * Returns: (transfer none): The scheduler.
+ */
+GrexReactiveScheduler *
+grex_reactive_scheduler_default() {
+  static GrexReactiveScheduler *scheduler = NULL;
+  if (g_once_init_enter(&scheduler)) {
+    g_once_init_leave(&scheduler, grex_reactive_scheduler_new());
+  }
+
+  return scheduler;
+}
+
+/**
+ * grex_reactive_scheduler_get_flush_count:
+ *
+ * Returns the number of flushes this scheduler performed so far.
+ *
+ * Returns: The flush count.
+ */
+GPROPZ_DEFINE_RO(guint, GrexReactiveScheduler, grex_reactive_scheduler,
+                 flush_count, properties[PROP_FLUSH_COUNT])
+
+/**
+ * grex_reactive_scheduler_get_last_flush_size:
+ *
+ * Returns the number of inflators that were updated by the last flush.
+ * Inflators that were scheduled again during the flush are counted once per
+ * update.
+ *
+ * Returns: The number of inflators.
+ */
+GPROPZ_DEFINE_RO(guint, GrexReactiveScheduler, grex_reactive_scheduler,
+                 last_flush_size, properties[PROP_LAST_FLUSH_SIZE])
+
+/**
+ * grex_reactive_scheduler_get_last_flush_duration:
+ *
+ * Returns the time in microseconds the last flush took.
+ *
+ * Returns: The duration.
+ */
+GPROPZ_DEFINE_RO(guint, GrexReactiveScheduler, grex_reactive_scheduler,
+                 last_flush_duration, properties[PROP_LAST_FLUSH_DURATION])
+
+static gboolean
+on_flush_idle(gpointer user_data) {
+  GrexReactiveScheduler *scheduler = GREX_REACTIVE_SCHEDULER(user_data);
+
+  scheduler->flush_id = 0;
+
+  grex_reactive_scheduler_flush(scheduler);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+on_frame_clock_update(GdkFrameClock *clock, gpointer user_data) {
+  GrexReactiveScheduler *scheduler = GREX_REACTIVE_SCHEDULER(user_data);
+  grex_reactive_scheduler_flush(scheduler);
+}
+
+// Returns the frame clock that draws the inflator's target, or NULL if it isn't
+// being drawn right now.
+static GdkFrameClock *
+get_target_frame_clock(GrexReactiveInflator *inflator) {
+  GObject *target = grex_reactive_inflator_get_target(inflator);
+  if (!GTK_IS_WIDGET(target) || !gtk_widget_get_mapped(GTK_WIDGET(target))) {
+    return NULL;
+  }
+
+  return gtk_widget_get_frame_clock(GTK_WIDGET(target));
+}
+
+static void
+flush_on_frame_clock(GrexReactiveScheduler *scheduler, GdkFrameClock *clock) {
+  cancel_flush(scheduler);
+
+  scheduler->clock = g_object_ref(clock);
+  scheduler->clock_update_id = g_signal_connect(
+      clock, "update", G_CALLBACK(on_frame_clock_update), scheduler);
+  gdk_frame_clock_request_phase(clock, GDK_FRAME_CLOCK_PHASE_UPDATE);
+}
+
+static void
+flush_on_idle(GrexReactiveScheduler *scheduler) {
+  cancel_flush(scheduler);
+
+  scheduler->flush_id = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, on_flush_idle,
+                                        scheduler, NULL);
+}
+
+// Makes sure a flush runs for the newly queued inflator. Mapped targets have it
+// run in the update phase of their next frame, right before layout, so
+// everything that changed since the last frame is flushed in a single pass.
+// Anything else falls back to an idle, which is replaced by a frame once a
+// mapped target is queued as well.
+static void
+schedule_flush(GrexReactiveScheduler *scheduler,
+               GrexReactiveInflator *inflator) {
+  if (scheduler->clock != NULL) {
+    return;
+  }
+
+  GdkFrameClock *clock = get_target_frame_clock(inflator);
+  if (clock != NULL) {
+    flush_on_frame_clock(scheduler, clock);
+  } else if (scheduler->flush_id == 0) {
+    flush_on_idle(scheduler);
+  }
+}
+
+// Picks the flush source again from scratch, since the one in use may belong
+// to a target that's no longer mapped (and whose frame clock may never tick
+// again).
+static void
+reschedule_flush(GrexReactiveScheduler *scheduler) {
+  if (scheduler->queue->len == 0) {
+    cancel_flush(scheduler);
+    return;
+  }
+
+  GdkFrameClock *clock = NULL;
+  for (guint i = 0; i < scheduler->queue->len && clock == NULL; i++) {
+    clock = get_target_frame_clock(g_ptr_array_index(scheduler->queue, i));
+  }
+
+  if (clock != NULL) {
+    if (clock != scheduler->clock) {
+      flush_on_frame_clock(scheduler, clock);
+    }
+  } else if (scheduler->flush_id == 0) {
+    flush_on_idle(scheduler);
+  }
+}
+
+// Queues the inflator for the next flush. The inflator must unschedule itself
+// if it's disposed or updated before then.
+void
+grex_reactive_scheduler_schedule(GrexReactiveScheduler *scheduler,
+                                 GrexReactiveInflator *inflator) {
+  if (!g_ptr_array_find(scheduler->queue, inflator, NULL)) {
+    g_ptr_array_add(scheduler->queue, inflator);
+  }
+
+  // Anything scheduled during a flush is picked up by its next round.
+  if (!scheduler->in_flush) {
+    schedule_flush(scheduler, inflator);
+  }
+}
+
+void
+grex_reactive_scheduler_unschedule(GrexReactiveScheduler *scheduler,
+                                   GrexReactiveInflator *inflator) {
+  if (g_ptr_array_remove(scheduler->queue, inflator) && !scheduler->in_flush) {
+    reschedule_flush(scheduler);
+  }
+}
+
+// Called when a queued inflator's target is mapped or unmapped, so the flush
+// follows the frame clocks that are actually running.
+void
+grex_reactive_scheduler_target_map_changed(GrexReactiveScheduler *scheduler,
+                                           GrexReactiveInflator *inflator) {
+  if (!scheduler->in_flush &&
+      g_ptr_array_find(scheduler->queue, inflator, NULL)) {
+    reschedule_flush(scheduler);
+  }
+}
+
+typedef struct {
+  GrexReactiveInflator *inflator;
+  guint depth;
+  guint index;
+} FlushEntry;
+
+// Returns how deep in the widget tree the inflator's target is, treating
+// transient windows as children of their parent windows. Anything that isn't a
+// widget goes first.
+static guint
+get_target_depth(GrexReactiveInflator *inflator) {
+  GObject *target = grex_reactive_inflator_get_target(inflator);
+  if (!GTK_IS_WIDGET(target)) {
+    return 0;
+  }
+
+  guint depth = 1;
+  GtkWidget *widget = GTK_WIDGET(target);
+  while (widget != NULL) {
+    GtkWidget *parent = gtk_widget_get_parent(widget);
+    if (parent == NULL && GTK_IS_WINDOW(widget)) {
+      parent = GTK_WIDGET(gtk_window_get_transient_for(GTK_WINDOW(widget)));
+    }
+
+    widget = parent;
+    depth++;
+  }
+
+  return depth;
+}
+
+static int
+compare_flush_entries(gconstpointer a, gconstpointer b) {
+  const FlushEntry *entry_a = a;
+  const FlushEntry *entry_b = b;
+
+  if (entry_a->depth != entry_b->depth) {
+    return entry_a->depth < entry_b->depth ? -1 : 1;
+  }
+
+  // Otherwise, keep them in the order they were scheduled in.
+  return entry_a->index < entry_b->index ? -1 : entry_a->index > entry_b->index;
+}
+
+static void
+flush_entry_clear(FlushEntry *entry) {
+  g_clear_object(&entry->inflator);
+}
+
+// Takes everything that's currently queued, sorted so that outer inflators are
+// updated before the ones inside them.
+static GArray *
+take_sorted_queue(GrexReactiveScheduler *scheduler) {
+  GArray *entries = g_array_sized_new(FALSE, FALSE, sizeof(FlushEntry),
+                                      scheduler->queue->len);
+  g_array_set_clear_func(entries, (GDestroyNotify)flush_entry_clear);
+
+  for (guint i = 0; i < scheduler->queue->len; i++) {
+    GrexReactiveInflator *inflator = g_ptr_array_index(scheduler->queue, i);
+    FlushEntry entry = {.inflator = g_object_ref(inflator),
+                        .depth = get_target_depth(inflator),
+                        .index = i};
+    g_array_append_val(entries, entry);
+  }
+
+  g_ptr_array_set_size(scheduler->queue, 0);
+  g_array_sort(entries, compare_flush_entries);
+  return entries;
+}
+
+/**
+ * grex_reactive_scheduler_flush:
+ *
+ * Updates every inflator that's waiting on this scheduler right away, in tree
+ * order, instead of waiting for the next frame. Inflators that are scheduled
+ * again by these updates (e.g. because one inflator's bindings changed another
+ * one's scope) are updated as part of the same flush, up to a limited number
+ * of rounds.
+ */
+void
+grex_reactive_scheduler_flush(GrexReactiveScheduler *scheduler) {
+  if (scheduler->in_flush) {
+    return;
+  }
+
+  cancel_flush(scheduler);
+
+  g_object_ref(scheduler);
+  scheduler->in_flush = TRUE;
+
+  gint64 start = g_get_monotonic_time();
+  guint size = 0;
+
+  for (guint round = 0;
+       scheduler->queue->len > 0 && round < MAX_FLUSH_ROUNDS; round++) {
+    g_autoptr(GArray) entries = take_sorted_queue(scheduler);
+    for (guint i = 0; i < entries->len; i++) {
+      FlushEntry *entry = &g_array_index(entries, FlushEntry, i);
+      grex_reactive_inflator_run_scheduled(entry->inflator);
+      size++;
+    }
+  }
+
+  scheduler->in_flush = FALSE;
+
+  if (scheduler->queue->len > 0) {
+    g_warning("Scheduled inflations did not settle after %u rounds, the "
+              "inflators may form a feedback cycle",
+              MAX_FLUSH_ROUNDS);
+
+    // Leave the rest for the next frame, rather than spinning on them.
+    for (guint i = 0; i < scheduler->queue->len; i++) {
+      schedule_flush(scheduler, g_ptr_array_index(scheduler->queue, i));
+    }
+  }
+
+  g_object_freeze_notify(G_OBJECT(scheduler));
+
+  scheduler->flush_count++;
+  g_object_notify_by_pspec(G_OBJECT(scheduler),
+                           properties[PROP_FLUSH_COUNT]);
+
+  scheduler->last_flush_size = size;
+  g_object_notify_by_pspec(G_OBJECT(scheduler),
+                           properties[PROP_LAST_FLUSH_SIZE]);
+
+  scheduler->last_flush_duration =
+      MIN(g_get_monotonic_time() - start, G_MAXUINT);
+  g_object_notify_by_pspec(G_OBJECT(scheduler),
+                           properties[PROP_LAST_FLUSH_DURATION]);
+
+  g_object_thaw_notify(G_OBJECT(scheduler));
+  g_object_unref(scheduler);
+}
+
+/**
+ * grex_reactive_scheduler_is_pending:
+ *
+ * Checks if any inflators are waiting on this scheduler.
+ *
+ * Returns: %TRUE if a flush is pending.
+ */
+gboolean
+grex_reactive_scheduler_is_pending(GrexReactiveScheduler *scheduler) {
+  return scheduler->queue->len > 0;
+}
@@ -0,0 +1,28 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include "grex-config.h"
+
+G_BEGIN_DECLS
+
+#define GREX_TYPE_REACTIVE_SCHEDULER grex_reactive_scheduler_get_type()
+G_DECLARE_FINAL_TYPE(GrexReactiveScheduler, grex_reactive_scheduler, GREX,
+                     REACTIVE_SCHEDULER, GObject)
+
+GrexReactiveScheduler *grex_reactive_scheduler_new();
+GrexReactiveScheduler *grex_reactive_scheduler_default();
+
+guint
+grex_reactive_scheduler_get_flush_count(GrexReactiveScheduler *scheduler);
+guint grex_reactive_scheduler_get_last_flush_size(
+    GrexReactiveScheduler *scheduler);
+guint grex_reactive_scheduler_get_last_flush_duration(
+    GrexReactiveScheduler *scheduler);
+
+void grex_reactive_scheduler_flush(GrexReactiveScheduler *scheduler);
+gboolean grex_reactive_scheduler_is_pending(GrexReactiveScheduler *scheduler);
+
+G_END_DECLS
@@ -5,6 +5,7 @@
 #include "grex-template.h"
 
 #include "gpropz.h"
+#include "grex-fragment-private.h"
 
 struct _GrexTemplate {
   GObject parent_instance;
@@ -128,6 +129,43 @@ grex_template_new_from_xml(const char *xml, gssize len, const char *filename,
   return grex_template_new(fragment, scope, loader);
 }
 
+/**
+ * grex_template_new_from_bytes:
+ * @bytes: The template's content, either XML or a binary fragment.
+ * @filename: (nullable): The filename of the content, used in the resulting
+ *                        fragment's source location if it's XML.
+ * @scope: (nullable): The #GtkBuilderScope to resolve type names.
+ * @loader: (nullable): The #GrexResourceLoader the fragment was loaded from.
+ *
+ * Creates a new #GrexTemplate containing a fragment loaded from the given
+ * data. Binary fragments (see grex_fragment_write_binary()) are detected by
+ * their header and loaded directly from @bytes, without parsing any XML.
+ *
+ * Returns: (transfer full): A new template.
+ */
+GrexTemplate *
+grex_template_new_from_bytes(GBytes *bytes, const char *filename,
+                             GtkBuilderScope *scope,
+                             GrexResourceLoader *loader) {
+  gsize size = 0;
+  const char *data = g_bytes_get_data(bytes, &size);
+
+  if (!grex_fragment_is_binary((const guint8 *)data, size)) {
+    return grex_template_new_from_xml(data, size, filename, scope, loader);
+  }
+
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GrexFragment) fragment =
+      grex_fragment_parse_binary(bytes, scope, &error);
+  if (fragment == NULL) {
+    g_critical("Failed to load template (%s): %s",
+               filename != NULL ? filename : "<unknown>", error->message);
+    return NULL;
+  }
+
+  return grex_template_new(fragment, scope, loader);
+}
+
 /**
  * grex_template_new_from_resource:
  * @resource: The resource path.
@@ -135,8 +173,9 @@ grex_template_new_from_xml(const char *xml, gssize len, const char *filename,
  * @loader: (nullable): The #GrexResourceLoader the given resource was
  *          registered with.
  *
- * Creates a new #GrexTemplate containing a fragment parsed from the XML data
- * within the given resource path.
+ * Creates a new #GrexTemplate containing a fragment loaded from the given
+ * resource path, which may contain either XML or a binary fragment (see
+ * grex_template_new_from_bytes()).
  *
  * Returns: (transfer full): A new template.
  */
@@ -151,11 +190,8 @@ grex_template_new_from_resource(const char *resource, GtkBuilderScope *scope,
     return NULL;
   }
 
-  gsize size = 0;
-  const char *xml = g_bytes_get_data(bytes, &size);
-
   GrexTemplate *template =
-      grex_template_new_from_xml(xml, size, resource, scope, loader);
+      grex_template_new_from_bytes(bytes, resource, scope, loader);
   if (template == NULL) {
     return NULL;
   }
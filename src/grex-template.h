@@ -20,6 +20,10 @@ GrexTemplate *grex_template_new_from_xml(const char *xml, gssize len,
                                          const char *filename,
                                          GtkBuilderScope *scope,
                                          GrexResourceLoader *loader);
+GrexTemplate *grex_template_new_from_bytes(GBytes *bytes,
+                                           const char *filename,
+                                           GtkBuilderScope *scope,
+                                           GrexResourceLoader *loader);
 GrexTemplate *grex_template_new_from_resource(const char *resource,
                                               GtkBuilderScope *scope,
                                               GrexResourceLoader *loader);
@@ -6,7 +6,9 @@
 
 #define _GREX_ALLOW_INDIVIDUAL_HEADERS
 
+#include "grex-async-value.h"
 #include "grex-binding.h"
+#include "grex-change-set.h"
 #include "grex-container-adapter.h"
 #include "grex-enums.h"
 #include "grex-expression.h"
@@ -16,8 +18,10 @@
 #include "grex-gtk-child-property-container-adapter.h"
 #include "grex-gtk-widget-container-adapter.h"
 #include "grex-if-directive.h"
+#include "grex-inflation-task.h"
 #include "grex-inflator.h"
 #include "grex-reactive-inflator.h"
+#include "grex-reactive-scheduler.h"
 #include "grex-resource-loader.h"
 #include "grex-source-location.h"
 #include "grex-structural-directive.h"
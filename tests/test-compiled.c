@@ -0,0 +1,190 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Inflates the code grex-compile generated from compiled-template.xml, to make
+// sure it actually builds against libgrex and does the same as the
+// interpreter.
+
+#include <grex.h>
+
+#include "compiled-template.h"
+#include "gpropz.h"
+
+#define TEST_TYPE_SCOPE test_scope_get_type()
+G_DECLARE_FINAL_TYPE(TestScope, test_scope, TEST, SCOPE, GObject)
+
+struct _TestScope {
+  GObject parent_instance;
+
+  char *name;
+  gboolean visible;
+};
+
+enum {
+  PROP_NAME = 1,
+  PROP_VISIBLE,
+  N_PROPS,
+};
+
+static GParamSpec *properties[N_PROPS] = {NULL};
+
+G_DEFINE_TYPE(TestScope, test_scope, G_TYPE_OBJECT)
+
+static void
+test_scope_finalize(GObject *object) {
+  TestScope *scope = TEST_SCOPE(object);
+  g_clear_pointer(&scope->name, g_free);
+}
+
+static void
+test_scope_class_init(TestScopeClass *klass) {
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+  object_class->finalize = test_scope_finalize;
+
+  gpropz_class_init_property_functions(object_class);
+
+  properties[PROP_NAME] = g_param_spec_string(
+      "name", "Name", "The name to greet.", NULL, G_PARAM_READWRITE);
+  gpropz_install_property(object_class, TestScope, name, PROP_NAME,
+                          properties[PROP_NAME], NULL);
+
+  properties[PROP_VISIBLE] =
+      g_param_spec_boolean("visible", "Visible", "Whether to show 'Hi'.",
+                           FALSE, G_PARAM_READWRITE);
+  gpropz_install_property(object_class, TestScope, visible, PROP_VISIBLE,
+                          properties[PROP_VISIBLE], NULL);
+}
+
+static void
+test_scope_init(TestScope *scope) {}
+
+static GrexInflator *
+create_inflator(GObject *scope) {
+  GrexInflator *inflator = grex_inflator_new_with_scope(scope);
+  grex_inflator_take_directives(
+      inflator, GREX_INFLATOR_DIRECTIVE_NONE,
+      grex_gtk_box_container_directive_factory_new(),
+      grex_if_directive_factory_new(), NULL);
+  return inflator;
+}
+
+static void
+test_compiled_inflate() {
+  g_autoptr(GObject) scope = g_object_new(TEST_TYPE_SCOPE, "name", "world",
+                                          "visible", TRUE, NULL);
+  g_autoptr(GrexInflator) inflator = create_inflator(scope);
+  GrexFragment *fragment = compiled_template_template_get_fragment();
+
+  g_autoptr(GObject) target =
+      g_object_ref_sink(grex_inflator_inflate_new_target(
+          inflator, fragment, GREX_INFLATION_TRACK_DEPENDENCIES));
+  g_assert_true(GTK_IS_BOX(target));
+
+  GtkBox *box = GTK_BOX(target);
+  g_assert_cmpint(gtk_orientable_get_orientation(GTK_ORIENTABLE(box)), ==,
+                  GTK_ORIENTATION_VERTICAL);
+  g_assert_cmpint(gtk_box_get_spacing(box), ==, 6);
+
+  GtkWidget *greeting = gtk_widget_get_first_child(GTK_WIDGET(box));
+  g_assert_true(GTK_IS_LABEL(greeting));
+  g_assert_cmpstr(gtk_label_get_label(GTK_LABEL(greeting)), ==,
+                  "Hello, world!");
+  g_assert_true(gtk_label_get_selectable(GTK_LABEL(greeting)));
+
+  GtkWidget *hi = gtk_widget_get_next_sibling(greeting);
+  g_assert_true(GTK_IS_LABEL(hi));
+  g_assert_cmpstr(gtk_label_get_label(GTK_LABEL(hi)), ==, "Hi");
+  g_assert_null(gtk_widget_get_next_sibling(hi));
+
+  // Inflating again keeps the same children and only applies what changed.
+  g_object_set(scope, "name", "there", "visible", FALSE, NULL);
+  grex_inflator_inflate_existing_target(inflator, target, fragment,
+                                        GREX_INFLATION_TRACK_DEPENDENCIES);
+
+  g_assert_true(gtk_widget_get_first_child(GTK_WIDGET(box)) == greeting);
+  g_assert_cmpstr(gtk_label_get_label(GTK_LABEL(greeting)), ==,
+                  "Hello, there!");
+  g_assert_null(gtk_widget_get_next_sibling(greeting));
+}
+
+static int inflate_count = 0;
+
+static void
+count_inflation(GrexInflator *inflator, GObject *target,
+                GrexInflationFlags flags) {
+  inflate_count++;
+}
+
+static GrexFragment *
+parse_fragment(const char *xml) {
+  g_autoptr(GError) error = NULL;
+  GrexFragment *fragment =
+      grex_fragment_parse_xml(xml, -1, "test.xml", NULL, &error);
+  g_assert_no_error(error);
+  return fragment;
+}
+
+static void
+insert_constant(GrexFragment *fragment, const char *target,
+                const char *value) {
+  g_autoptr(GrexBindingBuilder) builder = grex_binding_builder_new();
+  grex_binding_builder_add_constant(builder, value, -1);
+  g_autoptr(GrexBinding) binding =
+      grex_binding_builder_build(builder, grex_fragment_get_location(fragment));
+  grex_fragment_insert_binding(fragment, target, binding);
+}
+
+static void
+test_compiled_invalidated_per_tree() {
+  g_autoptr(GrexInflator) inflator = create_inflator(NULL);
+  g_autoptr(GrexFragment) fragment =
+      parse_fragment("<GtkBox><GtkLabel label='a'/></GtkBox>");
+  g_autoptr(GrexFragment) other =
+      parse_fragment("<GtkBox><GtkLabel label='b'/></GtkBox>");
+
+  inflate_count = 0;
+  grex_inflator_register_compiled_fragment(fragment, count_inflation);
+
+  g_autoptr(GObject) target =
+      g_object_ref_sink(grex_inflator_inflate_new_target(inflator, fragment,
+                                                         GREX_INFLATION_NONE));
+  g_assert_cmpint(inflate_count, ==, 1);
+
+  // Modifying another tree leaves the compiled function in place.
+  g_autoptr(GObject) other_target = g_object_ref_sink(
+      grex_inflator_inflate_new_target(inflator, other, GREX_INFLATION_NONE));
+  g_autoptr(GList) other_children = grex_fragment_get_children(other);
+  insert_constant(other_children->data, "label", "c");
+
+  grex_inflator_inflate_existing_target(inflator, target, fragment,
+                                        GREX_INFLATION_NONE);
+  g_assert_cmpint(inflate_count, ==, 2);
+
+  // Modifying a descendant of the fragment itself doesn't.
+  g_autoptr(GList) children = grex_fragment_get_children(fragment);
+  insert_constant(children->data, "label", "d");
+
+  grex_inflator_inflate_existing_target(inflator, target, fragment,
+                                        GREX_INFLATION_NONE);
+  g_assert_cmpint(inflate_count, ==, 2);
+
+  GtkWidget *label = gtk_widget_get_first_child(GTK_WIDGET(target));
+  g_assert_cmpstr(gtk_label_get_label(GTK_LABEL(label)), ==, "d");
+}
+
+int
+main(int argc, char **argv) {
+  g_test_init(&argc, &argv, NULL);
+
+  // Widgets need a display, so there's nothing to test without one.
+  if (!gtk_init_check()) {
+    return 77;
+  }
+
+  g_test_add_func("/compiled/inflate", test_compiled_inflate);
+  g_test_add_func("/compiled/invalidated-per-tree",
+                  test_compiled_invalidated_per_tree);
+  return g_test_run();
+}
@@ -108,3 +108,37 @@ def test_compound():
         False,
     )
     assert _build_and_evaluate(builder, str, context=context) == 'abc10'
+
+
+class _AsyncObject(GObject.Object):
+    def __init__(self, pending) -> None:
+        super(_AsyncObject, self).__init__()
+        self._pending = pending
+
+    @GObject.Property(type=Grex.AsyncValue)
+    def pending(self):  # type: ignore
+        return self._pending
+
+
+def test_async_value():
+    pending = Grex.AsyncValue.new('loading')
+    context = Grex.ExpressionContext.new(_AsyncObject(pending))
+
+    changed_handler = MagicMock()
+    context.connect('changed', changed_handler)
+
+    builder = Grex.BindingBuilder()
+    builder.add_expression(
+        Grex.property_expression_new(Grex.SourceLocation(), None, 'pending'),
+        False,
+    )
+    binding = builder.build(Grex.SourceLocation())
+
+    assert binding.evaluate(str, context, True).get_value() == 'loading'
+    changed_handler.assert_not_called()
+
+    pending.return_value('done')
+    assert pending.get_completed()
+    changed_handler.assert_called()
+
+    assert binding.evaluate(str, context, True).get_value() == 'done'
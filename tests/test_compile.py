@@ -0,0 +1,116 @@
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+from gi.repository import GLib, Grex, Gtk
+import os
+import subprocess
+
+GREX_COMPILE = os.environ['GREX_COMPILE']
+
+
+def _compile(tmp_path, xml, *args):
+    input_path = tmp_path / 'template.xml'
+    input_path.write_text(xml)
+
+    return subprocess.run(
+        [GREX_COMPILE, *args, str(input_path)],
+        capture_output=True,
+        text=True,
+    )
+
+
+def test_compile(tmp_path):
+    XML = """
+    <UnknownWindow title="[title]">
+        <GtkLabel label="Hello, [name]!" selectable="[true]"/>
+    </UnknownWindow>
+    """
+
+    output_path = tmp_path / 'template.grex'
+    result = _compile(
+        tmp_path, XML, '--allow-unknown-types', '--output', str(output_path)
+    )
+    assert result.returncode == 0, result.stderr
+
+    fragment = Grex.Fragment.parse_binary(
+        GLib.Bytes.new(output_path.read_bytes()), None
+    )
+    assert fragment.get_location().get_file() == 'template.xml'
+    [label] = fragment.get_children()
+    assert label.get_target_type() == Gtk.Label.__gtype__
+
+    # Without the flag, the unknown type is an error.
+    result = _compile(tmp_path, XML)
+    assert result.returncode != 0
+    assert 'Unknown type: UnknownWindow' in result.stderr
+
+
+def test_compile_invalid_bindings(tmp_path):
+    XML = """
+    <GtkBox orientation="diagonal">
+        <GtkLabel labl="[text]" on.nothing="[emit x()]"/>
+        <GtkLabel label="[unterminated"/>
+    </GtkBox>
+    """
+
+    result = _compile(tmp_path, XML)
+    assert result.returncode != 0
+    assert 'Missing closing bracket' in result.stderr
+
+    result = _compile(tmp_path, XML.replace('[unterminated', '[ok]'))
+    assert result.returncode != 0
+    assert "Invalid value for property 'orientation'" in result.stderr
+    assert "Invalid property 'labl' on type 'GtkLabel'" in result.stderr
+    assert "Invalid signal 'nothing' on type 'GtkLabel'" in result.stderr
+    assert '3 error(s)' in result.stderr
+
+
+def test_compile_c_source(tmp_path):
+    XML = """
+    <GtkBox orientation="vertical" spacing="[6]">
+        <GtkLabel label="Hello, &quot;[name]&quot;!" selectable="[true]"/>
+        <GtkLabel _Grex.if="[visible]" label="Hi"/>
+    </GtkBox>
+    """
+
+    source_path = tmp_path / 'template.c'
+    header_path = tmp_path / 'template.h'
+    result = _compile(
+        tmp_path,
+        XML,
+        '--c-source',
+        str(source_path),
+        '--c-header',
+        str(header_path),
+    )
+    assert result.returncode == 0, result.stderr
+
+    header = header_path.read_text()
+    assert 'GrexFragment *template_template_get_fragment(void);' in header
+
+    source = source_path.read_text()
+    assert '#include "template.h"' in source
+    # Constants are converted at build time.
+    assert 'g_value_set_enum(&value, 1);' in source
+    assert 'g_value_set_int(&value, 6);' in source
+    assert 'g_value_set_boolean(&value, TRUE);' in source
+    # Bindings that need the scope are left to the inflator.
+    assert 'grex_inflator_apply_compiled_binding(\n' in source
+    # Every binding's target is only resolved once, when the template is
+    # loaded.
+    assert 'grex_compiled_target_new(template_template_fragments[1], ' in (
+        source
+    )
+    # So are children with structural directives.
+    assert 'template_template_fragments[2], NULL, flags);' in source
+    assert (
+        'grex_inflator_register_compiled_fragment(fragment, '
+        'template_template_inflate_0);'
+    ) in source
+
+    result = _compile(
+        tmp_path, XML, '--c-source', str(source_path), '--c-prefix', 'hello'
+    )
+    assert result.returncode == 0, result.stderr
+    assert 'hello_get_fragment(void) {' in source_path.read_text()
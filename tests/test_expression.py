@@ -356,3 +356,79 @@ def test_signal_expression_parsing(test_object, context):
         _parse_and_eval("emit echo-signal(1, 'end', )", context)
         == 'args: 1 GTK_ALIGN_END'
     )
+
+
+def test_expression_reevaluation(test_object, context):
+    expr = Grex.Expression.parse(
+        "emit echo-signal(value, 'end')", -1, Grex.SourceLocation()
+    )
+    result = expr.evaluate(context, Grex.ExpressionEvaluationFlags.NONE)
+    assert result.get_value() == 'args: 10 GTK_ALIGN_END'
+
+    # The expression is only compiled once, but every evaluation reads the
+    # current values.
+    test_object.value = test_object.NEXT_VALUE
+    result = expr.evaluate(context, Grex.ExpressionEvaluationFlags.NONE)
+    assert result.get_value() == 'args: 20 GTK_ALIGN_END'
+
+
+def test_expression_cached_path(test_object, context, changed_handler):
+    expr = Grex.Expression.parse('inner.value', -1, Grex.SourceLocation())
+    flags = Grex.ExpressionEvaluationFlags.TRACK_DEPENDENCIES
+    assert expr.evaluate(context, flags).get_value() == 'string'
+
+    # Only the path to the object is cached, the property is still read.
+    test_object.inner.value = _InnerObject.NEXT_VALUE
+    changed_handler.assert_called_once()
+    assert expr.evaluate(context, flags).get_value() == _InnerObject.NEXT_VALUE
+
+    # Nothing the path read has changed yet, so the old object is reused.
+    old_inner = test_object.inner
+    test_object._inner = _InnerObject()
+    assert expr.evaluate(context, flags).get_value() == _InnerObject.NEXT_VALUE
+
+    test_object.notify('inner')
+    assert changed_handler.call_count == 2
+    assert expr.evaluate(context, flags).get_value() == 'string'
+    assert old_inner.value == _InnerObject.NEXT_VALUE
+
+
+def test_expression_error_in_path(test_object, context, changed_handler):
+    flags = Grex.ExpressionEvaluationFlags.TRACK_DEPENDENCIES
+    expr = Grex.Expression.parse('inner.value.xyz', -1, Grex.SourceLocation())
+    with pytest.raises(GLib.GError) as excinfo:
+        expr.evaluate(context, flags)
+
+    assert (
+        excinfo.value.code == Grex.ExpressionEvaluationError.INVALID_TYPE
+    ), excinfo.value
+
+    # The failed path was unwound, so later ones are still tracked properly.
+    expr = Grex.Expression.parse('inner.value', -1, Grex.SourceLocation())
+    assert expr.evaluate(context, flags).get_value() == 'string'
+    assert expr.evaluate(context, flags).get_value() == 'string'
+
+    test_object.inner.value = _InnerObject.NEXT_VALUE
+    changed_handler.assert_called()
+    assert expr.evaluate(context, flags).get_value() == _InnerObject.NEXT_VALUE
+
+
+def test_signal_expression_converted_args(context):
+    expr = _make_signal_expr(
+        None,
+        'echo-signal',
+        args=[
+            Grex.constant_value_expression_new(Grex.SourceLocation(), 2.0),
+            Grex.constant_value_expression_new(Grex.SourceLocation(), 'end'),
+        ],
+    )
+    result = expr.evaluate(context, Grex.ExpressionEvaluationFlags.NONE)
+    assert result.get_value() == 'args: 2 GTK_ALIGN_END'
+
+
+def test_constant_string_outlives_expression(context):
+    expr = Grex.Expression.parse("'hello'", -1, Grex.SourceLocation())
+    result = expr.evaluate(context, Grex.ExpressionEvaluationFlags.NONE)
+    del expr
+
+    assert result.get_value() == 'hello'
@@ -80,3 +80,81 @@ def test_reset():
 
     context.reset_dependencies()
     reset_handler.assert_called_once()
+
+
+def test_batch():
+    context = Grex.ExpressionContext()
+    changed_handler = MagicMock()
+    context.connect('changed', changed_handler)
+
+    context.begin_batch()
+    context.insert('a', 1)
+
+    context.begin_batch()
+    context.insert('b', 2)
+    context.end_batch()
+
+    context.insert('c', 3)
+    changed_handler.assert_not_called()
+
+    context.end_batch()
+    changed_handler.assert_called_once()
+
+    context.begin_batch()
+    context.end_batch()
+    changed_handler.assert_called_once()
+
+
+def test_changes():
+    obj = _TestObject()
+    context = Grex.ExpressionContext.new(obj)
+    assert context.get_changes() is None
+
+    changes = []
+
+    def on_changed(context):
+        changes.append(context.get_changes())
+
+    context.connect('changed', on_changed)
+
+    context.begin_batch()
+    context.insert('a', 1)
+    context.insert('b', 2)
+    context.end_batch()
+
+    assert len(changes) == 1
+    assert sorted(changes[0].get_names()) == ['a', 'b']
+    assert changes[0].contains_name('a')
+    assert not changes[0].contains_name('c')
+    assert not changes[0].contains_object(obj)
+    assert context.get_changes() is None
+
+
+def test_source_priority():
+    obj = _TestObject()
+    context = Grex.ExpressionContext.new(obj)
+    context.set_source_priority(obj, Grex.ChangePriority.LOW)
+
+    expr = Grex.property_expression_new(Grex.SourceLocation(), None, 'value')
+    expr.evaluate(context, Grex.ExpressionEvaluationFlags.TRACK_DEPENDENCIES)
+
+    priorities = []
+
+    def on_changed(context):
+        priorities.append(context.get_changes().get_priority())
+
+    context.connect('changed', on_changed)
+
+    obj.props.value = 'def'
+    context.insert('name', 123)
+    assert priorities == [
+        Grex.ChangePriority.LOW,
+        Grex.ChangePriority.HIGH,
+    ]
+
+    # A batch has the highest priority of its changes.
+    context.begin_batch()
+    obj.props.value = 'ghi'
+    context.insert('name', 456)
+    context.end_batch()
+    assert priorities[-1] == Grex.ChangePriority.HIGH
@@ -31,7 +31,7 @@ def test_fragment_bindings():
 
     binding_y = Grex.BindingBuilder().build(Grex.SourceLocation())
     fragment.insert_binding('y', binding_y)
-    assert list(sorted(fragment.get_binding_targets())) == ['x', 'y']
+    assert fragment.get_binding_targets() == ['x', 'y']
     assert fragment.get_binding('y') == binding_y
 
     assert fragment.remove_binding('x')
@@ -111,3 +111,85 @@ def test_fragment_parsing_invalid_type():
     with pytest.raises(GLib.GError) as excinfo:
         Grex.Fragment.parse_xml('<GtkThing/>', -1)
     assert 'Unknown type: GtkThing' in excinfo.value.message
+
+
+def test_fragment_parsing_static():
+    XML = """
+    <GtkBox>
+        <GtkBox orientation="vertical" hexpand="[true]">
+            <GtkLabel label="static"/>
+        </GtkBox>
+
+        <GtkBox>
+            <GtkLabel label="[value]"/>
+        </GtkBox>
+    </GtkBox>
+    """
+
+    root = Grex.Fragment.parse_xml(XML, -1)
+    assert not root.is_static()
+
+    [static_box, dynamic_box] = root.get_children()
+    assert static_box.is_static()
+    assert static_box.get_children()[0].is_static()
+    assert not dynamic_box.is_static()
+    assert not dynamic_box.get_children()[0].is_static()
+
+    static_box.insert_binding('spacing', static_box.get_binding('hexpand'))
+    assert not static_box.is_static()
+
+    assert not Grex.Fragment.new(
+        Gtk.Box.__gtype__, Grex.SourceLocation(), False
+    ).is_static()
+
+
+def test_fragment_binary():
+    XML = """
+    <GtkBox spacing="[4]" hexpand="[true]">
+        <GtkLabel label="Hello, [name]!" _Grex.if="[visible]"/>
+        <GtkEntry text="{value}" on.activate="[emit activated(x.y, 'a')]"/>
+        <GtkSeparator orientation="vertical"/>
+    </GtkBox>
+    """
+
+    original = Grex.Fragment.parse_xml(XML, -1, 'file')
+    data = original.write_binary()
+    assert data.get_data() == original.write_binary().get_data()
+
+    root = Grex.Fragment.parse_binary(data, None)
+    assert root.get_target_type() == Gtk.Box.__gtype__
+    assert root.is_root()
+    assert not root.is_static()
+    assert root.get_location().get_file() == 'file'
+    # The bindings keep the order they're applied in.
+    assert root.get_binding_targets() == ['spacing', 'hexpand']
+    assert (
+        root.get_binding('spacing')
+        .evaluate(int, Grex.ExpressionContext(), False)
+        .get_value()
+        == 4
+    )
+
+    [label, entry, separator] = root.get_children()
+    assert not label.is_root()
+    assert not label.is_static()
+    assert label.get_binding_targets() == ['label', '_Grex.if']
+    assert (
+        label.get_binding('label').get_binding_type()
+        == Grex.BindingType.COMPOUND
+    )
+
+    assert entry.get_target_type() == Gtk.Entry.__gtype__
+    assert (
+        entry.get_binding('text').get_binding_type()
+        == Grex.BindingType.EXPRESSION_2WAY
+    )
+    assert entry.get_binding('on.activate') is not None
+    assert separator.is_static()
+
+    # Reading the data back gives the same data.
+    assert root.write_binary().get_data() == data.get_data()
+
+    with pytest.raises(GLib.GError) as excinfo:
+        Grex.Fragment.parse_binary(GLib.Bytes.new(data.get_data()[:80]), None)
+    assert 'Invalid binary fragment' in excinfo.value.message
@@ -185,6 +185,75 @@ def test_fragment_inflation_children():
     assert y.get_parent() is None
 
 
+def test_fragment_host_dirty():
+    box = Gtk.Box()
+    box_host = Grex.FragmentHost.new(box)
+    box_host.set_container_adapter(Grex.GtkWidgetContainerAdapter())
+
+    label = Gtk.Label()
+    label_host = Grex.FragmentHost.new(label)
+    label_key = Grex.Key.new_string(NAMESPACE, 'label')
+
+    assert box_host.is_dirty()
+    assert label_host.is_dirty()
+
+    label_host.begin_inflation()
+    label_host.commit_inflation()
+
+    box_host.begin_inflation()
+    box_host.add_inflated_child(label_key, label)
+    box_host.commit_inflation()
+
+    assert box_host.get_inflated_child(label_key) == label
+    assert not box_host.is_dirty()
+    assert not box_host.is_subtree_dirty()
+    assert not label_host.is_dirty()
+
+    label_host.mark_dirty()
+    assert label_host.is_dirty()
+    assert label_host.is_subtree_dirty()
+    assert not box_host.is_dirty()
+    assert box_host.is_subtree_dirty()
+
+    label_host.begin_inflation()
+    label_host.commit_inflation()
+    assert not label_host.is_dirty()
+
+
+def test_fragment_host_abort_inflation():
+    box = Gtk.Box()
+    host = Grex.FragmentHost.new(box)
+    host.set_container_adapter(Grex.GtkWidgetContainerAdapter())
+
+    label_a = Gtk.Label()
+    label_a_key = Grex.Key.new_string(NAMESPACE, 'a')
+    label_b = Gtk.Label()
+    label_b_key = Grex.Key.new_string(NAMESPACE, 'b')
+
+    host.begin_inflation()
+    host.add_inflated_child(label_a_key, label_a)
+    host.commit_inflation()
+
+    host.begin_inflation()
+    host.add_inflated_child(label_b_key, label_b)
+    host.abort_inflation()
+
+    assert host.is_dirty()
+    assert host.get_inflated_child(label_a_key) == label_a
+    assert host.get_inflated_child(label_b_key) == label_b
+    assert label_a.get_parent() == box
+    assert label_b.get_parent() == box
+
+    host.begin_inflation()
+    host.add_inflated_child(label_b_key, host.get_leftover_child(label_b_key))
+    host.commit_inflation()
+
+    assert not host.is_dirty()
+    assert host.get_inflated_child(label_a_key) is None
+    assert label_a.get_parent() is None
+    assert label_b.get_parent() == box
+
+
 def test_fragment_host_inflation_property_directives():
     label = Gtk.Label()
     host = Grex.FragmentHost.new(label)
@@ -20,6 +20,17 @@ def _build_bool_binding(value):
     return builder.build(Grex.SourceLocation())
 
 
+def _build_double_binding(value):
+    builder = Grex.BindingBuilder()
+    builder.add_expression(
+        Grex.constant_value_expression_new(
+            Grex.SourceLocation(), float(value)
+        ),
+        False,
+    )
+    return builder.build(Grex.SourceLocation())
+
+
 def _create_label_fragment():
     return Grex.Fragment.new(Gtk.Label.__gtype__, Grex.SourceLocation(), False)
 
@@ -217,6 +228,35 @@ def test_inflate_existing_target():
     assert target.get_text() == 'world'
 
 
+def test_inflate_constant_binding_once():
+    inflator = Grex.Inflator()
+    fragment = _create_label_fragment()
+    fragment.insert_binding('label', _build_constant_binding('hello'))
+
+    target = Gtk.Label()
+    inflator.inflate_existing_target(
+        target, fragment, Grex.InflationFlags.NONE
+    )
+    assert target.get_text() == 'hello'
+
+    notify_handler = MagicMock()
+    target.connect('notify::label', notify_handler)
+
+    # The constant is neither re-applied nor reset.
+    target.set_text('changed')
+    notify_handler.reset_mock()
+    inflator.inflate_existing_target(
+        target, fragment, Grex.InflationFlags.NONE
+    )
+    assert target.get_text() == 'changed'
+    notify_handler.assert_not_called()
+
+    inflator.inflate_existing_target(
+        target, _create_label_fragment(), Grex.InflationFlags.NONE
+    )
+    assert target.get_text() == ''
+
+
 def test_inflate_property_binding():
     scope = _TestObject()
     inflator = Grex.Inflator.new_with_scope(scope)
@@ -236,6 +276,73 @@ def test_inflate_property_binding():
     assert scope._value == 'def'
 
 
+def test_inflate_subclass_target():
+    scope = _TestObject()
+    inflator = Grex.Inflator.new_with_scope(scope)
+
+    builder = Grex.BindingBuilder()
+    builder.add_expression(
+        Grex.property_expression_new(Grex.SourceLocation(), None, 'value'),
+        True,
+    )
+
+    fragment = Grex.Fragment.new(
+        Gtk.Widget.__gtype__, Grex.SourceLocation(), False
+    )
+    fragment.insert_binding(
+        'tooltip-text', builder.build(Grex.SourceLocation())
+    )
+    # Only the target's actual type has this property.
+    fragment.insert_binding('label', _build_constant_binding('hello'))
+
+    target = Gtk.Label()
+    inflator.inflate_existing_target(
+        target, fragment, Grex.InflationFlags.NONE
+    )
+    assert target.get_text() == 'hello'
+    assert target.get_tooltip_text() == 'abc'
+
+    target.set_tooltip_text('def')
+    assert scope._value == 'def'
+
+
+def test_inflate_in_binding_order():
+    inflator = Grex.Inflator()
+    fragment = Grex.Fragment.new(
+        Gtk.Adjustment.__gtype__, Grex.SourceLocation(), False
+    )
+    # The value is clamped to the bounds, so it only sticks if it's set last.
+    fragment.insert_binding('value', _build_double_binding(60))
+    fragment.insert_binding('upper', _build_double_binding(100))
+
+    target = inflator.inflate_new_target(fragment, Grex.InflationFlags.NONE)
+    assert target.get_upper() == 100
+    assert target.get_value() == 0
+
+    # Removing a binding and inserting it again moves it to the end.
+    fragment.remove_binding('value')
+    fragment.insert_binding('value', _build_double_binding(60))
+
+    target = inflator.inflate_new_target(fragment, Grex.InflationFlags.NONE)
+    assert target.get_upper() == 100
+    assert target.get_value() == 60
+
+
+def test_inflate_replaced_binding_keeps_order():
+    inflator = Grex.Inflator()
+    fragment = Grex.Fragment.new(
+        Gtk.Adjustment.__gtype__, Grex.SourceLocation(), False
+    )
+    fragment.insert_binding('upper', _build_double_binding(10))
+    fragment.insert_binding('value', _build_double_binding(50))
+    # Replacing a binding keeps its place, so the bound is still set first.
+    fragment.insert_binding('upper', _build_double_binding(100))
+
+    target = inflator.inflate_new_target(fragment, Grex.InflationFlags.NONE)
+    assert target.get_upper() == 100
+    assert target.get_value() == 50
+
+
 def test_inflate_with_children():
     inflator = Grex.Inflator()
     fragment = _create_box_fragment()
@@ -398,3 +505,325 @@ def test_inflate_with_signals():
 
     target.set_active(True)
     clicked_handler.assert_called_once_with(scope, target)
+
+
+def _create_box_with_labels(*labels):
+    fragment = _create_box_fragment()
+    for label in labels:
+        child_fragment = _create_label_fragment()
+        child_fragment.insert_binding('label', _build_constant_binding(label))
+        fragment.add_child(child_fragment)
+
+    return fragment
+
+
+def _get_label_texts(box):
+    texts = []
+    child = box.get_first_child()
+    while child is not None:
+        texts.append(child.get_text())
+        child = child.get_next_sibling()
+
+    return texts
+
+
+def _get_children(box):
+    children = []
+    child = box.get_first_child()
+    while child is not None:
+        children.append(child)
+        child = child.get_next_sibling()
+
+    return children
+
+
+def test_inflation_task_steps():
+    inflator = Grex.Inflator()
+    fragment = _create_box_with_labels('a', 'b')
+
+    target = Gtk.Box()
+    Grex.FragmentHost.new(target).set_container_adapter(
+        Grex.GtkWidgetContainerAdapter.new()
+    )
+
+    task = Grex.InflationTask.new(
+        inflator, target, fragment, Grex.InflationFlags.NONE
+    )
+    assert not task.step(0)
+    assert _get_label_texts(target) == []
+
+    steps = 1
+    while not task.step(0):
+        steps += 1
+
+    assert steps > 2
+    assert task.is_finished()
+    assert not task.is_cancelled()
+    assert _get_label_texts(target) == ['a', 'b']
+
+
+def test_inflation_task_cancel():
+    inflator = Grex.Inflator()
+
+    target = Gtk.Box()
+    host = Grex.FragmentHost.new(target)
+    host.set_container_adapter(Grex.GtkWidgetContainerAdapter.new())
+    inflator.inflate_existing_target(
+        target, _create_box_with_labels('a', 'b'), Grex.InflationFlags.NONE
+    )
+
+    old_children = _get_children(target)
+
+    new_fragment = _create_box_with_labels('c')
+    task = Grex.InflationTask.new(
+        inflator, target, new_fragment, Grex.InflationFlags.NONE
+    )
+    assert not task.step(0)
+    assert not task.step(0)
+    task.cancel()
+    assert task.is_finished()
+    assert task.is_cancelled()
+    assert host.is_dirty()
+
+    # A cancelled task leaves the old tree untouched.
+    assert _get_children(target) == old_children
+    assert _get_label_texts(target) == ['a', 'b']
+
+    task = Grex.InflationTask.new(
+        inflator, target, new_fragment, Grex.InflationFlags.NONE
+    )
+    assert task.step(-1)
+    assert not host.is_dirty()
+    assert _get_label_texts(target) == ['c']
+
+
+def test_inflation_task_atomic():
+    inflator = Grex.Inflator()
+
+    target = Gtk.Box()
+    Grex.FragmentHost.new(target).set_container_adapter(
+        Grex.GtkWidgetContainerAdapter.new()
+    )
+    inflator.inflate_existing_target(
+        target, _create_box_with_labels('a', 'b'), Grex.InflationFlags.NONE
+    )
+
+    old_children = _get_children(target)
+
+    task = Grex.InflationTask.new(
+        inflator,
+        target,
+        _create_box_with_labels('c', 'd', 'e'),
+        Grex.InflationFlags.NONE,
+    )
+    while not task.step(0):
+        # Neither the existing labels nor the new ones change until the end.
+        assert _get_children(target) == old_children
+        assert _get_label_texts(target) == ['a', 'b']
+
+    assert _get_children(target)[:2] == old_children
+    assert _get_label_texts(target) == ['c', 'd', 'e']
+
+
+def test_inflate_static_subtree():
+    XML = """
+    <GtkBox>
+        <GtkBox>
+            <GtkLabel label="a"/>
+        </GtkBox>
+    </GtkBox>
+    """
+
+    inflator = Grex.Inflator()
+    inflator.add_directives(
+        Grex.InflatorDirectiveFlags.NONE,
+        [Grex.GtkBoxContainerDirectiveFactory()],
+    )
+
+    fragment = Grex.Fragment.parse_xml(XML, -1)
+    assert fragment.is_static()
+
+    target = inflator.inflate_new_target(fragment, Grex.InflationFlags.NONE)
+    inner_box = target.get_first_child()
+    label = inner_box.get_first_child()
+    assert label.get_label() == 'a'
+
+    # Static subtrees aren't visited again, so nothing gets re-added.
+    inner_box.remove(label)
+    inflator.inflate_existing_target(
+        target, fragment, Grex.InflationFlags.NONE
+    )
+    assert inner_box.get_first_child() is None
+
+    # Unless they were explicitly marked dirty.
+    Grex.FragmentHost.for_target(inner_box).mark_dirty()
+    inflator.inflate_existing_target(
+        target, fragment, Grex.InflationFlags.NONE
+    )
+    assert inner_box.get_first_child() is label
+
+
+def test_inflate_static_subtree_modified_child():
+    XML = """
+    <GtkBox>
+        <GtkBox>
+            <GtkLabel label="a"/>
+        </GtkBox>
+    </GtkBox>
+    """
+
+    inflator = Grex.Inflator()
+    inflator.add_directives(
+        Grex.InflatorDirectiveFlags.NONE,
+        [Grex.GtkBoxContainerDirectiveFactory()],
+    )
+
+    fragment = Grex.Fragment.parse_xml(XML, -1)
+    target = inflator.inflate_new_target(fragment, Grex.InflationFlags.NONE)
+    inner_box = target.get_first_child()
+    label = inner_box.get_first_child()
+    assert label.get_label() == 'a'
+
+    # Modifying a descendant means its ancestors aren't static anymore either.
+    [inner_fragment] = fragment.get_children()
+    [label_fragment] = inner_fragment.get_children()
+    label_fragment.insert_binding('label', _build_constant_binding('b'))
+    assert not fragment.is_static()
+    assert not inner_fragment.is_static()
+
+    inflator.inflate_existing_target(
+        target, fragment, Grex.InflationFlags.NONE
+    )
+    assert inner_box.get_first_child() is label
+    assert label.get_label() == 'b'
+
+    inner_fragment.add_child(_create_label_fragment())
+    inflator.inflate_existing_target(
+        target, fragment, Grex.InflationFlags.NONE
+    )
+    assert label.get_next_sibling() is not None
+
+
+def test_inflate_let():
+    XML = """
+    <GtkBox Grex.let.text="[value]">
+        <GtkLabel label="[text]"/>
+        <GtkBox Grex.let.inner-text="inner [text]">
+            <GtkLabel label="[inner-text]"/>
+        </GtkBox>
+    </GtkBox>
+    """
+
+    inflator = Grex.Inflator.new_with_scope(_TestObject())
+    inflator.add_directives(
+        Grex.InflatorDirectiveFlags.NONE,
+        [Grex.GtkBoxContainerDirectiveFactory()],
+    )
+
+    fragment = Grex.Fragment.parse_xml(XML, -1)
+    target = inflator.inflate_new_target(fragment, Grex.InflationFlags.NONE)
+
+    label = target.get_first_child()
+    assert label.get_label() == 'abc'
+    inner_label = label.get_next_sibling().get_first_child()
+    assert inner_label.get_label() == 'inner abc'
+
+
+def test_inflate_modified_fragment():
+    XML = """
+    <GtkBox>
+        <GtkLabel label="a"/>
+    </GtkBox>
+    """
+
+    inflator = Grex.Inflator()
+    inflator.add_directives(
+        Grex.InflatorDirectiveFlags.NONE,
+        [Grex.GtkBoxContainerDirectiveFactory()],
+    )
+
+    fragment = Grex.Fragment.parse_xml(XML, -1)
+    target = inflator.inflate_new_target(fragment, Grex.InflationFlags.NONE)
+    label = target.get_first_child()
+    assert label.get_label() == 'a'
+
+    # Modifying any fragment in the tree is picked up by the next inflation.
+    label_fragment = fragment.get_children()[0]
+    label_fragment.insert_binding('label', _build_constant_binding('b'))
+    label_fragment.insert_binding('selectable', _build_bool_binding(True))
+    fragment.add_child(_create_label_fragment())
+    inflator.inflate_existing_target(
+        target, fragment, Grex.InflationFlags.NONE
+    )
+
+    assert target.get_first_child() is label
+    assert label.get_label() == 'b'
+    assert label.get_selectable()
+    assert isinstance(label.get_next_sibling(), Gtk.Label)
+
+
+def test_inflate_compiled():
+    XML = """
+    <GtkBox>
+        <GtkLabel label="a" selectable="[true]"/>
+    </GtkBox>
+    """
+
+    inflator = Grex.Inflator()
+    inflator.add_directives(
+        Grex.InflatorDirectiveFlags.NONE,
+        [Grex.GtkBoxContainerDirectiveFactory()],
+    )
+
+    fragment = Grex.Fragment.parse_xml(XML, -1)
+    [label_fragment] = fragment.get_children()
+
+    # The same calls grex-compile's generated code makes.
+    label_target = Grex.CompiledTarget.new(label_fragment, 'label')
+    selectable_target = Grex.CompiledTarget.new(label_fragment, 'selectable')
+
+    def inflate_label(inflator, target, flags):
+        host = inflator.begin_compiled_host(target, label_fragment, flags)
+        if host is None:
+            return
+
+        binding = label_fragment.get_binding('label')
+        if not Grex.Inflator.keep_compiled_constant(
+            host, label_target, binding
+        ):
+            value = GObject.Value(GObject.TYPE_STRING, 'compiled')
+            Grex.Inflator.add_compiled_property(host, label_target, value)
+
+        inflator.apply_compiled_binding(
+            host,
+            selectable_target,
+            label_fragment.get_binding('selectable'),
+            flags,
+        )
+        inflator.apply_compiled_directives(host, label_fragment, flags)
+        Grex.Inflator.commit_compiled_host(host)
+
+    def inflate_box(inflator, target, flags):
+        host = inflator.begin_compiled_host(target, fragment, flags)
+        if host is None:
+            return
+
+        inflator.apply_compiled_directives(host, fragment, flags)
+        inflator.inflate_compiled_child(
+            host, 0, label_fragment, inflate_label, flags
+        )
+        Grex.Inflator.commit_compiled_host(host)
+
+    target = Gtk.Box()
+    inflate_box(inflator, target, Grex.InflationFlags.NONE)
+
+    label = target.get_first_child()
+    assert label.get_label() == 'compiled'
+    assert label.get_selectable()
+
+    # An interpreted inflation sees the constant as already applied.
+    inflator.inflate_existing_target(
+        target, fragment, Grex.InflationFlags.NONE
+    )
+    assert target.get_first_child() is label
+    assert label.get_label() == 'compiled'
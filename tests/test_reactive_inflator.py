@@ -0,0 +1,839 @@
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+from gi.repository import GLib, GObject, Grex, Gtk
+
+
+# TODO: dedup these across the tests.
+class _TestObject(GObject.Object):
+    def __init__(self) -> None:
+        super(_TestObject, self).__init__()
+        self._value = 'abc'
+
+    @GObject.Property(type=str)
+    def value(self):  # type: ignore
+        return self._value
+
+    @value.setter
+    def value(self, value):
+        self._value = value
+
+
+class _CountingObject(GObject.Object):
+    def __init__(self) -> None:
+        super(_CountingObject, self).__init__()
+        self._first = 'first'
+        self._second = 'second'
+        self.first_reads = 0
+        self.second_reads = 0
+
+    @GObject.Property(type=str)
+    def first(self):  # type: ignore
+        self.first_reads += 1
+        return self._first
+
+    @first.setter
+    def first(self, value):
+        self._first = value
+
+    @GObject.Property(type=str)
+    def second(self):  # type: ignore
+        self.second_reads += 1
+        return self._second
+
+    @second.setter
+    def second(self, value):
+        self._second = value
+
+
+class _UnlessStructuralDirective(Grex.StructuralDirective):
+    def __init__(self) -> None:
+        super(_UnlessStructuralDirective, self).__init__()
+
+        self._value = False
+
+    @GObject.Property(type=bool, default=False)
+    def value(self):  # type: ignore
+        return self._value
+
+    @value.setter
+    def value(self, new_value):
+        self._value = new_value
+
+    def do_apply(self, inflator, parent, key, child, flags, child_flags):
+        if not self._value:
+            inflator.inflate_child(parent, key, child, flags, child_flags)
+
+
+class _UnlessStructuralDirectiveFactory(Grex.StructuralDirectiveFactory):
+    def do_get_name(self):
+        return 'Test.unless'
+
+    def do_get_property_format(self):
+        return Grex.DirectivePropertyFormat.IMPLICIT_VALUE
+
+    def do_create(self):
+        return _UnlessStructuralDirective()
+
+
+class _UpdateCounterPropertyDirective(Grex.PropertyDirective):
+    def __init__(self, factory) -> None:
+        super(_UpdateCounterPropertyDirective, self).__init__()
+        self._factory = factory
+
+    def do_update(self, host):
+        self._factory.updates += 1
+
+
+class _UpdateCounterPropertyDirectiveFactory(Grex.PropertyDirectiveFactory):
+    def __init__(self) -> None:
+        super(_UpdateCounterPropertyDirectiveFactory, self).__init__()
+        self.updates = 0
+
+    def do_get_name(self):
+        return 'Test.update-counter'
+
+    def do_get_property_format(self):
+        return Grex.DirectivePropertyFormat.NONE
+
+    def do_create(self):
+        return _UpdateCounterPropertyDirective(self)
+
+
+class _HiddenObject(GObject.Object):
+    def __init__(self) -> None:
+        super(_HiddenObject, self).__init__()
+        self._hidden = False
+
+    @GObject.Property(type=bool, default=False)
+    def hidden(self):  # type: ignore
+        return self._hidden
+
+    @hidden.setter
+    def hidden(self, value):
+        self._hidden = value
+
+
+def _build_constant_binding(value):
+    builder = Grex.BindingBuilder.new()
+    builder.add_constant(value, -1)
+    return builder.build(Grex.SourceLocation())
+
+
+def _create_label_fragment_bound_to(name='value'):
+    builder = Grex.BindingBuilder()
+    builder.add_expression(
+        Grex.property_expression_new(Grex.SourceLocation(), None, name),
+        False,
+    )
+
+    fragment = Grex.Fragment.new(
+        Gtk.Label.__gtype__, Grex.SourceLocation(), False
+    )
+    fragment.insert_binding('label', builder.build(Grex.SourceLocation()))
+    return fragment
+
+
+def _create_reactive_inflator(scope, target):
+    base_inflator = Grex.Inflator.new_with_scope(scope)
+    return Grex.ReactiveInflator.new_with_base_inflator(
+        base_inflator, _create_label_fragment_bound_to(), target
+    )
+
+
+def test_immediate_inflation():
+    scope = _TestObject()
+    target = Gtk.Label()
+    inflator = _create_reactive_inflator(scope, target)
+    inflator.inflate()
+
+    assert target.get_text() == 'abc'
+
+    scope.props.value = 'def'
+    assert target.get_text() == 'def'
+    assert not inflator.is_pending()
+
+
+def test_deferred_inflation_flush():
+    scope = _TestObject()
+    target = Gtk.Label()
+    inflator = _create_reactive_inflator(scope, target)
+    inflator.set_flags(Grex.ReactiveInflatorFlags.DEFERRED)
+    inflator.inflate()
+
+    assert target.get_text() == 'abc'
+
+    scope.props.value = 'def'
+    scope.props.value = 'ghi'
+    assert target.get_text() == 'abc'
+    assert inflator.is_pending()
+
+    inflator.flush()
+    assert target.get_text() == 'ghi'
+    assert not inflator.is_pending()
+
+
+def test_deferred_inflation_idle():
+    scope = _TestObject()
+    target = Gtk.Label()
+    inflator = _create_reactive_inflator(scope, target)
+    inflator.set_flags(Grex.ReactiveInflatorFlags.DEFERRED)
+    inflator.inflate()
+
+    scope.props.value = 'def'
+    assert inflator.is_pending()
+
+    context = GLib.MainContext.default()
+    while inflator.is_pending() and context.iteration(True):
+        pass
+
+    assert target.get_text() == 'def'
+
+
+def test_deferred_inflation_realized_unmapped():
+    scope = _TestObject()
+    target = Gtk.Label()
+    window = Gtk.Window()
+    window.set_child(target)
+    target.realize()
+
+    inflator = _create_reactive_inflator(scope, target)
+    inflator.set_flags(Grex.ReactiveInflatorFlags.DEFERRED)
+    inflator.inflate()
+
+    # The window's frame clock isn't running, so this can't wait for a tick.
+    assert target.get_realized()
+    assert not target.get_mapped()
+    scope.props.value = 'def'
+    assert inflator.is_pending()
+
+    context = GLib.MainContext.default()
+    while inflator.is_pending() and context.iteration(True):
+        pass
+
+    assert target.get_text() == 'def'
+    window.destroy()
+
+
+def test_shared_scheduler():
+    scope = _TestObject()
+    scheduler = Grex.ReactiveScheduler.new()
+
+    targets = [Gtk.Label(), Gtk.Label()]
+    inflators = [_create_reactive_inflator(scope, t) for t in targets]
+    for inflator in inflators:
+        inflator.set_scheduler(scheduler)
+        inflator.inflate()
+
+    scope.props.value = 'def'
+    assert all(t.get_text() == 'abc' for t in targets)
+    assert all(i.is_pending() for i in inflators)
+    assert scheduler.is_pending()
+
+    scheduler.flush()
+    assert all(t.get_text() == 'def' for t in targets)
+    assert not any(i.is_pending() for i in inflators)
+    assert not scheduler.is_pending()
+    assert scheduler.get_flush_count() == 1
+    assert scheduler.get_last_flush_size() == 2
+
+
+def test_shared_scheduler_unmapped_targets():
+    scope = _TestObject()
+    scheduler = Grex.ReactiveScheduler.new()
+
+    targets = [Gtk.Label(), Gtk.Label()]
+    inflators = [_create_reactive_inflator(scope, t) for t in targets]
+    for inflator in inflators:
+        inflator.set_scheduler(scheduler)
+        inflator.inflate()
+
+    # Without a frame clock to wait for, the flush happens in an idle instead.
+    scope.props.value = 'def'
+    context = GLib.MainContext.default()
+    while scheduler.is_pending() and context.iteration(True):
+        pass
+
+    assert all(t.get_text() == 'def' for t in targets)
+    assert scheduler.get_flush_count() == 1
+    assert scheduler.get_last_flush_size() == 2
+
+
+def test_shared_scheduler_target_unmapped():
+    scope = _TestObject()
+    scheduler = Grex.ReactiveScheduler.new()
+
+    mapped_target = Gtk.Label()
+    window = Gtk.Window()
+    window.set_child(mapped_target)
+    window.present()
+
+    context = GLib.MainContext.default()
+    while not mapped_target.get_mapped() and context.iteration(True):
+        pass
+
+    targets = [mapped_target, Gtk.Label()]
+    inflators = [_create_reactive_inflator(scope, t) for t in targets]
+    for inflator in inflators:
+        inflator.set_scheduler(scheduler)
+        inflator.inflate()
+
+    # The flush waits on the window's frame clock, which stops once it's
+    # hidden, so the flush has to move over to an idle.
+    scope.props.value = 'def'
+    window.set_visible(False)
+    assert not mapped_target.get_mapped()
+    assert scheduler.is_pending()
+
+    while scheduler.is_pending() and context.iteration(True):
+        pass
+
+    assert all(t.get_text() == 'def' for t in targets)
+    assert scheduler.get_flush_count() == 1
+    assert scheduler.get_last_flush_size() == 2
+    window.destroy()
+
+
+def test_shared_base_inflator():
+    scope = _TestObject()
+    base_inflator = Grex.Inflator.new_with_scope(scope)
+
+    targets = [Gtk.Label(), Gtk.Label()]
+    inflators = [
+        Grex.ReactiveInflator.new_with_base_inflator(
+            base_inflator, _create_label_fragment_bound_to(), t
+        )
+        for t in targets
+    ]
+    inflators[1].set_flags(Grex.ReactiveInflatorFlags.FINE_GRAINED)
+    for inflator in inflators:
+        inflator.inflate()
+
+    # Both inflators see the change, not just the first one to handle it.
+    scope.props.value = 'def'
+    assert all(t.get_text() == 'def' for t in targets)
+    assert not any(i.is_pending() for i in inflators)
+
+    scope.props.value = 'ghi'
+    assert all(t.get_text() == 'ghi' for t in targets)
+
+
+def test_suspended_inflation():
+    scope = _TestObject()
+    target = Gtk.Label()
+    inflator = _create_reactive_inflator(scope, target)
+    inflator.inflate()
+
+    inflator.suspend()
+    assert inflator.is_suspended()
+
+    scope.props.value = 'def'
+    scope.props.value = 'ghi'
+    assert target.get_text() == 'abc'
+    assert inflator.is_pending()
+
+    inflator.resume()
+    assert not inflator.is_suspended()
+    assert target.get_text() == 'ghi'
+    assert not inflator.is_pending()
+    assert inflator.get_last_pass_count() == 1
+
+
+def test_suspended_while_unmapped():
+    scope = _TestObject()
+    target = Gtk.Label()
+    inflator = _create_reactive_inflator(scope, target)
+    inflator.set_flags(Grex.ReactiveInflatorFlags.SUSPEND_WHEN_UNMAPPED)
+    inflator.inflate()
+
+    assert not target.get_mapped()
+    assert inflator.is_suspended()
+
+    scope.props.value = 'def'
+    assert target.get_text() == 'abc'
+    assert inflator.is_pending()
+
+    inflator.flush()
+    assert target.get_text() == 'def'
+    assert not inflator.is_pending()
+
+
+def _create_box_with_two_labels():
+    fragment = Grex.Fragment.new(
+        Gtk.Box.__gtype__, Grex.SourceLocation(), False
+    )
+    fragment.add_child(_create_label_fragment_bound_to('first'))
+    fragment.add_child(_create_label_fragment_bound_to('second'))
+
+    target = Gtk.Box()
+    Grex.FragmentHost.new(target).set_container_adapter(
+        Grex.GtkWidgetContainerAdapter.new()
+    )
+
+    return fragment, target
+
+
+def test_fine_grained_inflation():
+    scope = _CountingObject()
+    fragment, target = _create_box_with_two_labels()
+
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        Grex.Inflator.new_with_scope(scope), fragment, target
+    )
+    inflator.set_flags(Grex.ReactiveInflatorFlags.FINE_GRAINED)
+    inflator.inflate()
+
+    first_label = target.get_first_child()
+    second_label = first_label.get_next_sibling()
+    assert first_label.get_text() == 'first'
+    assert second_label.get_text() == 'second'
+
+    scope.second_reads = 0
+    scope.props.first = 'changed'
+
+    assert first_label.get_text() == 'changed'
+    assert second_label.get_text() == 'second'
+    assert scope.second_reads == 0
+
+    # The re-applied binding must keep tracking its dependency.
+    scope.props.first = 'changed again'
+    assert first_label.get_text() == 'changed again'
+
+
+def test_fine_grained_inflation_name_insert():
+    scope = _CountingObject()
+    fragment, target = _create_box_with_two_labels()
+
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        Grex.Inflator.new_with_scope(scope), fragment, target
+    )
+    inflator.set_flags(Grex.ReactiveInflatorFlags.FINE_GRAINED)
+    inflator.inflate()
+
+    scope.second_reads = 0
+    context = inflator.get_base_inflator().get_context()
+    context.insert('first', 'inserted')
+
+    assert target.get_first_child().get_text() == 'inserted'
+    assert scope.second_reads == 0
+
+    # Nothing read this name, so there's nothing to do.
+    scope.first_reads = 0
+    context.insert('unused', 'value')
+    assert scope.first_reads == 0
+    assert scope.second_reads == 0
+
+
+def test_fine_grained_inflation_dirty_subtree():
+    scope = _HiddenObject()
+    update_counter = _UpdateCounterPropertyDirectiveFactory()
+
+    base_inflator = Grex.Inflator.new_with_scope(scope)
+    base_inflator.add_directives(
+        Grex.InflatorDirectiveFlags.NONE,
+        [_UnlessStructuralDirectiveFactory(), update_counter],
+    )
+
+    builder = Grex.BindingBuilder()
+    builder.add_expression(
+        Grex.property_expression_new(Grex.SourceLocation(), None, 'hidden'),
+        False,
+    )
+
+    sibling_fragment = Grex.Fragment.new(
+        Gtk.Label.__gtype__, Grex.SourceLocation(), False
+    )
+    sibling_fragment.insert_binding(
+        'Test.update-counter', _build_constant_binding('')
+    )
+
+    hidden_fragment = Grex.Fragment.new(
+        Gtk.Label.__gtype__, Grex.SourceLocation(), False
+    )
+    hidden_fragment.insert_binding(
+        '_Test.unless', builder.build(Grex.SourceLocation())
+    )
+
+    fragment = Grex.Fragment.new(
+        Gtk.Box.__gtype__, Grex.SourceLocation(), False
+    )
+    fragment.add_child(sibling_fragment)
+    fragment.add_child(hidden_fragment)
+
+    target = Gtk.Box()
+    Grex.FragmentHost.new(target).set_container_adapter(
+        Grex.GtkWidgetContainerAdapter.new()
+    )
+
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        base_inflator, fragment, target
+    )
+    inflator.set_flags(Grex.ReactiveInflatorFlags.FINE_GRAINED)
+    inflator.inflate()
+
+    sibling = target.get_first_child()
+    assert isinstance(sibling.get_next_sibling(), Gtk.Label)
+    assert update_counter.updates == 1
+
+    scope.props.hidden = True
+    assert sibling.get_next_sibling() is None
+    assert not Grex.FragmentHost.for_target(target).is_subtree_dirty()
+
+    # The sibling's host was clean, so it shouldn't have been inflated again.
+    assert update_counter.updates == 1
+
+
+def test_dependencies_kept_across_inflations():
+    scope = _TestObject()
+    target = Gtk.Label()
+    inflator = _create_reactive_inflator(scope, target)
+    context = inflator.get_base_inflator().get_context()
+
+    changes = 0
+
+    def on_changed(context):
+        nonlocal changes
+        changes += 1
+
+    context.connect('changed', on_changed)
+
+    inflator.inflate()
+    inflator.inflate()
+    inflator.inflate()
+
+    scope.props.value = 'def'
+    assert changes == 1
+    assert target.get_text() == 'def'
+
+    context.reset_dependencies()
+    scope.props.value = 'ghi'
+    assert changes == 1
+
+
+def test_shared_dependency_changes_once():
+    scope = _TestObject()
+
+    fragment = Grex.Fragment.new(
+        Gtk.Box.__gtype__, Grex.SourceLocation(), False
+    )
+    fragment.add_child(_create_label_fragment_bound_to())
+    fragment.add_child(_create_label_fragment_bound_to())
+
+    target = Gtk.Box()
+    Grex.FragmentHost.new(target).set_container_adapter(
+        Grex.GtkWidgetContainerAdapter.new()
+    )
+
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        Grex.Inflator.new_with_scope(scope), fragment, target
+    )
+    inflator.set_flags(Grex.ReactiveInflatorFlags.FINE_GRAINED)
+    inflator.inflate()
+
+    changes = 0
+
+    def on_changed(context):
+        nonlocal changes
+        changes += 1
+
+    inflator.get_base_inflator().get_context().connect('changed', on_changed)
+
+    scope.props.value = 'def'
+    assert changes == 1
+
+    first_label = target.get_first_child()
+    assert first_label.get_text() == 'def'
+    assert first_label.get_next_sibling().get_text() == 'def'
+
+
+class _TruncatingTarget(GObject.Object):
+    def __init__(self, scope) -> None:
+        super(_TruncatingTarget, self).__init__()
+        self._scope = scope
+        self._label = ''
+
+    @GObject.Property(type=str)
+    def label(self):  # type: ignore
+        return self._label
+
+    @label.setter
+    def label(self, value):
+        self._label = value
+        # Writes back into the scope mid-inflation.
+        if len(value) > 3:
+            self._scope.props.value = value[:3]
+
+
+def test_changes_during_inflation():
+    scope = _TestObject()
+    scope.props.value = 'abcdef'
+    target = _TruncatingTarget(scope)
+
+    fragment = Grex.Fragment.new(
+        _TruncatingTarget.__gtype__, Grex.SourceLocation(), False
+    )
+    fragment.insert_binding(
+        'label', _create_label_fragment_bound_to().get_binding('label')
+    )
+
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        Grex.Inflator.new_with_scope(scope), fragment, target
+    )
+    inflator.inflate()
+
+    assert target.props.label == 'abc'
+    assert inflator.get_last_pass_count() == 2
+    assert not inflator.is_pending()
+
+    scope.props.value = 'xyz'
+    assert target.props.label == 'xyz'
+    assert inflator.get_last_pass_count() == 1
+
+
+def test_unchanged_value_notify_ignored():
+    scope = _CountingObject()
+    fragment, target = _create_box_with_two_labels()
+
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        Grex.Inflator.new_with_scope(scope), fragment, target
+    )
+    inflator.inflate()
+
+    changes = 0
+
+    def on_changed(context):
+        nonlocal changes
+        changes += 1
+
+    inflator.get_base_inflator().get_context().connect('changed', on_changed)
+
+    scope.second_reads = 0
+    scope.props.first = 'first'
+    assert changes == 0
+    assert scope.second_reads == 0
+
+    scope.props.first = 'changed'
+    assert changes == 1
+    assert target.get_first_child().get_text() == 'changed'
+
+
+def test_changed_properties():
+    scope = _CountingObject()
+    fragment, target = _create_box_with_two_labels()
+
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        Grex.Inflator.new_with_scope(scope), fragment, target
+    )
+    inflator.inflate()
+
+    changes = []
+
+    def on_changed(context):
+        changed = context.get_changes()
+        changes.append(
+            (
+                changed.contains_property(scope, 'first'),
+                changed.contains_property(scope, 'second'),
+            )
+        )
+
+    inflator.get_base_inflator().get_context().connect('changed', on_changed)
+
+    scope.props.first = 'changed'
+    assert changes == [(True, False)]
+
+
+class _PathScope(GObject.Object):
+    def __init__(self) -> None:
+        super(_PathScope, self).__init__()
+        self._child = _TestObject()
+        self.child_reads = 0
+
+    @GObject.Property(type=GObject.Object)
+    def child(self):  # type: ignore
+        self.child_reads += 1
+        return self._child
+
+    @child.setter
+    def child(self, value):
+        self._child = value
+
+
+def test_property_path_rewired_on_intermediate_change():
+    scope = _PathScope()
+    old_child = scope.props.child
+
+    builder = Grex.BindingBuilder()
+    builder.add_expression(
+        Grex.property_expression_new(
+            Grex.SourceLocation(),
+            Grex.property_expression_new(
+                Grex.SourceLocation(), None, 'child'
+            ),
+            'value',
+        ),
+        False,
+    )
+
+    fragment = Grex.Fragment.new(
+        Gtk.Label.__gtype__, Grex.SourceLocation(), False
+    )
+    fragment.insert_binding('label', builder.build(Grex.SourceLocation()))
+
+    target = Gtk.Label()
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        Grex.Inflator.new_with_scope(scope), fragment, target
+    )
+    inflator.set_flags(Grex.ReactiveInflatorFlags.FINE_GRAINED)
+    inflator.inflate()
+    assert target.get_text() == 'abc'
+
+    # Only the leaf changed, so the path to it isn't resolved again.
+    scope.child_reads = 0
+    old_child.props.value = 'def'
+    assert target.get_text() == 'def'
+    assert scope.child_reads == 0
+
+    new_child = _TestObject()
+    new_child.props.value = 'ghi'
+    scope.props.child = new_child
+    assert target.get_text() == 'ghi'
+
+    # The leaf subscription moved over to the new child.
+    old_child.props.value = 'old'
+    assert target.get_text() == 'ghi'
+    new_child.props.value = 'jkl'
+    assert target.get_text() == 'jkl'
+
+
+def test_let_computed_once():
+    scope = _CountingObject()
+
+    builder = Grex.BindingBuilder()
+    builder.add_expression(
+        Grex.property_expression_new(Grex.SourceLocation(), None, 'first'),
+        False,
+    )
+
+    fragment = Grex.Fragment.new(
+        Gtk.Box.__gtype__, Grex.SourceLocation(), False
+    )
+    fragment.insert_binding(
+        'Grex.let.shared', builder.build(Grex.SourceLocation())
+    )
+    fragment.add_child(_create_label_fragment_bound_to('shared'))
+    fragment.add_child(_create_label_fragment_bound_to('shared'))
+
+    target = Gtk.Box()
+    Grex.FragmentHost.new(target).set_container_adapter(
+        Grex.GtkWidgetContainerAdapter.new()
+    )
+
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        Grex.Inflator.new_with_scope(scope), fragment, target
+    )
+    inflator.set_flags(Grex.ReactiveInflatorFlags.FINE_GRAINED)
+    inflator.inflate()
+
+    first_label = target.get_first_child()
+    second_label = first_label.get_next_sibling()
+    assert first_label.get_text() == 'first'
+    assert second_label.get_text() == 'first'
+    assert scope.first_reads == 1
+
+    scope.first_reads = 0
+    scope.props.first = 'changed'
+    assert first_label.get_text() == 'changed'
+    assert second_label.get_text() == 'changed'
+    # One read to check if it actually changed, and one to recompute it.
+    assert scope.first_reads == 2
+
+
+def test_time_sliced_inflation():
+    scope = _CountingObject()
+    fragment, target = _create_box_with_two_labels()
+
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        Grex.Inflator.new_with_scope(scope), fragment, target
+    )
+    inflator.set_flags(
+        Grex.ReactiveInflatorFlags.TIME_SLICED
+        | Grex.ReactiveInflatorFlags.FINE_GRAINED
+    )
+    inflator.set_slice_budget(1)
+    inflator.inflate()
+
+    assert inflator.is_pending()
+    assert target.get_first_child() is None
+
+    context = GLib.MainContext.default()
+    context.iteration(True)
+    assert inflator.is_pending()
+
+    # Supersedes the inflation in progress.
+    scope.props.first = 'changed'
+    assert inflator.is_pending()
+
+    while inflator.is_pending() and context.iteration(True):
+        pass
+
+    first_label = target.get_first_child()
+    second_label = first_label.get_next_sibling()
+    assert first_label.get_text() == 'changed'
+    assert second_label.get_text() == 'second'
+    assert second_label.get_next_sibling() is None
+
+    scope.props.second = 'changed too'
+    assert second_label.get_text() == 'changed too'
+    assert not inflator.is_pending()
+
+
+def test_time_sliced_inflation_flush():
+    scope = _CountingObject()
+    fragment, target = _create_box_with_two_labels()
+
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        Grex.Inflator.new_with_scope(scope), fragment, target
+    )
+    inflator.set_flags(Grex.ReactiveInflatorFlags.TIME_SLICED)
+    inflator.inflate()
+    assert inflator.is_pending()
+
+    inflator.flush()
+    assert not inflator.is_pending()
+    assert target.get_first_child().get_text() == 'first'
+
+
+def test_low_priority_changes():
+    scope = _CountingObject()
+    fragment, target = _create_box_with_two_labels()
+
+    base_inflator = Grex.Inflator.new_with_scope(scope)
+    base_inflator.get_context().set_source_priority(
+        scope, Grex.ChangePriority.LOW
+    )
+    inflator = Grex.ReactiveInflator.new_with_base_inflator(
+        base_inflator, fragment, target
+    )
+    inflator.set_flags(Grex.ReactiveInflatorFlags.FINE_GRAINED)
+    inflator.inflate()
+
+    first_label = target.get_first_child()
+    assert first_label.get_text() == 'first'
+
+    scope.props.first = 'changed'
+    assert first_label.get_text() == 'first'
+    assert inflator.is_pending()
+
+    context = GLib.MainContext.default()
+    while inflator.is_pending() and context.iteration(True):
+        pass
+
+    assert first_label.get_text() == 'changed'
+
+    scope.props.first = 'changed again'
+    assert inflator.is_pending()
+    inflator.flush()
+    assert not inflator.is_pending()
+    assert first_label.get_text() == 'changed again'